@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "Runner.hpp"
+#include "VBox/Histogram.hpp"
+#include "VBox/Allocations.hpp"
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+namespace VBox
+{
+    namespace Benchmarks
+    {
+        class Runner::IMPL
+        {
+            public:
+                
+                struct Case
+                {
+                    std::string                                        name;
+                    size_t                                             iterations;
+                    uint64_t                                           bytes;
+                    std::function< void( void ) >                      f;
+                    std::chrono::nanoseconds                           limit;
+                    std::function< std::chrono::nanoseconds( void ) > measure;
+                };
+                
+                IMPL( void );
+                
+                static std::string _escape( const std::string & s );
+                
+                size_t              _iterations;
+                std::string         _filter;
+                std::vector< Case > _cases;
+                size_t              _failures;
+        };
+        
+        Runner::Runner( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        Runner::~Runner( void )
+        {}
+        
+        size_t Runner::iterations( void ) const
+        {
+            return this->impl->_iterations;
+        }
+        
+        std::string Runner::filter( void ) const
+        {
+            return this->impl->_filter;
+        }
+        
+        size_t Runner::failures( void ) const
+        {
+            return this->impl->_failures;
+        }
+        
+        void Runner::iterations( size_t value )
+        {
+            this->impl->_iterations = value;
+        }
+        
+        void Runner::filter( const std::string & value )
+        {
+            this->impl->_filter = value;
+        }
+        
+        void Runner::add( const std::string & name, size_t iterations, uint64_t bytes, const std::function< void( void ) > & f )
+        {
+            this->impl->_cases.push_back( { name, iterations, bytes, f, std::chrono::nanoseconds( 0 ), nullptr } );
+        }
+        
+        /*
+         * For what cannot be timed around the whole call, the function
+         * returns the time it measured itself. The benchmark fails when the
+         * 99th percentile of that time is above limit.
+         */
+        void Runner::add( const std::string & name, size_t iterations, uint64_t bytes, std::chrono::nanoseconds limit, const std::function< std::chrono::nanoseconds( void ) > & f )
+        {
+            this->impl->_cases.push_back( { name, iterations, bytes, nullptr, limit, f } );
+        }
+        
+        /*
+         * A benchmark that throws is reported as failed, with what it has
+         * measured so far, and the others still run.
+         */
+        std::string Runner::run( void )
+        {
+            std::stringstream ss;
+            bool              first( true );
+            
+            ss << "{" << std::endl << "    \"benchmarks\": [";
+            
+            for( const auto & c: this->impl->_cases )
+            {
+                size_t      iterations( ( this->impl->_iterations > 0 ) ? this->impl->_iterations : c.iterations );
+                Histogram   histogram;
+                uint64_t    allocations( Allocations::count() );
+                std::string error;
+                
+                if( this->impl->_filter.length() > 0 && c.name.find( this->impl->_filter ) == std::string::npos )
+                {
+                    continue;
+                }
+                
+                std::cerr << c.name << "..." << std::flush;
+                
+                try
+                {
+                    if( c.measure != nullptr )
+                    {
+                        c.measure();
+                    }
+                    else
+                    {
+                        c.f();
+                    }
+                    
+                    allocations = Allocations::count();
+                    
+                    for( size_t i = 0; i < iterations; i++ )
+                    {
+                        std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+                        std::chrono::nanoseconds              time;
+                        
+                        if( c.measure != nullptr )
+                        {
+                            time = c.measure();
+                        }
+                        else
+                        {
+                            c.f();
+                            
+                            time = std::chrono::steady_clock::now() - start;
+                        }
+                        
+                        histogram.record( static_cast< uint64_t >( time.count() ) );
+                    }
+                    
+                    if( c.limit.count() > 0 && histogram.percentile( 99 ) > static_cast< uint64_t >( c.limit.count() ) )
+                    {
+                        error = "p99 above the limit of " + std::to_string( c.limit.count() ) + " ns";
+                    }
+                }
+                catch( const std::exception & e )
+                {
+                    error = e.what();
+                }
+                catch( ... )
+                {
+                    error = "Unknown error";
+                }
+                
+                /* Includes allocations made by other threads during the loop */
+                allocations = Allocations::count() - allocations;
+                
+                if( error.length() > 0 )
+                {
+                    this->impl->_failures++;
+                    
+                    std::cerr << " failed: " << error << std::endl;
+                }
+                else
+                {
+                    std::cerr << " " << histogram.percentile( 50 ) << " ns" << std::endl;
+                }
+                
+                ss << ( ( first ) ? "" : "," ) << std::endl
+                   << "        { "
+                   << "\"name\": \""     << c.name                    << "\", "
+                   << "\"iterations\": " << histogram.count()         << ", "
+                   << "\"bytes\": "      << c.bytes                   << ", "
+                   << "\"mean_ns\": "    << histogram.mean()          << ", "
+                   << "\"p50_ns\": "     << histogram.percentile( 50 ) << ", "
+                   << "\"p99_ns\": "     << histogram.percentile( 99 ) << ", "
+                   << "\"max_ns\": "     << histogram.max()           << ", "
+                   << "\"mib_per_s\": "  << std::fixed << std::setprecision( 2 )
+                   << ( ( c.bytes > 0 && histogram.mean() > 0 ) ? ( static_cast< double >( c.bytes ) / 1048576.0 ) / ( static_cast< double >( histogram.mean() ) / 1e9 ) : 0.0 ) << ", "
+                   << "\"allocations\": " << ( ( iterations > 0 ) ? static_cast< double >( allocations ) / static_cast< double >( iterations ) : 0.0 );
+                
+                if( error.length() > 0 )
+                {
+                    ss << ", \"error\": \"" << IMPL::_escape( error ) << "\"";
+                }
+                
+                ss << " }";
+                
+                first = false;
+            }
+            
+            ss << std::endl << "    ]" << std::endl << "}" << std::endl;
+            
+            return ss.str();
+        }
+        
+        Runner::IMPL::IMPL( void ):
+            _iterations( 0 ),
+            _failures(   0 )
+        {}
+        
+        std::string Runner::IMPL::_escape( const std::string & s )
+        {
+            std::string escaped;
+            
+            for( char c: s )
+            {
+                if( c == '"' || c == '\\' )
+                {
+                    escaped += '\\';
+                }
+                
+                escaped += ( static_cast< unsigned char >( c ) < 0x20 ) ? ' ' : c;
+            }
+            
+            return escaped;
+        }
+    }
+}
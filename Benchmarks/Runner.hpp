@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_BENCHMARKS_RUNNER_HPP
+#define VBOX_BENCHMARKS_RUNNER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace VBox
+{
+    namespace Benchmarks
+    {
+        class Runner
+        {
+            public:
+                
+                Runner( void );
+                ~Runner( void );
+                
+                Runner( const Runner & o )              = delete;
+                Runner( Runner && o )                   = delete;
+                Runner & operator =( const Runner & o ) = delete;
+                Runner & operator =( Runner && o )      = delete;
+                
+                size_t      iterations( void ) const;
+                std::string filter( void )     const;
+                size_t      failures( void )   const;
+                
+                void iterations( size_t value );
+                void filter( const std::string & value );
+                
+                void add( const std::string & name, size_t iterations, uint64_t bytes, const std::function< void( void ) > & f );
+                void add( const std::string & name, size_t iterations, uint64_t bytes, std::chrono::nanoseconds limit, const std::function< std::chrono::nanoseconds( void ) > & f );
+                
+                std::string run( void );
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_BENCHMARKS_RUNNER_HPP */
@@ -0,0 +1,1659 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "Runner.hpp"
+#include "VBox/BinaryDataStream.hpp"
+#include "VBox/BinaryFileStream.hpp"
+#include "VBox/BinaryReader.hpp"
+#include "VBox/FileReader.hpp"
+#include "VBox/ELF/File.hpp"
+#include "VBox/VM/CoreDump.hpp"
+#include "VBox/VM/PageStore.hpp"
+#include "VBox/VM/PageIndex.hpp"
+#include "VBox/VM/DumpTarget.hpp"
+#include "VBox/Process.hpp"
+#include "VBox/ProcessWatcher.hpp"
+#include "VBox/Monitor.hpp"
+#include "VBox/SampleRate.hpp"
+#include "VBox/Manage.hpp"
+#include "VBox/SyntheticBackend.hpp"
+#include "VBox/CLIBackend.hpp"
+#include "VBox/DebugConsole.hpp"
+#include "VBox/VM/PartialCore.hpp"
+#include "VBox/String.hpp"
+#ifdef VBOX_HAVE_CAPSTONE
+#include "VBox/Capstone.hpp"
+#endif
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static volatile uint64_t sink( 0 );
+
+void        ShowHelp( void );
+std::string TemporaryFile( void );
+void        WriteDataFile( const std::string & path, size_t size );
+void        WriteCoreFile( const std::string & path, uint64_t memorySize, bool sparse );
+std::string CannedRegisters( void );
+std::string CannedStack( size_t entries );
+std::string CannedRunningVMs( size_t vms );
+std::string CannedProcesses( size_t processes );
+std::string CannedError( const std::string & message );
+std::string CannedConsoleMemory( uint64_t address, uint64_t size );
+int         FakeVBoxManage( int argc, const char * argv[] );
+uint16_t    FakeDebugConsole( void );
+std::string ExecutablePath( const char * argv0 );
+
+int main( int argc, const char * argv[] )
+{
+    VBox::Benchmarks::Runner runner;
+    std::string              output;
+    uint64_t                 coreSize( 1024 );
+    
+    /*
+     * The executable doubles as a fake VBoxManage for the dump and monitor
+     * benchmarks, which run it as a child process. Benchmark options all
+     * start with a dash, VBoxManage commands never do.
+     */
+    if( argc > 1 && argv[ 1 ][ 0 ] != '-' )
+    {
+        return FakeVBoxManage( argc, argv );
+    }
+    
+    for( int i = 1; i < argc; i++ )
+    {
+        std::string arg( argv[ i ] );
+        
+        if( arg == "--help" || arg == "-h" )
+        {
+            ShowHelp();
+            
+            return EXIT_SUCCESS;
+        }
+        else if( arg == "--iterations" && i + 1 < argc )
+        {
+            runner.iterations( std::strtoul( argv[ ++i ], nullptr, 10 ) );
+        }
+        else if( arg == "--filter" && i + 1 < argc )
+        {
+            runner.filter( argv[ ++i ] );
+        }
+        else if( arg == "--core-size" && i + 1 < argc )
+        {
+            coreSize = std::max< uint64_t >( std::strtoull( argv[ ++i ], nullptr, 10 ), 1 );
+        }
+        else if( arg == "--output" && i + 1 < argc )
+        {
+            output = argv[ ++i ];
+        }
+    }
+    
+    /*
+     * Fixtures are captured by reference by the benchmark cases, so they must
+     * outlive runner.run().
+     */
+    std::string                                  dataPath( TemporaryFile() );
+    std::string                                  corePath( TemporaryFile() );
+    size_t                                       dataSize( 16 * 1024 * 1024 );
+    uint64_t                                     memorySize( coreSize * 1024 * 1024 );
+    std::vector< uint8_t >                       data( dataSize );
+    std::vector< uint8_t >                       memory( 64 * 1024 );
+    std::vector< uint8_t >                       code;
+    std::vector< uint8_t >                       zeros( 16 * 1024 * 1024 );
+    std::shared_ptr< VBox::VM::CoreDump >        dump;
+    std::shared_ptr< VBox::VM::CoreDump >        stored;
+    std::shared_ptr< VBox::VM::CoreDump >        published;
+    std::unique_ptr< VBox::Monitor >             monitor;
+    std::unique_ptr< VBox::Monitor >             syntheticMonitor;
+    std::shared_ptr< VBox::VM::CoreDump >        syntheticPublished;
+    std::unique_ptr< VBox::Monitor >             idleMonitor;
+    std::shared_ptr< const VBox::VM::Registers > idleRegisters;
+    std::shared_ptr< VBox::SyntheticBackend >    halted( std::make_shared< VBox::SyntheticBackend >( VBox::SyntheticBackend::minimumMemorySize ) );
+    std::unique_ptr< VBox::Monitor >             haltedMonitor;
+    std::shared_ptr< const VBox::VM::Registers > haltedRegisters;
+    std::string                                  self( ExecutablePath( argv[ 0 ] ) );
+    uint64_t                                     dumpSize( std::min< uint64_t >( coreSize, 256 ) );
+    std::string                                  registers( CannedRegisters() );
+    std::string                                  stack( CannedStack( 16 ) );
+    std::string                                  running( CannedRunningVMs( 8 ) );
+    std::string                                  processes( CannedProcesses( 400 ) );
+    std::string                                  notRunning( CannedError( "is not currently running" ) );
+    std::string                                  saving( CannedError( "is not mutable (state is Saving)" ) );
+    std::shared_ptr< VBox::CLIBackend >          cli( std::make_shared< VBox::CLIBackend >() );
+    std::string                                  consoleMemory( CannedConsoleMemory( 0x200000, 16384 ) );
+    std::vector< uint8_t >                       consoleBytes( 16384 );
+    std::unique_ptr< VBox::DebugConsole >        console;
+    VBox::VM::PartialCore                        consoleCore;
+    std::unique_ptr< VBox::Monitor >             consoleMonitor;
+    std::shared_ptr< VBox::VM::CoreDump >        consolePublished;
+    uint16_t                                     consolePort( FakeDebugConsole() );
+    VBox::VM::Registers                          parsedRegisters( VBox::Manage::Parse::registers( registers ).value_or( VBox::VM::Registers() ) );
+    std::vector< VBox::VM::StackEntry >          parsedStack( VBox::Manage::Parse::stack( stack ) );
+    VBox::VM::Registers                          copiedRegisters;
+    std::vector< VBox::VM::StackEntry >          copiedStack;
+    VBox::StopToken                              token;
+    std::unique_ptr< VBox::Monitor >             slowMonitor;
+    
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+        data[ i ] = static_cast< uint8_t >( i * 31 );
+    }
+    
+    for( size_t i = 0; i < memory.size(); i++ )
+    {
+        memory[ i ] = static_cast< uint8_t >( i * 7 );
+    }
+    
+    for( size_t i = 0; i < 256; i++ )
+    {
+        code.insert( code.end(), { 0x55, 0x48, 0x89, 0xE5, 0x48, 0x83, 0xEC, 0x10, 0x89, 0x7D, 0xFC, 0x8B, 0x45, 0xFC, 0xC9, 0xC3 } );
+    }
+    
+    WriteDataFile( dataPath, dataSize );
+    WriteCoreFile( corePath, memorySize, true );
+    
+    runner.add
+    (
+        "stream.data.uint32", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinaryDataStream stream( data );
+            uint64_t               sum( 0 );
+            
+            for( size_t i = 0; i < dataSize / 4; i++ )
+            {
+                sum += stream.ReadLittleEndianUInt32();
+            }
+            
+            sink = sink + sum;
+        }
+    );
+    
+    runner.add
+    (
+        "stream.data.reader.uint32", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinaryDataStream                       stream( data );
+            VBox::BinaryReader< VBox::BinaryDataStream > reader( stream );
+            uint64_t                                     sum( 0 );
+            
+            for( size_t i = 0; i < dataSize / 4; i++ )
+            {
+                sum += reader.Read< uint32_t, VBox::Endianness::Little >();
+            }
+            
+            sink = sink + sum;
+        }
+    );
+    
+    runner.add
+    (
+        "stream.data.reader.record", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinaryDataStream                       stream( data );
+            VBox::BinaryReader< VBox::BinaryDataStream > reader( stream );
+            uint64_t                                     sum( 0 );
+            
+            for( size_t i = 0; i < dataSize / 56; i++ )
+            {
+                VBox::BinaryRecord< 56, VBox::Endianness::Little > record( reader.ReadRecord< 56, VBox::Endianness::Little >() );
+                
+                sum += record.Get< uint32_t, 0 >() + record.Get< uint64_t, 8 >() + record.Get< uint64_t, 32 >();
+            }
+            
+            sink = sink + sum;
+        }
+    );
+    
+    runner.add
+    (
+        "stream.span.uint32", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinarySpan                       span( data.data(), data.size() );
+            VBox::BinaryReader< VBox::BinarySpan > reader( span );
+            uint64_t                               sum( 0 );
+            
+            for( size_t i = 0; i < dataSize / 4; i++ )
+            {
+                sum += reader.Read< uint32_t, VBox::Endianness::Little >();
+            }
+            
+            sink = sink + sum;
+        }
+    );
+    
+    runner.add
+    (
+        "stream.span.record", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinarySpan                       span( data.data(), data.size() );
+            VBox::BinaryReader< VBox::BinarySpan > reader( span );
+            uint64_t                               sum( 0 );
+            
+            for( size_t i = 0; i < dataSize / 56; i++ )
+            {
+                VBox::BinaryRecord< 56, VBox::Endianness::Little > record( reader.ReadRecord< 56, VBox::Endianness::Little >() );
+                
+                sum += record.Get< uint32_t, 0 >() + record.Get< uint64_t, 8 >() + record.Get< uint64_t, 32 >();
+            }
+            
+            sink = sink + sum;
+        }
+    );
+    
+    runner.add
+    (
+        "stream.data.read", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinaryDataStream stream( data );
+            
+            while( stream.HasBytesAvailable() )
+            {
+                sink = sink + stream.Read( std::min< size_t >( stream.AvailableBytes(), 65536 ) ).size();
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "stream.file.uint32", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinaryFileStream stream( dataPath );
+            uint64_t               sum( 0 );
+            
+            for( size_t i = 0; i < dataSize / 4; i++ )
+            {
+                sum += stream.ReadLittleEndianUInt32();
+            }
+            
+            sink = sink + sum;
+        }
+    );
+    
+    runner.add
+    (
+        "stream.file.read", 20, dataSize,
+        [ & ]( void )
+        {
+            VBox::BinaryFileStream stream( dataPath );
+            
+            while( stream.HasBytesAvailable() )
+            {
+                sink = sink + stream.Read( std::min< size_t >( stream.AvailableBytes(), 65536 ) ).size();
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "stream.file.seek", 20, 4096 * 8,
+        [ & ]( void )
+        {
+            VBox::BinaryFileStream stream( dataPath );
+            std::mt19937_64        rng( 42 );
+            
+            for( size_t i = 0; i < 4096; i++ )
+            {
+                stream.Seek( static_cast< ssize_t >( rng() % ( dataSize - 8 ) ), VBox::BinaryStream::SeekDirection::Begin );
+                
+                sink = sink + stream.ReadLittleEndianUInt64();
+            }
+        }
+    );
+    
+    /*
+     * Cold reads larger than a page, at offsets that are not aligned,
+     * which miss the read-ahead window. The bytes are checked against the
+     * file's contents.
+     */
+    runner.add
+    (
+        "stream.file.unaligned", 20, 10000 * 64,
+        [ & ]( void )
+        {
+            for( size_t i = 0; i < 64; i++ )
+            {
+                VBox::BinaryFileStream stream( dataPath );
+                std::vector< uint8_t > bytes( 10000 );
+                size_t                 offset( 5000 + i * 100003 );
+                
+                stream.Seek( static_cast< ssize_t >( offset ), VBox::BinaryStream::SeekDirection::Begin );
+                stream.Read( bytes.data(), bytes.size() );
+                
+                if( memcmp( bytes.data(), data.data() + offset, bytes.size() ) != 0 )
+                {
+                    throw std::runtime_error( "Unaligned read does not match the file" );
+                }
+            }
+        }
+    );
+    
+    for( auto backend: { VBox::FileReader::Backend::Threads, VBox::FileReader::Backend::IOUring } )
+    {
+        if( VBox::FileReader::supports( backend ) == false )
+        {
+            continue;
+        }
+        
+        for( bool direct: { false, true } )
+        {
+            std::string name( ( backend == VBox::FileReader::Backend::IOUring ) ? "reader.uring" : "reader.threads" );
+            
+            runner.add
+            (
+                ( direct ) ? name + ".direct" : name, 5, memorySize,
+                [ &, backend, direct ]( void )
+                {
+                    VBox::FileReader reader( corePath, backend, direct );
+                    
+                    reader.read
+                    (
+                        { { 0, reader.size() } },
+                        [ & ]( size_t, uint64_t, const uint8_t * p, size_t size )
+                        {
+                            sink = sink + p[ 0 ] + size;
+                        }
+                    );
+                }
+            );
+        }
+    }
+    
+    runner.add
+    (
+        "elf.parse", 1000, 0,
+        [ & ]( void )
+        {
+            VBox::BinaryFileStream stream( corePath );
+            VBox::ELF::File        elf( stream );
+            
+            sink = sink + elf.programHeader().size();
+        }
+    );
+    
+    runner.add
+    (
+        "elf.map", 1000, 0,
+        [ & ]( void )
+        {
+            VBox::ELF::File elf( corePath );
+            
+            sink = sink + elf.programHeaders().size();
+        }
+    );
+    
+    runner.add
+    (
+        "coredump.load", 20, memorySize,
+        [ & ]( void )
+        {
+            VBox::VM::CoreDump dump( corePath );
+            
+            sink = sink + dump.memorySize();
+        }
+    );
+    
+    runner.add
+    (
+        "coredump.readMemory", 20, 4096 * 4096,
+        [ & ]( void )
+        {
+            std::mt19937_64 rng( 42 );
+            
+            if( dump == nullptr )
+            {
+                dump = std::make_shared< VBox::VM::CoreDump >( corePath );
+            }
+            
+            {
+                auto ranges( dump->addressSpace().ranges() );
+                
+                for( size_t i = 0; i < 4096; i++ )
+                {
+                    auto range( ranges[ rng() % ranges.size() ] );
+                    
+                    sink = sink + dump->readMemory( range.first + ( rng() % ( range.second / 4096 ) ) * 4096, 4096 ).size();
+                }
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "coredump.lookup", 20, 65536 * 8,
+        [ & ]( void )
+        {
+            std::mt19937_64 rng( 42 );
+            
+            if( dump == nullptr )
+            {
+                dump = std::make_shared< VBox::VM::CoreDump >( corePath );
+            }
+            
+            /*
+             * Only the segment lookup is measured: touching the returned
+             * memory would measure page faults on the sparse core instead.
+             */
+            {
+                const VBox::VM::AddressSpace & memory( dump->addressSpace() );
+                uint64_t                       end( memory.end() );
+                
+                for( size_t i = 0; i < 65536; i++ )
+                {
+                    sink = sink + ( memory.data( ( rng() % end ) & ~UINT64_C( 7 ), 8 ) != nullptr );
+                }
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "pagestore.isZero", 20, zeros.size(),
+        [ & ]( void )
+        {
+            for( size_t i = 0; i < zeros.size(); i += VBox::VM::PageStore::pageSize )
+            {
+                sink = sink + VBox::VM::PageStore::isZero( zeros.data() + i );
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "pagestore.hash", 20, data.size(),
+        [ & ]( void )
+        {
+            for( size_t i = 0; i < data.size(); i += VBox::VM::PageStore::pageSize )
+            {
+                sink = sink + VBox::VM::PageStore::hash( data.data() + i );
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "pagestore.load", 5, memorySize,
+        [ & ]( void )
+        {
+            std::shared_ptr< VBox::VM::PageStore > store( std::make_shared< VBox::VM::PageStore >() );
+            VBox::VM::CoreDump                     dump( corePath, store );
+            
+            sink = sink + store->pages();
+        }
+    );
+    
+    runner.add
+    (
+        "pagestore.load.mapped", 5, memorySize,
+        [ & ]( void )
+        {
+            std::shared_ptr< VBox::VM::PageStore > store( std::make_shared< VBox::VM::PageStore >() );
+            VBox::VM::CoreDump                     dump( VBox::ELF::File( corePath ), store );
+            
+            sink = sink + store->pages();
+        }
+    );
+    
+    #ifdef VBOX_HAVE_LZ4
+    runner.add
+    (
+        "pagestore.load.lz4", 5, memorySize,
+        [ & ]( void )
+        {
+            std::shared_ptr< VBox::VM::PageStore > store( std::make_shared< VBox::VM::PageStore >( VBox::VM::PageStore::Compression::LZ4 ) );
+            VBox::VM::CoreDump                     dump( corePath, store );
+            
+            sink = sink + store->pages();
+        }
+    );
+    #endif
+    
+    runner.add
+    (
+        "pagestore.readMemory", 20, 4096 * 4096,
+        [ & ]( void )
+        {
+            std::mt19937_64 rng( 42 );
+            
+            if( stored == nullptr )
+            {
+                stored = std::make_shared< VBox::VM::CoreDump >( corePath, std::make_shared< VBox::VM::PageStore >() );
+            }
+            
+            {
+                auto ranges( stored->addressSpace().ranges() );
+                
+                for( size_t i = 0; i < 4096; i++ )
+                {
+                    auto range( ranges[ rng() % ranges.size() ] );
+                    
+                    sink = sink + stored->readMemory( range.first + ( rng() % ( range.second / 4096 ) ) * 4096, 4096 ).size();
+                }
+            }
+        }
+    );
+    
+    for( size_t threads: { size_t( 1 ), size_t( 0 ) } )
+    {
+        runner.add
+        (
+            ( threads == 1 ) ? "pageindex.build.serial" : "pageindex.build", 5, memorySize,
+            [ &, threads ]( void )
+            {
+                if( dump == nullptr )
+                {
+                    dump = std::make_shared< VBox::VM::CoreDump >( corePath );
+                }
+                
+                {
+                    VBox::VM::PageIndex index( dump->addressSpace(), threads );
+                    
+                    sink = sink + index.zeroPages();
+                }
+            }
+        );
+    }
+    
+    runner.add
+    (
+        "pageindex.build.store", 5, memorySize,
+        [ & ]( void )
+        {
+            if( stored == nullptr )
+            {
+                stored = std::make_shared< VBox::VM::CoreDump >( corePath, std::make_shared< VBox::VM::PageStore >() );
+            }
+            
+            {
+                VBox::VM::PageIndex index( stored->addressSpace() );
+                
+                sink = sink + index.zeroPages();
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "pageindex.diff", 5, memorySize,
+        [ & ]( void )
+        {
+            if( dump == nullptr )
+            {
+                dump = std::make_shared< VBox::VM::CoreDump >( corePath );
+            }
+            
+            if( dump->pageIndex() == nullptr )
+            {
+                dump->buildPageIndex();
+            }
+            
+            {
+                VBox::VM::PageIndex index( dump->addressSpace(), *( dump->pageIndex() ) );
+                
+                sink = sink + index.changedPages();
+            }
+        }
+    );
+    
+    VBox::Manage::executable( self );
+    
+    runner.add
+    (
+        "manage.dump", 5, dumpSize * 1024 * 1024,
+        [ & ]( void )
+        {
+            std::shared_ptr< VBox::VM::CoreDump > dump( VBox::Manage::Debug::dump( std::to_string( dumpSize ) ) );
+            
+            if( dump == nullptr )
+            {
+                throw std::runtime_error( "Cannot dump from the fake VBoxManage" );
+            }
+            
+            sink = sink + dump->memorySize();
+        }
+    );
+    
+    for( auto kind: { VBox::VM::DumpTarget::Kind::MemoryFile, VBox::VM::DumpTarget::Kind::Pipe } )
+    {
+        if( VBox::VM::DumpTarget::supports( kind ) == false )
+        {
+            continue;
+        }
+        
+        runner.add
+        (
+            ( kind == VBox::VM::DumpTarget::Kind::MemoryFile ) ? "manage.dump.memfd" : "manage.dump.pipe", 5, dumpSize * 1024 * 1024,
+            [ &, kind ]( void )
+            {
+                VBox::VM::DumpTarget target( kind );
+                VBox::Process        proc( VBox::Manage::executable(), { "debugvm", std::to_string( dumpSize ), "dumpvmcore", "--filename=" + target.path() } );
+                
+                proc.start();
+                proc.waitUntilExit();
+                
+                {
+                    VBox::VM::CoreDump dump( target.receive() );
+                    
+                    sink = sink + dump.memorySize();
+                }
+            }
+        );
+    }
+    
+    runner.add
+    (
+        "monitor.memory.refresh", 10, dumpSize * 1024 * 1024,
+        [ & ]( void )
+        {
+            if( monitor == nullptr )
+            {
+                monitor = std::make_unique< VBox::Monitor >( std::to_string( dumpSize ), std::make_shared< VBox::VM::PageStore >() );
+                
+                /*
+                 * The canned core never changes, so it is sampled at a
+                 * fixed rate rather than backed off.
+                 */
+                monitor->sampling( std::chrono::microseconds( 0 ), std::chrono::microseconds( 0 ) );
+                monitor->subscribe( 0, dumpSize * 1024 * 1024 );
+                monitor->start();
+            }
+            
+            while( monitor->dump() == nullptr || monitor->dump() == published )
+            {
+                std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+            }
+            
+            published = monitor->dump();
+        }
+    );
+    
+    /*
+     * One failed sample: the fake VBoxManage only dumps, so getregisters
+     * fails like with a VM that is not running. Monitor channels back off
+     * between such samples instead of running them back to back.
+     */
+    runner.add
+    (
+        "cli.registers.failure", 100, 0,
+        [ & ]( void )
+        {
+            if( cli->registers( "VM", copiedRegisters, token ) != VBox::Backend::Error::NotRunning )
+            {
+                throw std::runtime_error( "Failure not reported as a stopped VM" );
+            }
+        }
+    );
+    
+    /*
+     * Reads the snapshots like a UI frame does. The monitor is stopped
+     * first, as the allocation count is process-wide.
+     */
+    runner.add
+    (
+        "monitor.snapshot", 1000, 0,
+        [ & ]( void )
+        {
+            if( monitor == nullptr )
+            {
+                monitor = std::make_unique< VBox::Monitor >( std::to_string( dumpSize ), std::make_shared< VBox::VM::PageStore >() );
+            }
+            
+            monitor->stop();
+            
+            {
+                std::shared_ptr< const VBox::VM::Registers >                 regs(    monitor->registers() );
+                std::shared_ptr< const VBox::VM::RegisterHistory >           history( monitor->registerHistory() );
+                std::shared_ptr< const std::vector< VBox::VM::StackEntry > > entries( monitor->stack() );
+                std::shared_ptr< VBox::VM::CoreDump >                        dump(    monitor->dump() );
+                
+                sink = sink + ( ( regs != nullptr ) ? regs->rip() : 0 ) + history->samples() + entries->size() + ( ( dump != nullptr ) ? dump->memorySize() : 0 );
+            }
+        }
+    );
+    
+    /*
+     * Stops a monitor while its requests are stuck in VBoxManage, which
+     * the fake one does for the "slow" VM, and reports the time stop()
+     * takes. The token wakes every wait of the threads, so that is the
+     * time to kill and reap the requests, plus a spawn that is in flight,
+     * well under a millisecond. The limit leaves room for a loaded host.
+     * It runs once the other monitor is stopped, as its dumps would
+     * compete for the CPU.
+     */
+    runner.add
+    (
+        "monitor.stop", 10, 0, std::chrono::milliseconds( 20 ),
+        [ & ]( void ) -> std::chrono::nanoseconds
+        {
+            std::chrono::steady_clock::time_point start;
+            
+            if( slowMonitor == nullptr )
+            {
+                slowMonitor = std::make_unique< VBox::Monitor >( "slow", nullptr, cli );
+            }
+            
+            slowMonitor->start();
+            std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+            
+            start = std::chrono::steady_clock::now();
+            
+            slowMonitor->stop();
+            
+            return std::chrono::steady_clock::now() - start;
+        }
+    );
+    
+    /*
+     * The synthetic guest has no process to spawn, so these measure the
+     * pipeline itself, at rates the VBoxManage backend cannot reach.
+     */
+    std::shared_ptr< VBox::SyntheticBackend > synthetic( std::make_shared< VBox::SyntheticBackend >( dumpSize * 1024 * 1024, 4096, 4, 16 ) );
+    VBox::VM::DumpTarget                      syntheticTarget;
+    
+    synthetic->startVM( "synthetic" );
+    
+    runner.add
+    (
+        "synthetic.sample", 1000, 0,
+        [ & ]( void )
+        {
+            if( synthetic->registers( "synthetic", copiedRegisters, token ) != VBox::Backend::Error::None || synthetic->stack( "synthetic", copiedStack, token ) != VBox::Backend::Error::None )
+            {
+                throw std::runtime_error( "Cannot sample the synthetic guest" );
+            }
+            
+            sink = sink + copiedRegisters.rip() + copiedStack.size();
+        }
+    );
+    
+    runner.add
+    (
+        "synthetic.capture", 10, synthetic->memorySize(),
+        [ & ]( void )
+        {
+            std::optional< VBox::ELF::File > elf;
+            
+            if( synthetic->capture( "synthetic", syntheticTarget, elf, token ) != VBox::Backend::Error::None || elf.has_value() == false )
+            {
+                throw std::runtime_error( "Cannot capture the synthetic guest" );
+            }
+            
+            sink = sink + elf->programHeaders().size();
+        }
+    );
+    
+    runner.add
+    (
+        "monitor.synthetic.refresh", 10, synthetic->memorySize(),
+        [ & ]( void )
+        {
+            if( syntheticMonitor == nullptr )
+            {
+                syntheticMonitor = std::make_unique< VBox::Monitor >( "synthetic", std::make_shared< VBox::VM::PageStore >(), synthetic );
+                
+                syntheticMonitor->subscribe( 0, synthetic->memorySize() );
+                syntheticMonitor->start();
+            }
+            
+            while( syntheticMonitor->dump() == nullptr || syntheticMonitor->dump() == syntheticPublished )
+            {
+                std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+            }
+            
+            syntheticPublished = syntheticMonitor->dump();
+        }
+    );
+    
+    /*
+     * Register sampling with no memory subscribed to, as with a terminal
+     * too small for the memory panes: nothing is captured at all.
+     */
+    runner.add
+    (
+        "monitor.synthetic.idle", 100, 0,
+        [ & ]( void )
+        {
+            if( idleMonitor == nullptr )
+            {
+                if( syntheticMonitor != nullptr )
+                {
+                    syntheticMonitor->stop();
+                }
+                
+                idleMonitor = std::make_unique< VBox::Monitor >( "synthetic", std::make_shared< VBox::VM::PageStore >(), synthetic );
+                
+                idleMonitor->start();
+            }
+            
+            while( idleMonitor->registers() == nullptr || idleMonitor->registers() == idleRegisters )
+            {
+                std::this_thread::sleep_for( std::chrono::microseconds( 10 ) );
+            }
+            
+            if( idleMonitor->acquisition() != VBox::Monitor::Acquisition::None || idleMonitor->dump() != nullptr )
+            {
+                throw std::runtime_error( "Memory captured without a subscription" );
+            }
+            
+            idleRegisters = idleMonitor->registers();
+        }
+    );
+    
+    runner.add
+    (
+        "sample.hash.registers", 1000, sizeof( VBox::VM::Registers ),
+        [ & ]( void )
+        {
+            sink = sink + VBox::SampleRate::hash( &parsedRegisters, sizeof( parsedRegisters ) );
+        }
+    );
+    
+    /*
+     * A halted guest is sampled less and less often. This is the 20ms it
+     * is left halted, during which sampling backs off to 16ms, plus the
+     * time for the first sample after resuming it, which interact() makes
+     * immediate rather than up to an interval away.
+     */
+    runner.add
+    (
+        "monitor.synthetic.wake", 20, 0,
+        [ & ]( void )
+        {
+            if( haltedMonitor == nullptr )
+            {
+                halted->startVM( "halted" );
+                
+                haltedMonitor = std::make_unique< VBox::Monitor >( "halted", nullptr, halted );
+                
+                haltedMonitor->start();
+            }
+            
+            halted->halted( true );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+            
+            if( haltedMonitor->samplingInterval( VBox::Stats::Channel::Registers ).count() == 0 )
+            {
+                throw std::runtime_error( "Sampling did not back off" );
+            }
+            
+            halted->halted( false );
+            haltedMonitor->interact();
+            
+            while( haltedMonitor->registers() == nullptr || haltedMonitor->registers() == haltedRegisters )
+            {
+                std::this_thread::sleep_for( std::chrono::microseconds( 10 ) );
+            }
+            
+            haltedRegisters = haltedMonitor->registers();
+        }
+    );
+    
+    runner.add
+    (
+        "parse.registers", 1000, registers.size(),
+        [ & ]( void )
+        {
+            sink = sink + VBox::Manage::Parse::registers( registers ).value_or( VBox::VM::Registers() ).rip();
+        }
+    );
+    
+    runner.add
+    (
+        "parse.registers.reuse", 1000, registers.size(),
+        [ & ]( void )
+        {
+            if( VBox::Manage::Parse::registers( registers, parsedRegisters ) )
+            {
+                sink = sink + parsedRegisters.rip();
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "parse.stack", 1000, stack.size(),
+        [ & ]( void )
+        {
+            sink = sink + VBox::Manage::Parse::stack( stack ).size();
+        }
+    );
+    
+    runner.add
+    (
+        "parse.stack.reuse", 1000, stack.size(),
+        [ & ]( void )
+        {
+            VBox::Manage::Parse::stack( stack, parsedStack );
+            
+            sink = sink + parsedStack.size();
+        }
+    );
+    
+    runner.add
+    (
+        "snapshot.copy", 1000, sizeof( VBox::VM::Registers ) + parsedStack.size() * sizeof( VBox::VM::StackEntry ),
+        [ & ]( void )
+        {
+            copiedRegisters = parsedRegisters;
+            
+            copiedStack.assign( parsedStack.begin(), parsedStack.end() );
+            
+            sink = sink + copiedRegisters.rip() + copiedStack.size();
+        }
+    );
+    
+    runner.add
+    (
+        "parse.runningvms", 1000, running.size(),
+        [ & ]( void )
+        {
+            sink = sink + VBox::Manage::Parse::runningVMs( running ).size();
+        }
+    );
+    
+    runner.add
+    (
+        "parse.memory", 1000, consoleMemory.size(),
+        [ & ]( void )
+        {
+            if( VBox::Manage::Parse::memory( consoleMemory, 0x200000, consoleBytes.size(), consoleBytes.data() ) != consoleBytes.size() )
+            {
+                throw std::runtime_error( "Cannot parse the canned console output" );
+            }
+            
+            sink = sink + consoleBytes[ 8 ];
+        }
+    );
+    
+    /*
+     * What the UI subscribes to: 512 bytes at RIP and a screen of hex,
+     * read through the fake console as one batch of commands, and turned
+     * into a core. Its image is recycled, so only the ELF::File allocates.
+     */
+    runner.add
+    (
+        "console.read", 1000, 0,
+        [ & ]( void )
+        {
+            uint64_t value( 0 );
+            
+            if( console == nullptr )
+            {
+                console = std::make_unique< VBox::DebugConsole >( "127.0.0.1", consolePort );
+            }
+            
+            if( console->read( { { 0x100123, 512 }, { 0x200000, 6 * 1024 } }, consoleCore ) == false )
+            {
+                throw std::runtime_error( "Cannot read from the fake console" );
+            }
+            
+            memcpy( &value, consoleCore.data( 0 ) + 8, sizeof( value ) );
+            
+            if( value != 0x100008 )
+            {
+                throw std::runtime_error( "Unexpected memory from the fake console" );
+            }
+            
+            {
+                VBox::ELF::File                 elf( consoleCore.file() );
+                VBox::ELF::ProgramHeaderEntry   segment( elf.programHeaders()[ 0 ] );
+                const uint8_t                 * bytes( elf.data( segment.offset() + 8, sizeof( value ) ) );
+                
+                if( segment.paddress() != 0x100000 || bytes == nullptr || memcmp( bytes, &value, sizeof( value ) ) != 0 )
+                {
+                    throw std::runtime_error( "Unexpected core from the fake console" );
+                }
+            }
+            
+            sink = sink + consoleCore.size();
+        }
+    );
+    
+    /*
+     * Same as monitor.memory.refresh for a small subscription, which is
+     * read through the fake console rather than dumped.
+     */
+    runner.add
+    (
+        "monitor.console.refresh", 100, 4096,
+        [ & ]( void )
+        {
+            if( consoleMonitor == nullptr )
+            {
+                consoleMonitor = std::make_unique< VBox::Monitor >( std::to_string( dumpSize ), nullptr, std::make_shared< VBox::CLIBackend >( consolePort ) );
+                
+                consoleMonitor->sampling( std::chrono::microseconds( 0 ), std::chrono::microseconds( 0 ) );
+                consoleMonitor->subscribe( 0x200000, 4096 );
+                consoleMonitor->start();
+            }
+            
+            while( consoleMonitor->dump() == nullptr || consoleMonitor->dump() == consolePublished )
+            {
+                std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+            }
+            
+            if( consoleMonitor->acquisition() != VBox::Monitor::Acquisition::Read )
+            {
+                throw std::runtime_error( "Memory not read through the fake console" );
+            }
+            
+            consolePublished = consoleMonitor->dump();
+        }
+    );
+    
+    runner.add
+    (
+        "parse.error", 1000, notRunning.size() + saving.size(),
+        [ & ]( void )
+        {
+            if( VBox::Manage::Parse::error( notRunning ) != VBox::Backend::Error::NotRunning || VBox::Manage::Parse::error( saving ) != VBox::Backend::Error::Busy )
+            {
+                throw std::runtime_error( "Cannot classify the canned errors" );
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "parse.hostprocess", 1000, processes.size(),
+        [ & ]( void )
+        {
+            sink = sink + static_cast< uint64_t >( VBox::Manage::Parse::hostProcess( processes, "VM-7", "6b7a2c9e-0f4d-4e1b-9a3c-000000000007" ).value_or( 0 ) );
+        }
+    );
+    
+    /*
+     * Time from a process exiting to its watcher noticing it, which polling
+     * the running VMs list would only see on its next interval.
+     */
+    if( VBox::ProcessWatcher::supports() )
+    {
+        runner.add
+        (
+            "process.watch.exit", 100, 0,
+            [ & ]( void )
+            {
+                pid_t pid( fork() );
+                
+                if( pid == 0 )
+                {
+                    _exit( 0 );
+                }
+                
+                if( pid == -1 )
+                {
+                    throw std::runtime_error( "Cannot fork" );
+                }
+                
+                {
+                    VBox::ProcessWatcher watcher( pid );
+                    bool                 exited( watcher.wait( std::chrono::milliseconds( 1000 ) ) );
+                    
+                    waitpid( pid, nullptr, 0 );
+                    
+                    if( exited == false )
+                    {
+                        throw std::runtime_error( "Process exit not seen" );
+                    }
+                }
+            }
+        );
+    }
+    
+    /*
+     * A request to the "slow" VM, which the fake VBoxManage does not
+     * answer, killed at a 10ms deadline. The time includes the spawn, and
+     * the 10ms.
+     */
+    runner.add
+    (
+        "process.timeout", 20, 0,
+        [ & ]( void )
+        {
+            VBox::Process proc( self, { "debugvm", "slow", "getregisters" } );
+            
+            proc.start();
+            
+            if( proc.waitFor( std::chrono::steady_clock::now() + std::chrono::milliseconds( 10 ) ) || proc.timedOut() == false || proc.wallTime().has_value() == false )
+            {
+                throw std::runtime_error( "Process did not time out" );
+            }
+            
+            sink = sink + static_cast< uint64_t >( proc.cpuTime().value_or( std::chrono::nanoseconds( 0 ) ).count() );
+        }
+    );
+    
+    #ifdef VBOX_HAVE_CAPSTONE
+    runner.add
+    (
+        "capstone.disassemble", 100, code.size(),
+        [ & ]( void )
+        {
+            sink = sink + VBox::Capstone::disassemble( code, 0x7C00 ).size();
+        }
+    );
+    #endif
+    
+    runner.add
+    (
+        "string.toHex.uint8", 20, memory.size(),
+        [ & ]( void )
+        {
+            for( uint8_t b: memory )
+            {
+                sink = sink + VBox::String::toHex( b ).size();
+            }
+        }
+    );
+    
+    runner.add
+    (
+        "string.toHex.uint64", 1000, VBox::VM::Registers::count * sizeof( uint64_t ),
+        [ & ]( void )
+        {
+            for( size_t i = 0; i < VBox::VM::Registers::count; i++ )
+            {
+                sink = sink + VBox::String::toHex( static_cast< uint64_t >( i ) * 0x0123456789ABCDEF ).size();
+            }
+        }
+    );
+    
+    {
+        std::string json( runner.run() );
+        
+        if( monitor != nullptr )
+        {
+            monitor->stop();
+        }
+        
+        if( syntheticMonitor != nullptr )
+        {
+            syntheticMonitor->stop();
+        }
+        
+        if( idleMonitor != nullptr )
+        {
+            idleMonitor->stop();
+        }
+        
+        if( consoleMonitor != nullptr )
+        {
+            consoleMonitor->stop();
+        }
+        
+        if( haltedMonitor != nullptr )
+        {
+            haltedMonitor->stop();
+        }
+        
+        unlink( dataPath.c_str() );
+        unlink( corePath.c_str() );
+        
+        if( output.length() == 0 )
+        {
+            std::cout << json;
+        }
+        else
+        {
+            std::ofstream stream( output );
+            
+            if( stream.good() == false )
+            {
+                std::cerr << "Cannot write results: " << output << std::endl;
+                
+                return EXIT_FAILURE;
+            }
+            
+            stream << json;
+        }
+    }
+    
+    return ( runner.failures() > 0 ) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+void ShowHelp( void )
+{
+    std::cout << "Usage: vbox-monitor-benchmarks [OPTIONS]"
+              << std::endl
+              << std::endl
+              << "Options:"
+              << std::endl
+              << "    --iterations N:  Override the number of iterations of every benchmark"
+              << std::endl
+              << "    --filter NAME:   Only run benchmarks whose name contains NAME"
+              << std::endl
+              << "    --core-size MiB: Memory size of the synthetic core dump (default: 1024)"
+              << std::endl
+              << "    --output FILE:   Write the JSON results to FILE instead of stdout"
+              << std::endl;
+}
+
+std::string TemporaryFile( void )
+{
+    char path[] = "/tmp/vbox-monitor-benchmarks.XXXXXX";
+    int  fd( mkstemp( path ) );
+    
+    if( fd == -1 )
+    {
+        throw std::runtime_error( "Cannot create temporary file" );
+    }
+    
+    close( fd );
+    
+    return path;
+}
+
+void WriteDataFile( const std::string & path, size_t size )
+{
+    std::ofstream          stream( path, std::ios::binary );
+    std::vector< uint8_t > data( size );
+    
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+        data[ i ] = static_cast< uint8_t >( i * 31 );
+    }
+    
+    stream.write( reinterpret_cast< const char * >( data.data() ), static_cast< std::streamsize >( data.size() ) );
+}
+
+/*
+ * Writes an ELF64 core with the layout produced by VBoxManage dumpvmcore:
+ * a PT_NOTE entry followed by one PT_LOAD entry per guest RAM range, with
+ * holes for legacy video memory and for the PCI hole below 4 GiB. The
+ * memory itself is left sparse, except for one non-zero page per MiB.
+ */
+void WriteCoreFile( const std::string & path, uint64_t memorySize, bool sparse )
+{
+    std::vector< uint8_t >                         header;
+    std::vector< std::pair< uint64_t, uint64_t > > ranges;
+    uint64_t                                       phOffset( 64 );
+    uint64_t                                       noteSize( 0x100 );
+    uint64_t                                       memOffset( 0x1000 );
+    uint64_t                                       left( memorySize );
+    
+    for( auto range: std::vector< std::pair< uint64_t, uint64_t > >{ { 0, 0xA0000 }, { 0x100000, 0xE0000000 - 0x100000 }, { 0x100000000, UINT64_MAX - 0x100000000 } } )
+    {
+        uint64_t size( std::min( left, range.second ) );
+        
+        if( size > 0 )
+        {
+            ranges.push_back( { range.first, size } );
+        }
+        
+        left -= size;
+    }
+    
+    auto put = [ & ]( uint64_t v, size_t n )
+    {
+        for( size_t i = 0; i < n; i++ )
+        {
+            header.push_back( static_cast< uint8_t >( v >> ( i * 8 ) ) );
+        }
+    };
+    
+    header.insert( header.end(), { 0x7F, 'E', 'L', 'F', 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0 } );
+    put( 4, 2 );          /* ET_CORE */
+    put( 0x3E, 2 );       /* EM_X86_64 */
+    put( 1, 4 );
+    put( 0, 8 );
+    put( phOffset, 8 );
+    put( 0, 8 );
+    put( 0, 4 );
+    put( 64, 2 );
+    put( 56, 2 );
+    put( 1 + ranges.size(), 2 );
+    put( 0, 2 );
+    put( 0, 2 );
+    put( 0, 2 );
+    
+    put( 4, 4 );          /* PT_NOTE */
+    put( 0, 4 );
+    put( phOffset + ( 1 + ranges.size() ) * 56, 8 );
+    put( 0, 8 );
+    put( 0, 8 );
+    put( noteSize, 8 );
+    put( noteSize, 8 );
+    put( 1, 8 );
+    
+    {
+        uint64_t offset( memOffset );
+        
+        for( const auto & range: ranges )
+        {
+            put( 1, 4 );  /* PT_LOAD */
+            put( 6, 4 );
+            put( offset, 8 );
+            put( 0, 8 );
+            put( range.first, 8 );
+            put( range.second, 8 );
+            put( range.second, 8 );
+            put( 0x1000, 8 );
+            
+            offset += range.second;
+        }
+    }
+    
+    header.resize( memOffset, 0 );
+    
+    {
+        std::ofstream          stream( path, std::ios::binary );
+        std::vector< uint8_t > page( 4096 );
+        
+        for( size_t i = 0; i < page.size(); i++ )
+        {
+            page[ i ] = static_cast< uint8_t >( i * 13 + 1 );
+        }
+        
+        stream.write( reinterpret_cast< const char * >( header.data() ), static_cast< std::streamsize >( header.size() ) );
+        
+        if( sparse )
+        {
+            for( uint64_t offset = 0; offset < memorySize; offset += 1024 * 1024 )
+            {
+                stream.seekp( static_cast< std::streamoff >( memOffset + offset ), std::ios::beg );
+                stream.write( reinterpret_cast< const char * >( page.data() ), static_cast< std::streamsize >( std::min< uint64_t >( page.size(), memorySize - offset ) ) );
+            }
+            
+            stream.close();
+            
+            if( truncate( path.c_str(), static_cast< off_t >( memOffset + memorySize ) ) != 0 )
+            {
+                throw std::runtime_error( "Cannot write core file" );
+            }
+        }
+        else
+        {
+            std::vector< uint8_t > chunk( 1024 * 1024 );
+            
+            std::copy( page.begin(), page.end(), chunk.begin() );
+            
+            for( uint64_t offset = 0; offset < memorySize; offset += chunk.size() )
+            {
+                stream.write( reinterpret_cast< const char * >( chunk.data() ), static_cast< std::streamsize >( std::min< uint64_t >( chunk.size(), memorySize - offset ) ) );
+            }
+            
+            stream.close();
+        }
+        
+        if( stream.fail() )
+        {
+            throw std::runtime_error( "Cannot write core file" );
+        }
+    }
+}
+
+std::string CannedRegisters( void )
+{
+    std::stringstream ss;
+    
+    for( size_t i = 0; i < VBox::VM::Registers::count; i++ )
+    {
+        ss << VBox::VM::Registers::name( static_cast< VBox::VM::Registers::ID >( i ) )
+           << " = 0x"
+           << std::hex << std::setfill( '0' ) << std::setw( 16 ) << ( ( i + 1 ) * 0x1111111111111111 )
+           << std::endl;
+    }
+    
+    return ss.str();
+}
+
+std::string CannedStack( size_t entries )
+{
+    std::stringstream ss;
+    
+    ss << "SS:EBP   Ret SS:EBP Ret CS:EIP    Arg0     Arg1     Arg2     Arg3     CS:EIP / Symbol [line]" << std::endl;
+    
+    for( size_t i = 0; i < entries; i++ )
+    {
+        ss << std::hex << std::setfill( '0' )
+           << "0010:" << std::setw( 8 ) << ( 0xFFE0 - i * 0x10 ) << " "
+           << "0010:" << std::setw( 8 ) << ( 0xFFF0 - i * 0x10 ) << " "
+           << "0008:" << std::setw( 8 ) << ( 0x7C2E + i ) << " "
+           << std::setw( 8 ) << i << " "
+           << std::setw( 8 ) << i + 1 << " "
+           << std::setw( 8 ) << i + 2 << " "
+           << std::setw( 8 ) << i + 3 << " "
+           << "0008:" << std::setw( 8 ) << ( 0x7C10 + i )
+           << std::endl;
+    }
+    
+    return ss.str();
+}
+
+std::string CannedRunningVMs( size_t vms )
+{
+    std::stringstream ss;
+    
+    for( size_t i = 0; i < vms; i++ )
+    {
+        ss << "\"VM-" << i << "\" {6b7a2c9e-0f4d-4e1b-9a3c-" << std::setfill( '0' ) << std::setw( 12 ) << i << "}" << std::endl;
+    }
+    
+    return ss.str();
+}
+
+/*
+ * Looks like "ps -axww -o pid=,command=" output, with the host process
+ * of the last canned running VM near the end.
+ */
+std::string CannedProcesses( size_t processes )
+{
+    std::stringstream ss;
+    
+    for( size_t i = 0; i < processes; i++ )
+    {
+        ss << std::setfill( ' ' ) << std::setw( 5 ) << 1000 + i << " /usr/libexec/daemon-" << i << " --config /etc/daemon-" << i << ".conf" << std::endl;
+        
+        if( i == processes - 8 )
+        {
+            ss << std::setw( 5 ) << 900 << " /Applications/VirtualBox.app/Contents/MacOS/VBoxHeadless --comment VM-7 --startvm 6b7a2c9e-0f4d-4e1b-9a3c-000000000007 --vrde config" << std::endl;
+        }
+    }
+    
+    return ss.str();
+}
+
+std::string ExecutablePath( const char * argv0 )
+{
+    char      * p( realpath( argv0, nullptr ) );
+    std::string path( ( p != nullptr ) ? p : argv0 );
+    
+    free( p );
+    
+    return path;
+}
+
+/*
+ * Answers "debugvm VM_NAME dumpvmcore --filename=PATH" like VBoxManage,
+ * writing a synthetic core of VM_NAME MiB to PATH sequentially, as a pipe
+ * cannot seek. Every other command fails, as if the VM was not running.
+ * Commands for the "slow" VM hang for a minute first.
+ */
+int FakeVBoxManage( int argc, const char * argv[] )
+{
+    std::string filename;
+    
+    if( argc > 2 && std::string( argv[ 2 ] ) == "slow" )
+    {
+        std::this_thread::sleep_for( std::chrono::minutes( 1 ) );
+    }
+    
+    for( int i = 2; i < argc; i++ )
+    {
+        std::string arg( argv[ i ] );
+        
+        if( arg.find( "--filename=" ) == 0 )
+        {
+            filename = arg.substr( 11 );
+        }
+    }
+    
+    if( argc < 4 || std::string( argv[ 3 ] ) != "dumpvmcore" || filename.length() == 0 )
+    {
+        std::cerr << CannedError( "is not currently running" );
+        
+        return EXIT_FAILURE;
+    }
+    
+    try
+    {
+        WriteCoreFile( filename, std::max< uint64_t >( std::strtoull( argv[ 2 ], nullptr, 10 ), 1 ) * 1024 * 1024, false );
+    }
+    catch( const std::exception & e )
+    {
+        std::cerr << e.what() << std::endl;
+        
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Looks like what VBoxManage prints on standard error when a debugvm
+ * command fails.
+ */
+std::string CannedError( const std::string & message )
+{
+    return "VBoxManage: error: Machine 'VM' " + message + "\n"
+           "VBoxManage: error: Details: code VBOX_E_INVALID_VM_STATE (0x80bb0002), component MachineWrap, interface IMachine, callee nsISupports\n"
+           "VBoxManage: error: Context: \"LockMachine(a->session, LockType_Shared)\" at line 1175 of file VBoxManageDebugVM.cpp\n";
+}
+
+/*
+ * Looks like the debugger console's "dq" output, where each qword holds
+ * its own address.
+ */
+std::string CannedConsoleMemory( uint64_t address, uint64_t size )
+{
+    std::stringstream ss;
+    
+    ss << std::hex << std::setfill( '0' );
+    
+    for( uint64_t line = address; line < address + size; line += 16 )
+    {
+        ss << "%%" << std::setw( 16 ) << line << ": " << std::setw( 16 ) << line << "-" << std::setw( 16 ) << line + 8 << std::endl;
+    }
+    
+    return ss.str();
+}
+
+/*
+ * Serves "dq %%ADDRESS L COUNT" like the VirtualBox debugger console, on
+ * a local port, from background threads. Other commands get an error.
+ * Returns the port.
+ */
+uint16_t FakeDebugConsole( void )
+{
+    int                fd( socket( AF_INET, SOCK_STREAM, 0 ) );
+    struct sockaddr_in addr;
+    socklen_t          length( sizeof( addr ) );
+    
+    memset( &addr, 0, sizeof( addr ) );
+    
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    addr.sin_port        = 0;
+    
+    if( fd == -1 || bind( fd, reinterpret_cast< struct sockaddr * >( &addr ), sizeof( addr ) ) != 0 || listen( fd, 4 ) != 0 || getsockname( fd, reinterpret_cast< struct sockaddr * >( &addr ), &length ) != 0 )
+    {
+        throw std::runtime_error( "Cannot start the fake debugger console" );
+    }
+    
+    std::thread
+    (
+        [ fd ]( void )
+        {
+            while( 1 )
+            {
+                int client( accept( fd, nullptr, nullptr ) );
+                
+                if( client == -1 )
+                {
+                    continue;
+                }
+                
+                std::thread
+                (
+                    [ client ]( void )
+                    {
+                        std::string input;
+                        std::string prompt( VBox::DebugConsole::prompt() );
+                        std::string output( "Welcome to the VirtualBox Debugger!\n" + prompt );
+                        char        buf[ 4096 ];
+                        ssize_t     n;
+                        
+                        while( send( client, output.data(), output.size(), 0 ) == static_cast< ssize_t >( output.size() ) && ( n = recv( client, buf, sizeof( buf ), 0 ) ) > 0 )
+                        {
+                            size_t eol;
+                            
+                            input.append( buf, static_cast< size_t >( n ) );
+                            output.clear();
+                            
+                            while( ( eol = input.find( '\n' ) ) != std::string::npos )
+                            {
+                                std::string command( input.substr( 0, eol ) );
+                                uint64_t    address( 0 );
+                                uint64_t    count( 0 );
+                                
+                                input.erase( 0, eol + 1 );
+                                
+                                if( sscanf( command.c_str(), "dq %%%%%" SCNx64 " L %" SCNu64, &address, &count ) == 2 )
+                                {
+                                    output += CannedConsoleMemory( address & ~static_cast< uint64_t >( 15 ), count * 8 ) + prompt;
+                                }
+                                else
+                                {
+                                    output += "error: Unknown command '" + command + "'\n" + prompt;
+                                }
+                            }
+                        }
+                        
+                        close( client );
+                    }
+                ).detach();
+            }
+        }
+    ).detach();
+    
+    return ntohs( addr.sin_port );
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/Allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace VBox
+{
+    static std::atomic< uint64_t > allocationCount( 0 );
+    static std::atomic< uint64_t > allocationBytes( 0 );
+    static std::atomic< uint64_t > deallocationCount( 0 );
+    
+    uint64_t Allocations::count( void )
+    {
+        return allocationCount.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Allocations::bytes( void )
+    {
+        return allocationBytes.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Allocations::live( void )
+    {
+        return allocationCount.load( std::memory_order_relaxed ) - deallocationCount.load( std::memory_order_relaxed );
+    }
+}
+
+/*
+ * The array and nothrow forms end up here in both libc++ and libstdc++.
+ * Over-aligned allocations use their own operator new and are not
+ * counted.
+ */
+void * operator new( size_t size )
+{
+    void * p( malloc( ( size > 0 ) ? size : 1 ) );
+    
+    if( p == nullptr )
+    {
+        throw std::bad_alloc();
+    }
+    
+    VBox::allocationCount.fetch_add( 1, std::memory_order_relaxed );
+    VBox::allocationBytes.fetch_add( size, std::memory_order_relaxed );
+    
+    return p;
+}
+
+void operator delete( void * p ) noexcept
+{
+    if( p == nullptr )
+    {
+        return;
+    }
+    
+    VBox::deallocationCount.fetch_add( 1, std::memory_order_relaxed );
+    
+    free( p );
+}
+
+void operator delete( void * p, size_t size ) noexcept
+{
+    ( void )size;
+    
+    operator delete( p );
+}
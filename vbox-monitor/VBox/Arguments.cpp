@@ -24,7 +24,9 @@
 
 #include "VBox/Arguments.hpp"
 #include "VBox/Casts.hpp"
+#include "VBox/Monitor.hpp"
 #include <vector>
+#include <cstdlib>
 
 namespace VBox
 {
@@ -39,6 +41,16 @@ namespace VBox
             bool                       _showHelp;
             std::string                _vmName;
             std::string                _vmPath;
+            size_t                     _maximumFPS;
+            std::string                _statsPath;
+            bool                       _dedup;
+            bool                       _compress;
+            std::string                _vboxManage;
+            uint64_t                   _synthetic;
+            bool                       _attach;
+            uint16_t                   _console;
+            std::chrono::milliseconds  _samplingFloor;
+            std::chrono::milliseconds  _samplingCeiling;
     };
     
     Arguments::Arguments( int argc, const char * argv[] ):
@@ -78,6 +90,56 @@ namespace VBox
         return this->impl->_vmPath;
     }
     
+    size_t Arguments::maximumFPS( void ) const
+    {
+        return this->impl->_maximumFPS;
+    }
+    
+    std::string Arguments::statsPath( void ) const
+    {
+        return this->impl->_statsPath;
+    }
+    
+    bool Arguments::dedup( void ) const
+    {
+        return this->impl->_dedup;
+    }
+    
+    bool Arguments::compress( void ) const
+    {
+        return this->impl->_compress;
+    }
+    
+    std::string Arguments::vboxManage( void ) const
+    {
+        return this->impl->_vboxManage;
+    }
+    
+    uint64_t Arguments::synthetic( void ) const
+    {
+        return this->impl->_synthetic;
+    }
+    
+    bool Arguments::attach( void ) const
+    {
+        return this->impl->_attach;
+    }
+    
+    uint16_t Arguments::console( void ) const
+    {
+        return this->impl->_console;
+    }
+    
+    std::chrono::milliseconds Arguments::samplingFloor( void ) const
+    {
+        return this->impl->_samplingFloor;
+    }
+    
+    std::chrono::milliseconds Arguments::samplingCeiling( void ) const
+    {
+        return this->impl->_samplingCeiling;
+    }
+    
     void swap( Arguments & o1, Arguments & o2 )
     {
         using std::swap;
@@ -86,7 +148,15 @@ namespace VBox
     }
     
     Arguments::IMPL::IMPL( int argc, const char * argv[] ):
-        _showHelp( false )
+        _showHelp(        false ),
+        _maximumFPS(      30 ),
+        _dedup(           false ),
+        _compress(        false ),
+        _synthetic(       0 ),
+        _attach(          false ),
+        _console(         0 ),
+        _samplingFloor(   Monitor::samplingFloor ),
+        _samplingCeiling( Monitor::samplingCeiling )
     {
         if( argc < 1 )
         {
@@ -100,12 +170,55 @@ namespace VBox
             this->_args.push_back( argv[ i ] );
         }
         
-        for( const auto & arg: this->_args )
+        for( size_t i = 0; i < this->_args.size(); i++ )
         {
+            std::string arg( this->_args[ i ] );
+            
             if( arg == "--help" || arg == "-h" )
             {
                 this->_showHelp = true;
             }
+            else if( arg == "--fps" && i + 1 < this->_args.size() )
+            {
+                this->_maximumFPS = std::max< size_t >( std::strtoul( this->_args[ ++i ].c_str(), nullptr, 10 ), 1 );
+            }
+            else if( arg == "--stats" && i + 1 < this->_args.size() )
+            {
+                this->_statsPath = this->_args[ ++i ];
+            }
+            else if( arg == "--vboxmanage" && i + 1 < this->_args.size() )
+            {
+                this->_vboxManage = this->_args[ ++i ];
+            }
+            else if( arg == "--synthetic" && i + 1 < this->_args.size() )
+            {
+                this->_synthetic = std::max< uint64_t >( std::strtoull( this->_args[ ++i ].c_str(), nullptr, 10 ), 1 );
+            }
+            else if( arg == "--console" && i + 1 < this->_args.size() )
+            {
+                this->_console = numeric_cast< uint16_t >( std::min< unsigned long >( std::strtoul( this->_args[ ++i ].c_str(), nullptr, 10 ), 65535 ) );
+            }
+            else if( arg == "--sampling-floor" && i + 1 < this->_args.size() )
+            {
+                this->_samplingFloor = std::chrono::milliseconds( std::strtoul( this->_args[ ++i ].c_str(), nullptr, 10 ) );
+            }
+            else if( arg == "--sampling-ceiling" && i + 1 < this->_args.size() )
+            {
+                this->_samplingCeiling = std::chrono::milliseconds( std::strtoul( this->_args[ ++i ].c_str(), nullptr, 10 ) );
+            }
+            else if( arg == "--attach" )
+            {
+                this->_attach = true;
+            }
+            else if( arg == "--dedup" )
+            {
+                this->_dedup = true;
+            }
+            else if( arg == "--compress" )
+            {
+                this->_dedup    = true;
+                this->_compress = true;
+            }
             else if( this->_vmName.length() == 0 )
             {
                 this->_vmName = arg;
@@ -118,9 +231,19 @@ namespace VBox
     }
     
     Arguments::IMPL::IMPL( const IMPL & o ):
-        _args(     o._args ),
-        _showHelp( o._showHelp ),
-        _vmName(   o._vmName ),
-        _vmPath(   o._vmPath )
+        _args(            o._args ),
+        _showHelp(        o._showHelp ),
+        _vmName(          o._vmName ),
+        _vmPath(          o._vmPath ),
+        _maximumFPS(      o._maximumFPS ),
+        _statsPath(       o._statsPath ),
+        _dedup(           o._dedup ),
+        _compress(        o._compress ),
+        _vboxManage(      o._vboxManage ),
+        _synthetic(       o._synthetic ),
+        _attach(          o._attach ),
+        _console(         o._console ),
+        _samplingFloor(   o._samplingFloor ),
+        _samplingCeiling( o._samplingCeiling )
     {}
 }
@@ -28,6 +28,8 @@
 #include <memory>
 #include <algorithm>
 #include <string>
+#include <cstdint>
+#include <chrono>
 
 namespace VBox
 {
@@ -42,9 +44,20 @@ namespace VBox
             
             Arguments & operator =( Arguments o );
             
-            bool        showHelp( void ) const;
-            std::string vmName( void )   const;
-            std::string vmPath( void )   const;
+            bool        showHelp( void )   const;
+            std::string vmName( void )     const;
+            std::string vmPath( void )     const;
+            size_t      maximumFPS( void ) const;
+            std::string statsPath( void )  const;
+            bool        dedup( void )      const;
+            bool        compress( void )   const;
+            std::string vboxManage( void ) const;
+            uint64_t    synthetic( void )  const;
+            bool        attach( void )     const;
+            uint16_t    console( void )    const;
+            
+            std::chrono::milliseconds samplingFloor( void )   const;
+            std::chrono::milliseconds samplingCeiling( void ) const;
             
             friend void swap( Arguments & o1, Arguments & o2 );
             
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_BACKEND_HPP
+#define VBOX_BACKEND_HPP
+
+#include "VBox/VM/Registers.hpp"
+#include "VBox/VM/StackEntry.hpp"
+#include "VBox/VM/Info.hpp"
+#include "VBox/VM/DumpTarget.hpp"
+#include "VBox/VM/PartialCore.hpp"
+#include "VBox/ELF/File.hpp"
+#include "VBox/StopToken.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace VBox
+{
+    /*
+     * Where virtual machines are controlled and sampled from. Manage and
+     * Monitor go through a backend, so the VBoxManage command line can be
+     * replaced, for instance by an in-process synthetic guest.
+     * Implementations must be safe to call from several threads. Samples
+     * are written into existing objects, and stack() leaves an empty
+     * vector on failure. hostProcess() finds the process running a VM,
+     * when there is one, so its exit can be watched instead of polled.
+     * read() fills a partial core with the given ranges of guest memory,
+     * for backends that can read them without dumping it all, and
+     * memorySize() is the guest's RAM size, or zero if it is not known.
+     * Sampling requests report why they failed, as an Error, so callers
+     * can tell a VM that is gone from one that is only busy.
+     * Requests made while monitoring take a stop token, and return as
+     * soon as it is stopped, abandoning whatever they were waiting for.
+     */
+    class Backend
+    {
+        public:
+            
+            /*
+             * Busy means the VM exists but cannot be sampled right now,
+             * for instance while it is saving its state or changing state.
+             * Unsupported means the backend cannot serve the request at all.
+             * Cancelled means the request's stop token was stopped, and
+             * Timeout that the request did not complete in time.
+             */
+            enum class Error
+            {
+                None,
+                Spawn,
+                NotRunning,
+                Busy,
+                Failed,
+                Output,
+                Unsupported,
+                Cancelled,
+                Timeout
+            };
+            
+            virtual ~Backend( void ) = default;
+            
+            virtual bool registerVM( const std::string & path )     = 0;
+            virtual bool unregisterVM( const std::string & vmName ) = 0;
+            virtual bool startVM( const std::string & vmName )      = 0;
+            virtual bool powerOffVM( const std::string & vmName )   = 0;
+            
+            virtual std::vector< VM::Info > runningVMs( const StopToken & token )                              = 0;
+            virtual std::optional< pid_t >  hostProcess( const std::string & vmName, const StopToken & token ) = 0;
+            
+            virtual Error registers( const std::string & vmName, VM::Registers & registers, const StopToken & token )                                                        = 0;
+            virtual Error stack( const std::string & vmName, std::vector< VM::StackEntry > & stack, const StopToken & token )                                                = 0;
+            virtual Error capture( const std::string & vmName, VM::DumpTarget & target, std::optional< ELF::File > & elf, const StopToken & token )                          = 0;
+            virtual Error read( const std::string & vmName, const std::vector< std::pair< uint64_t, uint64_t > > & ranges, VM::PartialCore & core, const StopToken & token ) = 0;
+            
+            virtual uint64_t memorySize( const std::string & vmName, const StopToken & token ) = 0;
+    };
+}
+
+#endif /* VBOX_BACKEND_HPP */
@@ -0,0 +1,195 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/Backoff.hpp"
+#include <deque>
+#include <random>
+
+namespace VBox
+{
+    class Backoff::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            IMPL( const IMPL & o );
+            
+            void _prune( void );
+            
+            uint64_t                                            _failures;
+            uint64_t                                            _consecutive;
+            Backend::Error                                      _error;
+            std::chrono::microseconds                           _delay;
+            std::deque< std::chrono::steady_clock::time_point > _recent;
+            std::minstd_rand                                    _random;
+    };
+    
+    Backoff::Backoff( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    Backoff::Backoff( const Backoff & o ):
+        impl( std::make_unique< IMPL >( *( o.impl ) ) )
+    {}
+    
+    Backoff::Backoff( Backoff && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    Backoff::~Backoff( void )
+    {}
+    
+    Backoff & Backoff::operator =( Backoff o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    uint64_t Backoff::failures( void ) const
+    {
+        return this->impl->_failures;
+    }
+    
+    uint64_t Backoff::consecutive( void ) const
+    {
+        return this->impl->_consecutive;
+    }
+    
+    /*
+     * Failures per second, over the last window.
+     */
+    double Backoff::rate( void ) const
+    {
+        std::chrono::steady_clock::time_point since( std::chrono::steady_clock::now() - window );
+        size_t                                count( 0 );
+        
+        for( const auto & time: this->impl->_recent )
+        {
+            if( time >= since )
+            {
+                count++;
+            }
+        }
+        
+        return static_cast< double >( count ) / std::chrono::duration< double >( window ).count();
+    }
+    
+    /*
+     * The error of the last attempt, which is Error::None once one has
+     * succeeded.
+     */
+    Backend::Error Backoff::error( void ) const
+    {
+        return this->impl->_error;
+    }
+    
+    bool Backoff::open( void ) const
+    {
+        return this->impl->_consecutive >= threshold;
+    }
+    
+    /*
+     * How long to wait before the next attempt. Zero while the channel
+     * is not failing.
+     */
+    std::chrono::microseconds Backoff::delay( void ) const
+    {
+        return this->impl->_delay;
+    }
+    
+    void Backoff::record( Backend::Error error )
+    {
+        this->impl->_error = error;
+        
+        if( error == Backend::Error::None )
+        {
+            this->impl->_consecutive = 0;
+            this->impl->_delay       = std::chrono::microseconds( 0 );
+            
+            return;
+        }
+        
+        this->impl->_failures++;
+        this->impl->_consecutive++;
+        this->impl->_recent.push_back( std::chrono::steady_clock::now() );
+        this->impl->_prune();
+        
+        if( this->open() )
+        {
+            this->impl->_delay = probe;
+        }
+        else
+        {
+            std::chrono::microseconds                delay( std::min< std::chrono::microseconds >( base * ( int64_t( 1 ) << std::min< uint64_t >( this->impl->_consecutive - 1, 16 ) ), limit ) );
+            std::uniform_int_distribution< int64_t > jitter( 0, delay.count() / 2 );
+            
+            this->impl->_delay = delay - std::chrono::microseconds( jitter( this->impl->_random ) );
+        }
+    }
+    
+    /*
+     * Closes the breaker, so the next attempt is made right away. Counts
+     * are kept.
+     */
+    void Backoff::close( void )
+    {
+        this->impl->_consecutive = 0;
+        this->impl->_delay       = std::chrono::microseconds( 0 );
+    }
+    
+    void swap( Backoff & o1, Backoff & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    Backoff::IMPL::IMPL( void ):
+        _failures(    0 ),
+        _consecutive( 0 ),
+        _error(       Backend::Error::None ),
+        _delay(       0 ),
+        _random(      std::random_device()() )
+    {}
+    
+    Backoff::IMPL::IMPL( const IMPL & o ):
+        _failures(    o._failures ),
+        _consecutive( o._consecutive ),
+        _error(       o._error ),
+        _delay(       o._delay ),
+        _recent(      o._recent ),
+        _random(      o._random )
+    {}
+    
+    void Backoff::IMPL::_prune( void )
+    {
+        std::chrono::steady_clock::time_point since( std::chrono::steady_clock::now() - window );
+        
+        while( this->_recent.size() > 0 && this->_recent.front() < since )
+        {
+            this->_recent.pop_front();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_BACKOFF_HPP
+#define VBOX_BACKOFF_HPP
+
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include "VBox/Backend.hpp"
+
+namespace VBox
+{
+    /*
+     * Failure state of a sampling channel. Each consecutive failure
+     * doubles the delay before the next attempt, from base up to limit,
+     * with up to half of it random, so channels failing together do not
+     * retry in lockstep. After threshold consecutive failures, the
+     * breaker opens, and the channel only probes every probe interval
+     * until close() is called or an attempt succeeds.
+     * Failures are also counted, in total and over the last window.
+     */
+    class Backoff
+    {
+        public:
+            
+            static constexpr std::chrono::milliseconds base      = std::chrono::milliseconds( 50 );
+            static constexpr std::chrono::milliseconds limit     = std::chrono::milliseconds( 5000 );
+            static constexpr std::chrono::milliseconds probe     = std::chrono::milliseconds( 30000 );
+            static constexpr std::chrono::milliseconds window    = std::chrono::milliseconds( 10000 );
+            static constexpr uint64_t                  threshold = 8;
+            
+            Backoff( void );
+            Backoff( const Backoff & o );
+            Backoff( Backoff && o ) noexcept;
+            ~Backoff( void );
+            
+            Backoff & operator =( Backoff o );
+            
+            uint64_t                  failures( void )    const;
+            uint64_t                  consecutive( void ) const;
+            double                    rate( void )        const;
+            Backend::Error            error( void )       const;
+            bool                      open( void )        const;
+            std::chrono::microseconds delay( void )       const;
+            
+            void record( Backend::Error error );
+            void close( void );
+            
+            friend void swap( Backoff & o1, Backoff & o2 );
+            
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_BACKOFF_HPP */
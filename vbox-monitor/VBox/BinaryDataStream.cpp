@@ -25,6 +25,7 @@
 #include <fstream>
 #include <cmath>
 #include <vector>
+#include <cstring>
 #include "VBox/BinaryDataStream.hpp"
 #include "VBox/Casts.hpp"
 
@@ -34,7 +34,7 @@
 
 namespace VBox
 {
-    class BinaryDataStream: public BinaryStream
+    class BinaryDataStream final: public BinaryStream
     {
         public:
             
@@ -22,9 +22,13 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
-#include <fstream>
 #include <cmath>
+#include <cerrno>
+#include <cstring>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "VBox/BinaryFileStream.hpp"
 #include "VBox/Casts.hpp"
 
@@ -34,17 +38,27 @@ namespace VBox
     {
         public:
             
-            IMPL( const std::string & path );
+            IMPL( const std::string & path, size_t blockSize, Advice advice );
             ~IMPL( void );
             
-            std::ifstream _stream;
-            std::string   _path;
-            size_t        _size;
-            size_t        _pos;
+            static constexpr size_t pageSize = 4096;
+            
+            void _fill( size_t offset, size_t size );
+            void _pread( uint8_t * buf, size_t size, size_t offset ) const;
+            
+            int                          _fd;
+            std::string                  _path;
+            size_t                       _size;
+            size_t                       _pos;
+            size_t                       _blockSize;
+            Advice                       _advice;
+            std::unique_ptr< uint8_t[] > _buffer;
+            size_t                       _bufferOffset;
+            size_t                       _bufferLength;
     };
     
-    BinaryFileStream::BinaryFileStream( std::string path ):
-        impl( std::make_unique< IMPL >( path ) )
+    BinaryFileStream::BinaryFileStream( const std::string & path, size_t blockSize, Advice advice ):
+        impl( std::make_unique< IMPL >( path, blockSize, advice ) )
     {}
     
     BinaryFileStream::~BinaryFileStream( void )
@@ -52,7 +66,7 @@ namespace VBox
     
     void BinaryFileStream::Read( uint8_t * buf, size_t size )
     {
-        if( this->impl->_stream.is_open() == false )
+        if( this->impl->_fd == -1 )
         {
             throw std::runtime_error( "Invalid file stream" );
         }
@@ -62,9 +76,26 @@ namespace VBox
             throw std::runtime_error( "Invalid read - Not enough data available" );
         }
         
-        this->impl->_pos += size;
+        if
+        (
+               this->impl->_pos        >= this->impl->_bufferOffset
+            && this->impl->_pos + size <= this->impl->_bufferOffset + this->impl->_bufferLength
+        )
+        {
+            memcpy( buf, this->impl->_buffer.get() + ( this->impl->_pos - this->impl->_bufferOffset ), size );
+        }
+        else if( size >= this->impl->_blockSize )
+        {
+            this->impl->_pread( buf, size, this->impl->_pos );
+        }
+        else
+        {
+            this->impl->_fill( this->impl->_pos, size );
+            
+            memcpy( buf, this->impl->_buffer.get(), size );
+        }
         
-        this->impl->_stream.read( reinterpret_cast< char * >( buf ), numeric_cast< std::streamsize >( size ) );
+        this->impl->_pos += size;
     }
     
     void BinaryFileStream::Seek( ssize_t offset, SeekDirection dir )
@@ -104,13 +135,11 @@ namespace VBox
         }
         
         this->impl->_pos = pos;
-        
-        this->impl->_stream.seekg( numeric_cast< std::streamsize >( pos ), std::ios_base::beg );
     }
     
     size_t BinaryFileStream::Tell( void ) const
     {
-        if( this->impl->_stream.is_open() == false )
+        if( this->impl->_fd == -1 )
         {
             throw std::runtime_error( "Invalid file stream" );
         }
@@ -118,31 +147,136 @@ namespace VBox
         return this->impl->_pos;
     }
     
-    BinaryFileStream::IMPL::IMPL( const std::string & path ):
-        _path( path ),
-        _size( 0 ),
-        _pos( 0 )
+    size_t BinaryFileStream::blockSize( void ) const
+    {
+        return this->impl->_blockSize;
+    }
+    
+    void BinaryFileStream::ReadAt( uint8_t * buf, size_t size, size_t offset ) const
+    {
+        if( this->impl->_fd == -1 )
+        {
+            throw std::runtime_error( "Invalid file stream" );
+        }
+        
+        if( offset > this->impl->_size || size > this->impl->_size - offset )
+        {
+            throw std::runtime_error( "Invalid read - Not enough data available" );
+        }
+        
+        this->impl->_pread( buf, size, offset );
+    }
+    
+    BinaryFileStream::IMPL::IMPL( const std::string & path, size_t blockSize, Advice advice ):
+        _fd(           -1 ),
+        _path(         path ),
+        _size(         0 ),
+        _pos(          0 ),
+        _blockSize(    std::max< size_t >( blockSize, 1 ) ),
+        _advice(       advice ),
+        _bufferOffset( 0 ),
+        _bufferLength( 0 )
     {
-        this->_stream.open( this->_path, std::ios::binary | std::ios::in );
+        struct stat st;
+        
+        this->_fd = open( this->_path.c_str(), O_RDONLY | O_CLOEXEC );
         
-        if( this->_stream.good() )
+        if( this->_fd == -1 )
         {
-            std::streamsize pos;
-            
-            this->_stream.seekg( 0, std::ios_base::end );
+            return;
+        }
+        
+        if( fstat( this->_fd, &st ) != 0 )
+        {
+            close( this->_fd );
             
-            pos         = this->_stream.tellg();
-            this->_size = numeric_cast< size_t >( pos );
+            this->_fd = -1;
             
-            this->_stream.seekg( 0, std::ios_base::beg );
+            return;
+        }
+        
+        this->_size = numeric_cast< size_t >( st.st_size );
+        
+        #if defined( POSIX_FADV_SEQUENTIAL )
+        
+        if( this->_advice == Advice::Sequential )
+        {
+            posix_fadvise( this->_fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+        }
+        else if( this->_advice == Advice::Random )
+        {
+            posix_fadvise( this->_fd, 0, 0, POSIX_FADV_RANDOM );
         }
+        
+        #elif defined( F_RDAHEAD )
+        
+        fcntl( this->_fd, F_RDAHEAD, ( this->_advice == Advice::Random ) ? 0 : 1 );
+        
+        #endif
     }
     
     BinaryFileStream::IMPL::~IMPL( void )
     {
-        if( this->_stream.is_open() )
+        if( this->_fd != -1 )
+        {
+            close( this->_fd );
+        }
+    }
+    
+    /*
+     * Reads ahead from offset into the buffer. Like the kernel's readahead,
+     * the window starts at one page and only grows to a full block once the
+     * access pattern is sequential, so that header parsing and random reads
+     * don't pay for a large block each time. The window never holds less
+     * than the size requested, which is smaller than a block.
+     */
+    void BinaryFileStream::IMPL::_fill( size_t offset, size_t size )
+    {
+        bool   sequential( this->_advice == Advice::Sequential || ( this->_bufferLength > 0 && offset >= this->_bufferOffset && offset <= this->_bufferOffset + this->_bufferLength ) );
+        size_t window( ( sequential ) ? this->_blockSize : std::min( this->_blockSize, pageSize ) );
+        size_t length( std::min( std::max( size, window ), this->_size - offset ) );
+        
+        if( this->_buffer == nullptr )
+        {
+            this->_buffer = std::unique_ptr< uint8_t[] >( new uint8_t[ this->_blockSize ] );
+        }
+        
+        this->_bufferOffset = offset;
+        this->_bufferLength = 0;
+        
+        this->_pread( this->_buffer.get(), length, offset );
+        
+        this->_bufferLength = length;
+        
+        #if defined( POSIX_FADV_WILLNEED )
+        
+        if( this->_advice == Advice::Sequential && offset + length < this->_size )
+        {
+            posix_fadvise( this->_fd, numeric_cast< off_t >( offset + length ), numeric_cast< off_t >( this->_blockSize ), POSIX_FADV_WILLNEED );
+        }
+        
+        #endif
+    }
+    
+    void BinaryFileStream::IMPL::_pread( uint8_t * buf, size_t size, size_t offset ) const
+    {
+        while( size > 0 )
         {
-            this->_stream.close();
+            ssize_t n( pread( this->_fd, buf, size, numeric_cast< off_t >( offset ) ) );
+            
+            if( n < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            
+            if( n <= 0 )
+            {
+                throw std::runtime_error( "Invalid read - Cannot read from file: " + this->_path );
+            }
+            
+            buf    += n;
+            size   -= static_cast< size_t >( n );
+            offset += static_cast< size_t >( n );
         }
     }
 }
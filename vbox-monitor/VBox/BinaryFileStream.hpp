@@ -34,11 +34,20 @@
 
 namespace VBox
 {
-    class BinaryFileStream: public BinaryStream
+    class BinaryFileStream final: public BinaryStream
     {
         public:
             
-            BinaryFileStream( std::string path );
+            enum class Advice
+            {
+                Normal,
+                Sequential,
+                Random
+            };
+            
+            static constexpr size_t defaultBlockSize = 256 * 1024;
+            
+            BinaryFileStream( const std::string & path, size_t blockSize = defaultBlockSize, Advice advice = Advice::Normal );
             
             virtual ~BinaryFileStream( void );
             
@@ -53,6 +62,10 @@ namespace VBox
             void   Seek( ssize_t offset, SeekDirection dir ) override;
             size_t Tell( void )                        const override;
             
+            size_t blockSize( void ) const;
+            
+            void ReadAt( uint8_t * buf, size_t size, size_t offset ) const;
+            
         private:
             
             class IMPL;
@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_BINARY_READER_HPP
+#define VBOX_BINARY_READER_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace VBox
+{
+    enum class Endianness
+    {
+        Little,
+        Big,
+        Native
+    };
+    
+    namespace Endian
+    {
+        constexpr bool hostIsLittle( void )
+        {
+            return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+        }
+        
+        template< typename _T_ >
+        inline _T_ Swap( _T_ v, typename std::enable_if< std::is_integral< _T_ >::value >::type * = 0 )
+        {
+            using _U_ = typename std::make_unsigned< _T_ >::type;
+            
+            _U_ u( static_cast< _U_ >( v ) );
+            
+            if constexpr( sizeof( _T_ ) == 2 )
+            {
+                u = __builtin_bswap16( u );
+            }
+            else if constexpr( sizeof( _T_ ) == 4 )
+            {
+                u = __builtin_bswap32( u );
+            }
+            else if constexpr( sizeof( _T_ ) == 8 )
+            {
+                u = __builtin_bswap64( u );
+            }
+            
+            return static_cast< _T_ >( u );
+        }
+        
+        /*
+         * Unaligned load of an integer with the given byte order.
+         * memcpy compiles to a single move, and the swap to a single bswap
+         * (or nothing when the byte order matches the host).
+         */
+        template< typename _T_, Endianness _E_ >
+        inline _T_ Load( const uint8_t * p, typename std::enable_if< std::is_integral< _T_ >::value >::type * = 0 )
+        {
+            _T_ v;
+            
+            memcpy( &v, p, sizeof( _T_ ) );
+            
+            if constexpr( _E_ == Endianness::Little && hostIsLittle() == false )
+            {
+                v = Swap( v );
+            }
+            else if constexpr( _E_ == Endianness::Big && hostIsLittle() )
+            {
+                v = Swap( v );
+            }
+            
+            return v;
+        }
+    }
+    
+    /*
+     * A fixed-size record read from a stream in a single call.
+     * Fields are decoded at compile-time offsets, so the bounds check is done
+     * once for the whole record instead of once per field.
+     */
+    template< size_t _N_, Endianness _E_ >
+    class BinaryRecord
+    {
+        public:
+            
+            static constexpr size_t size = _N_;
+            
+            template< typename _T_, size_t _O_ >
+            _T_ Get( void ) const
+            {
+                static_assert( _O_ + sizeof( _T_ ) <= _N_, "Field is out of the record bounds" );
+                
+                return Endian::Load< _T_, _E_ >( this->_bytes.data() + _O_ );
+            }
+            
+            template< size_t _O_, size_t _L_ >
+            void Copy( uint8_t * buf ) const
+            {
+                static_assert( _O_ + _L_ <= _N_, "Field is out of the record bounds" );
+                
+                memcpy( buf, this->_bytes.data() + _O_, _L_ );
+            }
+            
+            uint8_t * data( void )
+            {
+                return this->_bytes.data();
+            }
+            
+            const uint8_t * data( void ) const
+            {
+                return this->_bytes.data();
+            }
+            
+        private:
+            
+            std::array< uint8_t, _N_ > _bytes;
+    };
+    
+    /*
+     * Non-owning view over contiguous bytes, usable as a BinaryReader backend.
+     * Everything is inline, so reads from memory compile down to a bounds
+     * check and a load.
+     */
+    class BinarySpan
+    {
+        public:
+            
+            BinarySpan( const uint8_t * data, size_t size ):
+                _data( data ),
+                _size( size ),
+                _pos(  0 )
+            {}
+            
+            const uint8_t * data( void ) const
+            {
+                return this->_data;
+            }
+            
+            size_t size( void ) const
+            {
+                return this->_size;
+            }
+            
+            size_t Tell( void ) const
+            {
+                return this->_pos;
+            }
+            
+            size_t AvailableBytes( void ) const
+            {
+                return this->_size - this->_pos;
+            }
+            
+            void Seek( size_t pos )
+            {
+                if( pos > this->_size )
+                {
+                    throw std::runtime_error( "Invalid seek offset" );
+                }
+                
+                this->_pos = pos;
+            }
+            
+            void Read( uint8_t * buf, size_t size )
+            {
+                if( size > this->_size - this->_pos )
+                {
+                    throw std::runtime_error( "Invalid read - Not enough data available" );
+                }
+                
+                memcpy( buf, this->_data + this->_pos, size );
+                
+                this->_pos += size;
+            }
+            
+        private:
+            
+            const uint8_t * _data;
+            size_t          _size;
+            size_t          _pos;
+    };
+    
+    /*
+     * Fixed-width readers over any backend providing
+     * Read( uint8_t * buf, size_t size ).
+     * With a final stream class as backend, calls are resolved statically.
+     */
+    template< typename _B_ >
+    class BinaryReader
+    {
+        public:
+            
+            explicit BinaryReader( _B_ & backend ):
+                _backend( backend )
+            {}
+            
+            template< typename _T_, Endianness _E_ >
+            _T_ Read( void )
+            {
+                uint8_t buf[ sizeof( _T_ ) ];
+                
+                this->_backend.Read( buf, sizeof( _T_ ) );
+                
+                return Endian::Load< _T_, _E_ >( buf );
+            }
+            
+            template< size_t _N_, Endianness _E_ >
+            BinaryRecord< _N_, _E_ > ReadRecord( void )
+            {
+                BinaryRecord< _N_, _E_ > record;
+                
+                this->_backend.Read( record.data(), _N_ );
+                
+                return record;
+            }
+            
+        private:
+            
+            _B_ & _backend;
+    };
+}
+
+#endif /* VBOX_BINARY_READER_HPP */
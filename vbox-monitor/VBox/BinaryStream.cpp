@@ -25,6 +25,7 @@
 #include <fstream>
 #include <cmath>
 #include "VBox/BinaryStream.hpp"
+#include "VBox/BinaryReader.hpp"
 #include "VBox/Casts.hpp"
 
 namespace VBox
@@ -69,280 +70,72 @@ namespace VBox
     
     uint8_t BinaryStream::ReadUInt8( void )
     {
-        uint8_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 1 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint8_t, Endianness::Native >();
     }
     
     int8_t BinaryStream::ReadInt8( void )
     {
-        int8_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 1 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< int8_t, Endianness::Native >();
     }
     
     uint16_t BinaryStream::ReadUInt16( void )
     {
-        uint16_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 2 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint16_t, Endianness::Native >();
     }
     
     int16_t BinaryStream::ReadInt16( void )
     {
-        int16_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 2 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< int16_t, Endianness::Native >();
     }
     
     uint16_t BinaryStream::ReadBigEndianUInt16( void )
     {
-        uint8_t  c[ 2 ];
-        uint16_t n;
-        uint16_t n1;
-        uint16_t n2;
-        
-        c[ 0 ] = 0;
-        c[ 1 ] = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( c ), 2 );
-        
-        n1 = numeric_cast< uint16_t >( c[ 0 ] );
-        n2 = numeric_cast< uint16_t >( c[ 1 ] );
-        
-        n  = numeric_cast< uint16_t >( n1 << 8 )
-           | n2;
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint16_t, Endianness::Big >();
     }
     
     uint16_t BinaryStream::ReadLittleEndianUInt16( void )
     {
-        uint8_t  c[ 2 ];
-        uint16_t n;
-        uint16_t n1;
-        uint16_t n2;
-        
-        c[ 0 ] = 0;
-        c[ 1 ] = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( c ), 2 );
-        
-        n1 = numeric_cast< uint16_t >( c[ 1 ] );
-        n2 = numeric_cast< uint16_t >( c[ 0 ] );
-        
-        n  = numeric_cast< uint16_t >( n1 << 8 )
-           | n2;
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint16_t, Endianness::Little >();
     }
     
     uint32_t BinaryStream::ReadUInt32( void )
     {
-        uint32_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 4 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint32_t, Endianness::Native >();
     }
     
     int32_t BinaryStream::ReadInt32( void )
     {
-        int32_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 4 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< int32_t, Endianness::Native >();
     }
     
     uint32_t BinaryStream::ReadBigEndianUInt32( void )
     {
-        uint8_t  c[ 4 ];
-        uint32_t n;
-        uint32_t n1;
-        uint32_t n2;
-        uint32_t n3;
-        uint32_t n4;
-        
-        c[ 0 ] = 0;
-        c[ 1 ] = 0;
-        c[ 2 ] = 0;
-        c[ 3 ] = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( c ), 4 );
-        
-        n1 = numeric_cast< uint32_t >( c[ 0 ] );
-        n2 = numeric_cast< uint32_t >( c[ 1 ] );
-        n3 = numeric_cast< uint32_t >( c[ 2 ] );
-        n4 = numeric_cast< uint32_t >( c[ 3 ] );
-        
-        n  = numeric_cast< uint32_t >( n1 << 24 )
-           | numeric_cast< uint32_t >( n2 << 16 )
-           | numeric_cast< uint32_t >( n3 << 8 )
-           | n4;
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint32_t, Endianness::Big >();
     }
     
     uint32_t BinaryStream::ReadLittleEndianUInt32( void )
     {
-        uint8_t  c[ 4 ];
-        uint32_t n;
-        uint32_t n1;
-        uint32_t n2;
-        uint32_t n3;
-        uint32_t n4;
-        
-        c[ 0 ] = 0;
-        c[ 1 ] = 0;
-        c[ 2 ] = 0;
-        c[ 3 ] = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( c ), 4 );
-        
-        n1 = numeric_cast< uint32_t >( c[ 3 ] );
-        n2 = numeric_cast< uint32_t >( c[ 2 ] );
-        n3 = numeric_cast< uint32_t >( c[ 1 ] );
-        n4 = numeric_cast< uint32_t >( c[ 0 ] );
-        
-        n  = numeric_cast< uint32_t >( n1 << 24 )
-           | numeric_cast< uint32_t >( n2 << 16 )
-           | numeric_cast< uint32_t >( n3 << 8 )
-           | n4;
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint32_t, Endianness::Little >();
     }
     
     uint64_t BinaryStream::ReadUInt64( void )
     {
-        uint64_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 8 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint64_t, Endianness::Native >();
     }
     
     int64_t BinaryStream::ReadInt64( void )
     {
-        int64_t n;
-        
-        n = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( &n ), 8 );
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< int64_t, Endianness::Native >();
     }
     
     uint64_t BinaryStream::ReadBigEndianUInt64( void )
     {
-        uint8_t  c[ 8 ];
-        uint64_t n;
-        uint64_t n1;
-        uint64_t n2;
-        uint64_t n3;
-        uint64_t n4;
-        uint64_t n5;
-        uint64_t n6;
-        uint64_t n7;
-        uint64_t n8;
-        
-        c[ 0 ] = 0;
-        c[ 1 ] = 0;
-        c[ 2 ] = 0;
-        c[ 3 ] = 0;
-        c[ 4 ] = 0;
-        c[ 5 ] = 0;
-        c[ 6 ] = 0;
-        c[ 7 ] = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( c ), 8 );
-        
-        n1 = numeric_cast< uint64_t >( c[ 0 ] );
-        n2 = numeric_cast< uint64_t >( c[ 1 ] );
-        n3 = numeric_cast< uint64_t >( c[ 2 ] );
-        n4 = numeric_cast< uint64_t >( c[ 3 ] );
-        n5 = numeric_cast< uint64_t >( c[ 4 ] );
-        n6 = numeric_cast< uint64_t >( c[ 5 ] );
-        n7 = numeric_cast< uint64_t >( c[ 6 ] );
-        n8 = numeric_cast< uint64_t >( c[ 7 ] );
-        
-        n  = numeric_cast< uint64_t >( n1 << 56 )
-           | numeric_cast< uint64_t >( n2 << 48 )
-           | numeric_cast< uint64_t >( n3 << 40 )
-           | numeric_cast< uint64_t >( n4 << 32 )
-           | numeric_cast< uint64_t >( n5 << 24 )
-           | numeric_cast< uint64_t >( n6 << 16 )
-           | numeric_cast< uint64_t >( n7 << 8 )
-           | n8;
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint64_t, Endianness::Big >();
     }
     
     uint64_t BinaryStream::ReadLittleEndianUInt64( void )
     {
-        uint8_t  c[ 8 ];
-        uint64_t n;
-        uint64_t n1;
-        uint64_t n2;
-        uint64_t n3;
-        uint64_t n4;
-        uint64_t n5;
-        uint64_t n6;
-        uint64_t n7;
-        uint64_t n8;
-        
-        c[ 0 ] = 0;
-        c[ 1 ] = 0;
-        c[ 2 ] = 0;
-        c[ 3 ] = 0;
-        c[ 4 ] = 0;
-        c[ 5 ] = 0;
-        c[ 6 ] = 0;
-        c[ 7 ] = 0;
-        
-        this->Read( reinterpret_cast< uint8_t * >( c ), 8 );
-        
-        n1 = numeric_cast< uint64_t >( c[ 7 ] );
-        n2 = numeric_cast< uint64_t >( c[ 6 ] );
-        n3 = numeric_cast< uint64_t >( c[ 5 ] );
-        n4 = numeric_cast< uint64_t >( c[ 4 ] );
-        n5 = numeric_cast< uint64_t >( c[ 3 ] );
-        n6 = numeric_cast< uint64_t >( c[ 2 ] );
-        n7 = numeric_cast< uint64_t >( c[ 1 ] );
-        n8 = numeric_cast< uint64_t >( c[ 0 ] );
-        
-        n  = numeric_cast< uint64_t >( n1 << 56 )
-           | numeric_cast< uint64_t >( n2 << 48 )
-           | numeric_cast< uint64_t >( n3 << 40 )
-           | numeric_cast< uint64_t >( n4 << 32 )
-           | numeric_cast< uint64_t >( n5 << 24 )
-           | numeric_cast< uint64_t >( n6 << 16 )
-           | numeric_cast< uint64_t >( n7 << 8 )
-           | n8;
-        
-        return n;
+        return BinaryReader< BinaryStream >( *( this ) ).Read< uint64_t, Endianness::Little >();
     }
     
     float BinaryStream::ReadBigEndianFixedPoint( unsigned int integerLength, unsigned int fractionalLength )
@@ -0,0 +1,444 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/CLIBackend.hpp"
+#include "VBox/Manage.hpp"
+#include "VBox/Process.hpp"
+#include "VBox/Stats.hpp"
+#include <optional>
+
+namespace VBox
+{
+    CLIBackend::CLIBackend( uint16_t consolePort ):
+        _consolePort( consolePort )
+    {}
+    
+    CLIBackend::~CLIBackend( void )
+    {}
+    
+    uint16_t CLIBackend::consolePort( void ) const
+    {
+        return this->_consolePort;
+    }
+    
+    bool CLIBackend::registerVM( const std::string & path )
+    {
+        Process proc( Manage::executable() );
+        
+        proc.arguments
+        (
+            {
+                "registervm", path
+            }
+        );
+        
+        return _control( proc );
+    }
+    
+    bool CLIBackend::unregisterVM( const std::string & vmName )
+    {
+        Process proc( Manage::executable() );
+        
+        proc.arguments
+        (
+            {
+                "unregistervm", vmName
+            }
+        );
+        
+        return _control( proc );
+    }
+    
+    /*
+     * The debugger console is configured through extra data, which is
+     * only read when the VM starts.
+     */
+    bool CLIBackend::startVM( const std::string & vmName )
+    {
+        Process proc( Manage::executable() );
+        
+        if( this->_consolePort != 0 )
+        {
+            std::vector< std::pair< std::string, std::string > > data
+            (
+                {
+                    { "VBoxInternal/DBGC/Enabled", "1" },
+                    { "VBoxInternal/DBGC/Port",    std::to_string( this->_consolePort ) }
+                }
+            );
+            
+            for( const auto & p: data )
+            {
+                Process set( Manage::executable(), { "setextradata", vmName, p.first, p.second } );
+                
+                if( _control( set ) == false )
+                {
+                    return false;
+                }
+            }
+        }
+        
+        proc.arguments
+        (
+            {
+                "startvm", "--type=separate", vmName
+            }
+        );
+        
+        return _control( proc );
+    }
+    
+    bool CLIBackend::powerOffVM( const std::string & vmName )
+    {
+        Process proc( Manage::executable() );
+        
+        proc.arguments
+        (
+            {
+                "controlvm", vmName, "poweroff"
+            }
+        );
+        
+        return _control( proc );
+    }
+    
+    std::vector< VM::Info > CLIBackend::runningVMs( const StopToken & token )
+    {
+        Process                      proc( Manage::executable() );
+        std::optional< std::string > out;
+        
+        proc.arguments
+        (
+            {
+                "list", "runningvms"
+            }
+        );
+        
+        {
+            Stats::Scope scope( Stats::Channel::Live, Stats::Stage::Spawn );
+            
+            proc.start();
+        }
+        
+        if( _wait( proc, Stats::Channel::Live, token ) == false )
+        {
+            return {};
+        }
+        
+        {
+            Stats::Scope scope( Stats::Channel::Live, Stats::Stage::Read );
+            
+            out = proc.output();
+        }
+        
+        if( out.has_value() == false )
+        {
+            return {};
+        }
+        
+        {
+            Stats::Scope scope( Stats::Channel::Live, Stats::Stage::Parse );
+            
+            return Manage::Parse::runningVMs( out.value() );
+        }
+    }
+    
+    /*
+     * VBoxManage cannot tell which process runs a VM, so it is looked up
+     * in the process list, by the name or UUID the VM was started with.
+     */
+    std::optional< pid_t > CLIBackend::hostProcess( const std::string & vmName, const StopToken & token )
+    {
+        std::string uid;
+        
+        for( const auto & info: this->runningVMs( token ) )
+        {
+            if( info.name() == vmName )
+            {
+                uid = info.uid();
+            }
+        }
+        
+        if( uid.length() == 0 )
+        {
+            return {};
+        }
+        
+        {
+            Process                      proc( "/bin/ps", { "-axww", "-o", "pid=,command=" } );
+            std::optional< std::string > out;
+            
+            proc.start();
+            
+            if( _wait( proc, Stats::Channel::Live, token ) == false )
+            {
+                return {};
+            }
+            
+            out = proc.output();
+            
+            if( proc.terminationStatus().value_or( -1 ) != 0 || out.has_value() == false )
+            {
+                return {};
+            }
+            
+            return Manage::Parse::hostProcess( out.value(), vmName, uid );
+        }
+    }
+    
+    Backend::Error CLIBackend::registers( const std::string & vmName, VM::Registers & registers, const StopToken & token )
+    {
+        Process proc( Manage::executable() );
+        Error   error;
+        
+        proc.arguments
+        (
+            {
+                "debugvm", vmName, "getregisters",
+                "rax", "rbx", "rcx", "rdx", "rdi", "rsi",
+                "r8",  "r9",  "r10", "r11", "r12", "r13",
+                "r14", "r15", "rbp", "rsp", "rip", "eflags"
+            }
+        );
+        
+        if( ( error = _run( proc, Stats::Channel::Registers, token ) ) != Error::None )
+        {
+            return error;
+        }
+        
+        {
+            Stats::Scope scope( Stats::Channel::Registers, Stats::Stage::Parse );
+            
+            return ( Manage::Parse::registers( proc.output().value_or( "" ), registers ) ) ? Error::None : Error::Output;
+        }
+    }
+    
+    Backend::Error CLIBackend::stack( const std::string & vmName, std::vector< VM::StackEntry > & stack, const StopToken & token )
+    {
+        Process proc( Manage::executable() );
+        Error   error;
+        
+        proc.arguments
+        (
+            {
+                "debugvm", vmName, "stack",
+            }
+        );
+        
+        if( ( error = _run( proc, Stats::Channel::Stack, token ) ) != Error::None )
+        {
+            stack.clear();
+            
+            return error;
+        }
+        
+        {
+            Stats::Scope scope( Stats::Channel::Stack, Stats::Stage::Parse );
+            
+            Manage::Parse::stack( proc.output().value_or( "" ), stack );
+            
+            return Error::None;
+        }
+    }
+    
+    Backend::Error CLIBackend::capture( const std::string & vmName, VM::DumpTarget & target, std::optional< ELF::File > & elf, const StopToken & token )
+    {
+        Process proc( Manage::executable() );
+        Error   error;
+        
+        elf.reset();
+        
+        proc.arguments
+        (
+            {
+                "debugvm", vmName, "dumpvmcore",
+                "--filename=" + target.path(),
+            }
+        );
+        
+        if( ( error = _run( proc, Stats::Channel::Memory, token ) ) != Error::None )
+        {
+            return error;
+        }
+        
+        try
+        {
+            Stats::Scope scope( Stats::Channel::Memory, Stats::Stage::Read );
+            
+            elf = target.receive();
+            
+            return Error::None;
+        }
+        catch( ... )
+        {
+            return Error::Output;
+        }
+    }
+    
+    /*
+     * The console session is kept open between reads, and reopened on
+     * the next read once it fails. Stopping the token interrupts the
+     * session, which is then reopened too.
+     */
+    Backend::Error CLIBackend::read( const std::string & vmName, const std::vector< std::pair< uint64_t, uint64_t > > & ranges, VM::PartialCore & core, const StopToken & token )
+    {
+        std::lock_guard< std::mutex > l( this->_consoleMtx );
+        
+        ( void )vmName;
+        
+        if( this->_consolePort == 0 )
+        {
+            return Error::Unsupported;
+        }
+        
+        try
+        {
+            DebugConsole * console;
+            uint64_t       callback;
+            bool           ok;
+            
+            if( this->_console == nullptr )
+            {
+                this->_console = std::make_unique< DebugConsole >( "127.0.0.1", this->_consolePort );
+            }
+            
+            console  = this->_console.get();
+            callback = token.onStop( [ console ] { console->interrupt(); } );
+            
+            try
+            {
+                ok = this->_console->read( ranges, core );
+            }
+            catch( ... )
+            {
+                token.remove( callback );
+                
+                throw;
+            }
+            
+            token.remove( callback );
+            
+            return ( ok ) ? Error::None : Error::Output;
+        }
+        catch( ... )
+        {
+            this->_console = nullptr;
+            
+            return ( token.stopRequested() ) ? Error::Cancelled : Error::Failed;
+        }
+    }
+    
+    uint64_t CLIBackend::memorySize( const std::string & vmName, const StopToken & token )
+    {
+        Process proc( Manage::executable(), { "showvminfo", vmName, "--machinereadable" } );
+        
+        proc.start();
+        
+        if( _wait( proc, Stats::Channel::Memory, token ) == false || proc.terminationStatus().value_or( -1 ) != 0 || proc.output().has_value() == false )
+        {
+            return 0;
+        }
+        
+        return Manage::Parse::memorySize( proc.output().value() ).value_or( 0 );
+    }
+    
+    /*
+     * Runs a sampling request, timing it on the channel. A non-zero exit
+     * status is classified from what VBoxManage printed. Nothing is run
+     * once the token is stopped.
+     */
+    Backend::Error CLIBackend::_run( Process & proc, Stats::Channel channel, const StopToken & token )
+    {
+        if( token.stopRequested() )
+        {
+            return Error::Cancelled;
+        }
+        
+        try
+        {
+            Stats::Scope scope( channel, Stats::Stage::Spawn );
+            
+            proc.start();
+        }
+        catch( ... )
+        {
+            return Error::Spawn;
+        }
+        
+        if( _wait( proc, channel, token ) == false )
+        {
+            return ( token.stopRequested() ) ? Error::Cancelled : Error::Timeout;
+        }
+        
+        if( proc.terminationStatus().value_or( -1 ) != 0 )
+        {
+            return Manage::Parse::error( proc.error().value_or( "" ) );
+        }
+        
+        {
+            Stats::Scope scope( channel, Stats::Stage::Read );
+            
+            return ( proc.output().has_value() ) ? Error::None : Error::Output;
+        }
+    }
+    
+    /*
+     * Waits until the channel's timeout from Manage, and records the CPU
+     * time VBoxManage used. Returns false if the process was killed, as
+     * it did not exit in time, or as the token was stopped.
+     */
+    bool CLIBackend::_wait( Process & proc, Stats::Channel channel, const StopToken & token )
+    {
+        bool exited;
+        
+        {
+            Stats::Scope scope( channel, Stats::Stage::Wait );
+            
+            exited = proc.waitFor( std::chrono::steady_clock::now() + Manage::timeout( channel ), token );
+        }
+        
+        if( proc.cpuTime().has_value() )
+        {
+            Stats::shared().record( channel, Stats::Stage::CPU, proc.cpuTime().value() );
+        }
+        
+        return exited;
+    }
+    
+    /*
+     * Runs a command that controls VMs, until the control timeout from
+     * Manage. A command that had to be killed has failed.
+     */
+    bool CLIBackend::_control( Process & proc )
+    {
+        proc.start();
+        
+        if( proc.waitFor( std::chrono::steady_clock::now() + Manage::controlTimeout() ) == false )
+        {
+            return false;
+        }
+        
+        return proc.terminationStatus().value_or( -1 ) == 0;
+    }
+}
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_CLI_BACKEND_HPP
+#define VBOX_CLI_BACKEND_HPP
+
+#include "VBox/Backend.hpp"
+#include "VBox/DebugConsole.hpp"
+#include "VBox/Process.hpp"
+#include "VBox/Stats.hpp"
+#include <memory>
+#include <mutex>
+
+namespace VBox
+{
+    /*
+     * Runs the VBoxManage executable set with Manage::executable() for
+     * every request, and parses its output with Manage::Parse.
+     * With a console port, VMs are started with the debugger console
+     * enabled on it, and memory is read through it, on this host. The
+     * console is for a single VM at a time.
+     * Requests made while monitoring are killed once they run longer
+     * than the timeout set with Manage::timeout() for their channel, and
+     * commands that control VMs after Manage::controlTimeout().
+     */
+    class CLIBackend: public Backend
+    {
+        public:
+            
+            CLIBackend( uint16_t consolePort = 0 );
+            ~CLIBackend( void ) override;
+            
+            CLIBackend( const CLIBackend & o )              = delete;
+            CLIBackend( CLIBackend && o )                   = delete;
+            CLIBackend & operator =( const CLIBackend & o ) = delete;
+            CLIBackend & operator =( CLIBackend && o )      = delete;
+            
+            uint16_t consolePort( void ) const;
+            
+            bool registerVM( const std::string & path )     override;
+            bool unregisterVM( const std::string & vmName ) override;
+            bool startVM( const std::string & vmName )      override;
+            bool powerOffVM( const std::string & vmName )   override;
+            
+            std::vector< VM::Info > runningVMs( const StopToken & token )                              override;
+            std::optional< pid_t >  hostProcess( const std::string & vmName, const StopToken & token ) override;
+            
+            Error registers( const std::string & vmName, VM::Registers & registers, const StopToken & token )                                                        override;
+            Error stack( const std::string & vmName, std::vector< VM::StackEntry > & stack, const StopToken & token )                                                override;
+            Error capture( const std::string & vmName, VM::DumpTarget & target, std::optional< ELF::File > & elf, const StopToken & token )                          override;
+            Error read( const std::string & vmName, const std::vector< std::pair< uint64_t, uint64_t > > & ranges, VM::PartialCore & core, const StopToken & token ) override;
+            
+            uint64_t memorySize( const std::string & vmName, const StopToken & token ) override;
+            
+        private:
+            
+            static Error _run( Process & proc, Stats::Channel channel, const StopToken & token );
+            static bool  _wait( Process & proc, Stats::Channel channel, const StopToken & token );
+            static bool  _control( Process & proc );
+            
+            uint16_t                        _consolePort;
+            std::mutex                      _consoleMtx;
+            std::unique_ptr< DebugConsole > _console;
+    };
+}
+
+#endif /* VBOX_CLI_BACKEND_HPP */
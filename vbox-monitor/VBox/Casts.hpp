@@ -26,6 +26,8 @@
 #define VBOX_FUNCTIONS_HPP
 
 #include <type_traits>
+#include <limits>
+#include <stdexcept>
 
 namespace VBox
 {
@@ -95,7 +97,7 @@ namespace VBox
     >
     _T_ numeric_cast( _U_ v )
     {
-        if( std::numeric_limits< _T_ >::max() < std::numeric_limits< _U_ >::max() && v > std::numeric_limits< _T_ >::max() )
+        if( v > static_cast< typename std::make_unsigned< _T_ >::type >( std::numeric_limits< _T_ >::max() ) )
         {
             throw std::runtime_error( "Bad numeric cast" );
         }
@@ -123,7 +125,7 @@ namespace VBox
             throw std::runtime_error( "Bad numeric cast" );
         }
         
-        if( std::numeric_limits< _T_ >::max() < std::numeric_limits< _U_ >::max() && v > std::numeric_limits< _T_ >::max() )
+        if( static_cast< typename std::make_unsigned< _U_ >::type >( v ) > std::numeric_limits< _T_ >::max() )
         {
             throw std::runtime_error( "Bad numeric cast" );
         }
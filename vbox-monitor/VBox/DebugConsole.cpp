@@ -0,0 +1,397 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/DebugConsole.hpp"
+#include "VBox/Manage.hpp"
+#include "VBox/Stats.hpp"
+#include "VBox/Casts.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+namespace VBox
+{
+    class DebugConsole::IMPL
+    {
+        public:
+            
+            IMPL( const std::string & host, uint16_t port );
+            ~IMPL( void );
+            
+            void        _send( const std::string & data );
+            std::string _receive( void );
+            
+            std::string _host;
+            uint16_t    _port;
+            int         _socket;
+            std::string _buffer;
+    };
+    
+    std::string DebugConsole::prompt( void )
+    {
+        return "VBoxDbg> ";
+    }
+    
+    /*
+     * Ranges are widened to whole pages, sorted and merged, then split
+     * into chunks for the display commands.
+     */
+    std::vector< std::pair< uint64_t, uint64_t > > DebugConsole::coalesce( const std::vector< std::pair< uint64_t, uint64_t > > & ranges )
+    {
+        std::vector< std::pair< uint64_t, uint64_t > > pages;
+        std::vector< std::pair< uint64_t, uint64_t > > chunks;
+        
+        for( const auto & range: ranges )
+        {
+            uint64_t start( range.first & ~( pageSize - 1 ) );
+            uint64_t end( range.first + range.second );
+            
+            if( range.second == 0 || end < range.first )
+            {
+                continue;
+            }
+            
+            end = ( end > UINT64_MAX - ( pageSize - 1 ) ) ? ( UINT64_MAX & ~( pageSize - 1 ) ) : ( ( end + pageSize - 1 ) & ~( pageSize - 1 ) );
+            
+            pages.push_back( { start, end - start } );
+        }
+        
+        std::sort( pages.begin(), pages.end() );
+        
+        for( const auto & range: pages )
+        {
+            if( chunks.size() > 0 && range.first <= chunks.back().first + chunks.back().second )
+            {
+                chunks.back().second = std::max( chunks.back().second, range.first + range.second - chunks.back().first );
+            }
+            else
+            {
+                chunks.push_back( range );
+            }
+        }
+        
+        {
+            std::vector< std::pair< uint64_t, uint64_t > > split;
+            
+            for( const auto & range: chunks )
+            {
+                for( uint64_t offset = 0; offset < range.second; offset += chunkSize )
+                {
+                    split.push_back( { range.first + offset, std::min( chunkSize, range.second - offset ) } );
+                }
+            }
+            
+            return split;
+        }
+    }
+    
+    DebugConsole::DebugConsole( const std::string & host, uint16_t port ):
+        impl( std::make_unique< IMPL >( host, port ) )
+    {}
+    
+    DebugConsole::~DebugConsole( void )
+    {}
+    
+    std::string DebugConsole::host( void ) const
+    {
+        return this->impl->_host;
+    }
+    
+    uint16_t DebugConsole::port( void ) const
+    {
+        return this->impl->_port;
+    }
+    
+    std::string DebugConsole::execute( const std::string & command )
+    {
+        this->impl->_send( command + "\n" );
+        
+        return this->impl->_receive();
+    }
+    
+    /*
+     * Can be called from another thread while a command runs. The
+     * session is unusable afterwards, and the command throws.
+     */
+    void DebugConsole::interrupt( void )
+    {
+        shutdown( this->impl->_socket, SHUT_RDWR );
+    }
+    
+    /*
+     * Chunks that are next to each other share a segment of the core. A
+     * read only succeeds if every byte of every chunk was displayed.
+     */
+    bool DebugConsole::read( const std::vector< std::pair< uint64_t, uint64_t > > & ranges, VM::PartialCore & core )
+    {
+        std::vector< std::pair< uint64_t, uint64_t > > chunks( coalesce( ranges ) );
+        std::vector< std::string >                     outputs;
+        
+        core.reset();
+        
+        if( chunks.size() == 0 )
+        {
+            return true;
+        }
+        
+        {
+            Stats::Scope      scope( Stats::Channel::Memory, Stats::Stage::Read );
+            std::stringstream commands;
+            
+            for( const auto & chunk: chunks )
+            {
+                commands << "dq %%" << std::hex << chunk.first << " L " << std::dec << chunk.second / 8 << "\n";
+            }
+            
+            this->impl->_send( commands.str() );
+            
+            outputs.reserve( chunks.size() );
+            
+            for( size_t i = 0; i < chunks.size(); i++ )
+            {
+                outputs.push_back( this->impl->_receive() );
+            }
+        }
+        
+        {
+            Stats::Scope                                   scope( Stats::Channel::Memory, Stats::Stage::Parse );
+            std::vector< std::pair< uint64_t, uint64_t > > segments;
+            
+            for( const auto & chunk: chunks )
+            {
+                if( segments.size() > 0 && segments.back().first + segments.back().second == chunk.first )
+                {
+                    segments.back().second += chunk.second;
+                }
+                else
+                {
+                    segments.push_back( chunk );
+                }
+            }
+            
+            for( const auto & segment: segments )
+            {
+                core.add( segment.first, segment.second );
+            }
+            
+            for( size_t i = 0, segment = 0; i < chunks.size(); i++ )
+            {
+                if( chunks[ i ].first >= segments[ segment ].first + segments[ segment ].second )
+                {
+                    segment++;
+                }
+                
+                {
+                    uint8_t * data( core.data( segment ) + ( chunks[ i ].first - segments[ segment ].first ) );
+                    
+                    if( Manage::Parse::memory( outputs[ i ], chunks[ i ].first, chunks[ i ].second, data ) != chunks[ i ].second )
+                    {
+                        core.reset();
+                        
+                        return false;
+                    }
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    DebugConsole::IMPL::IMPL( const std::string & host, uint16_t port ):
+        _host(   host ),
+        _port(   port ),
+        _socket( -1 )
+    {
+        struct addrinfo   hints;
+        struct addrinfo * info( nullptr );
+        
+        memset( &hints, 0, sizeof( hints ) );
+        
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        
+        if( getaddrinfo( host.c_str(), std::to_string( port ).c_str(), &hints, &info ) != 0 || info == nullptr )
+        {
+            throw std::runtime_error( "Cannot resolve debugger console host: " + host );
+        }
+        
+        for( struct addrinfo * i = info; i != nullptr; i = i->ai_next )
+        {
+            this->_socket = socket( i->ai_family, i->ai_socktype, i->ai_protocol );
+            
+            if( this->_socket == -1 )
+            {
+                continue;
+            }
+            
+            if( connect( this->_socket, i->ai_addr, i->ai_addrlen ) == 0 )
+            {
+                break;
+            }
+            
+            close( this->_socket );
+            
+            this->_socket = -1;
+        }
+        
+        freeaddrinfo( info );
+        
+        if( this->_socket == -1 )
+        {
+            throw std::runtime_error( "Cannot connect to debugger console: " + host + ":" + std::to_string( port ) );
+        }
+        
+        {
+            int yes( 1 );
+            
+            setsockopt( this->_socket, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof( yes ) );
+            
+            #ifdef SO_NOSIGPIPE
+            setsockopt( this->_socket, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof( yes ) );
+            #endif
+        }
+        
+        try
+        {
+            this->_receive();
+        }
+        catch( ... )
+        {
+            close( this->_socket );
+            
+            throw;
+        }
+    }
+    
+    DebugConsole::IMPL::~IMPL( void )
+    {
+        if( this->_socket != -1 )
+        {
+            close( this->_socket );
+        }
+    }
+    
+    void DebugConsole::IMPL::_send( const std::string & data )
+    {
+        size_t sent( 0 );
+        int    flags( 0 );
+        
+        #ifdef MSG_NOSIGNAL
+        flags = MSG_NOSIGNAL;
+        #endif
+        
+        while( sent < data.size() )
+        {
+            ssize_t n( send( this->_socket, data.data() + sent, data.size() - sent, flags ) );
+            
+            if( n < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            
+            if( n <= 0 )
+            {
+                throw std::runtime_error( "Debugger console connection lost" );
+            }
+            
+            sent += numeric_cast< size_t >( n );
+        }
+    }
+    
+    /*
+     * Returns the output up to the next prompt, at the start of a line.
+     * Output received past it belongs to the next command, and is kept
+     * for it.
+     */
+    std::string DebugConsole::IMPL::_receive( void )
+    {
+        std::string prompt( DebugConsole::prompt() );
+        size_t      searched( 0 );
+        
+        while( 1 )
+        {
+            size_t pos( this->_buffer.find( prompt, searched ) );
+            
+            while( pos != std::string::npos && pos > 0 && this->_buffer[ pos - 1 ] != '\n' )
+            {
+                pos = this->_buffer.find( prompt, pos + 1 );
+            }
+            
+            if( pos != std::string::npos )
+            {
+                std::string output( this->_buffer.substr( 0, pos ) );
+                
+                this->_buffer.erase( 0, pos + prompt.size() );
+                
+                return output;
+            }
+            
+            searched = ( this->_buffer.size() < prompt.size() ) ? 0 : this->_buffer.size() - prompt.size() + 1;
+            
+            {
+                struct pollfd pfd;
+                char          buf[ 65536 ];
+                ssize_t       n;
+                
+                pfd.fd      = this->_socket;
+                pfd.events  = POLLIN;
+                pfd.revents = 0;
+                
+                n = poll( &pfd, 1, static_cast< int >( DebugConsole::timeout.count() ) );
+                
+                if( n < 0 && errno == EINTR )
+                {
+                    continue;
+                }
+                
+                if( n <= 0 )
+                {
+                    throw std::runtime_error( "Debugger console timed out" );
+                }
+                
+                n = recv( this->_socket, buf, sizeof( buf ), 0 );
+                
+                if( n < 0 && errno == EINTR )
+                {
+                    continue;
+                }
+                
+                if( n <= 0 )
+                {
+                    throw std::runtime_error( "Debugger console connection lost" );
+                }
+                
+                this->_buffer.append( buf, numeric_cast< size_t >( n ) );
+            }
+        }
+    }
+}
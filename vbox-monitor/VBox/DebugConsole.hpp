@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_DEBUG_CONSOLE_HPP
+#define VBOX_DEBUG_CONSOLE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "VBox/VM/PartialCore.hpp"
+
+namespace VBox
+{
+    /*
+     * A session with the VirtualBox debugger console, which a VM started
+     * with the VBoxInternal/DBGC/Enabled extra data serves over TCP.
+     * Guest memory is read with "dq" on physical addresses, so only the
+     * requested ranges are transferred. Ranges are coalesced into whole
+     * pages and split into commands of at most chunkSize bytes, and all
+     * the commands of a read are sent at once, before any output is read.
+     */
+    class DebugConsole
+    {
+        public:
+            
+            static constexpr uint16_t                  defaultPort = 5000;
+            static constexpr uint64_t                  pageSize    = 4096;
+            static constexpr uint64_t                  chunkSize   = 16384;
+            static constexpr std::chrono::milliseconds timeout     = std::chrono::milliseconds( 2000 );
+            
+            static std::string                                    prompt( void );
+            static std::vector< std::pair< uint64_t, uint64_t > > coalesce( const std::vector< std::pair< uint64_t, uint64_t > > & ranges );
+            
+            DebugConsole( const std::string & host, uint16_t port );
+            ~DebugConsole( void );
+            
+            DebugConsole( const DebugConsole & o )              = delete;
+            DebugConsole( DebugConsole && o )                   = delete;
+            DebugConsole & operator =( const DebugConsole & o ) = delete;
+            DebugConsole & operator =( DebugConsole && o )      = delete;
+            
+            std::string host( void ) const;
+            uint16_t    port( void ) const;
+            
+            std::string execute( const std::string & command );
+            bool        read( const std::vector< std::pair< uint64_t, uint64_t > > & ranges, VM::PartialCore & core );
+            void        interrupt( void );
+            
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_DEBUG_CONSOLE_HPP */
@@ -24,7 +24,10 @@
 
 #include "VBox/ELF/File.hpp"
 #include "VBox/Casts.hpp"
-#include "VBox/BinaryDataStream.hpp"
+#include "VBox/MappedFile.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <optional>
 
 namespace VBox
 {
@@ -36,10 +39,25 @@ namespace VBox
                 
                 IMPL( void );
                 IMPL( BinaryStream & stream );
+                IMPL( const std::string & path );
+                IMPL( std::shared_ptr< const MappedFile > file );
+                IMPL( std::shared_ptr< const void > owner, const uint8_t * data, uint64_t size );
                 IMPL( const IMPL & o );
                 
-                Header                            _header;
-                std::vector< ProgramHeaderEntry > _programHeader;
+                static bool _fits( uint64_t offset, uint64_t size, uint64_t total );
+                
+                void                                _validate( uint64_t size );
+                std::optional< SectionHeaderEntry > _stringTable( uint64_t size ) const;
+                
+                Header                        _header;
+                std::shared_ptr< const void > _owner;
+                const uint8_t               * _data;
+                uint64_t                      _size;
+                Table< ProgramHeaderEntry >   _programHeaders;
+                Table< SectionHeaderEntry >   _sectionHeaders;
+                std::shared_ptr< const void > _stringsOwner;
+                const char                  * _strings;
+                uint64_t                      _stringsSize;
         };
         
         File::File( void ):
@@ -50,6 +68,14 @@ namespace VBox
             impl( std::make_unique< IMPL >( stream ) )
         {}
         
+        File::File( const std::string & path ):
+            impl( std::make_unique< IMPL >( path ) )
+        {}
+        
+        File::File( std::shared_ptr< const void > owner, const uint8_t * data, uint64_t size ):
+            impl( std::make_unique< IMPL >( owner, data, size ) )
+        {}
+        
         File::File( const File & o ):
             impl( std::make_unique< IMPL >( *( o.impl ) ) )
         {}
@@ -75,7 +101,41 @@ namespace VBox
         
         std::vector< ProgramHeaderEntry > File::programHeader( void ) const
         {
-            return this->impl->_programHeader;
+            return { this->impl->_programHeaders.begin(), this->impl->_programHeaders.end() };
+        }
+        
+        Table< ProgramHeaderEntry > File::programHeaders( void ) const
+        {
+            return this->impl->_programHeaders;
+        }
+        
+        Table< SectionHeaderEntry > File::sectionHeaders( void ) const
+        {
+            return this->impl->_sectionHeaders;
+        }
+        
+        std::string File::sectionName( const SectionHeaderEntry & section ) const
+        {
+            if( this->impl->_strings == nullptr || section.name() >= this->impl->_stringsSize )
+            {
+                return "";
+            }
+            
+            {
+                const char * s( this->impl->_strings + section.name() );
+                
+                return std::string( s, strnlen( s, numeric_cast< size_t >( this->impl->_stringsSize - section.name() ) ) );
+            }
+        }
+        
+        const uint8_t * File::data( uint64_t offset, uint64_t size ) const
+        {
+            if( this->impl->_data == nullptr || IMPL::_fits( offset, size, this->impl->_size ) == false )
+            {
+                return nullptr;
+            }
+            
+            return this->impl->_data + offset;
         }
         
         void swap( File & o1, File & o2 )
@@ -91,12 +151,25 @@ namespace VBox
                << "    Header:"   << std::endl
                << o.impl->_header << std::endl;
             
-            if( o.impl->_programHeader.size() > 0 )
+            if( o.impl->_programHeaders.size() > 0 )
             {
                 os << "    Program header entries:" << std::endl
                    << "    {"                       << std::endl;
                 
-                for( const auto & entry: o.impl->_programHeader )
+                for( const auto & entry: o.impl->_programHeaders )
+                {
+                    os << entry << std::endl;
+                }
+                
+                os << "    }" << std::endl;
+            }
+            
+            if( o.impl->_sectionHeaders.size() > 0 )
+            {
+                os << "    Section header entries:" << std::endl
+                   << "    {"                       << std::endl;
+                
+                for( const auto & entry: o.impl->_sectionHeaders )
                 {
                     os << entry << std::endl;
                 }
@@ -109,31 +182,180 @@ namespace VBox
             return os;
         }
         
-        File::IMPL::IMPL( void )
+        File::IMPL::IMPL( void ):
+            _data(        nullptr ),
+            _size(        0 ),
+            _strings(     nullptr ),
+            _stringsSize( 0 )
         {}
         
+        /*
+         * Stream-backed files read each header table in a single call and
+         * keep it in memory. Contents can only be read through the stream.
+         */
         File::IMPL::IMPL( BinaryStream & stream ):
-            _header( stream )
+            IMPL()
         {
-            if
-            (
-                   this->_header.programHeaderOffset()     != 0
-                && this->_header.programHeaderEntrySize()  != 0
-                && this->_header.programHeaderEntryCount() != 0
-            )
+            uint64_t size;
+            
+            auto read = [ & ]( uint64_t offset, uint64_t length )
             {
-                stream.Seek( numeric_cast< ssize_t >( this->_header.programHeaderOffset() ), BinaryStream::SeekDirection::Begin );
+                std::shared_ptr< std::vector< uint8_t > > buf( std::make_shared< std::vector< uint8_t > >( numeric_cast< size_t >( length ) ) );
                 
-                for( size_t i = 0; i < this->_header.programHeaderEntryCount(); i++ )
+                if( length > 0 )
                 {
-                    this->_programHeader.push_back( ProgramHeaderEntry( stream ) );
+                    stream.Seek( numeric_cast< ssize_t >( offset ), BinaryStream::SeekDirection::Begin );
+                    stream.Read( buf->data(), buf->size() );
+                }
+                
+                return buf;
+            };
+            
+            stream.Seek( 0, BinaryStream::SeekDirection::End );
+            
+            size = stream.Tell();
+            
+            stream.Seek( 0, BinaryStream::SeekDirection::Begin );
+            
+            this->_header = Header( stream );
+            
+            this->_validate( size );
+            
+            {
+                auto ph( read( this->_header.programHeaderOffset(), uint64_t( this->_header.programHeaderEntryCount() ) * this->_header.programHeaderEntrySize() ) );
+                auto sh( read( this->_header.sectionHeaderOffset(), uint64_t( this->_header.sectionHeaderEntryCount() ) * this->_header.sectionHeaderEntrySize() ) );
+                
+                this->_programHeaders = Table< ProgramHeaderEntry >( ph, ph->data(), this->_header.programHeaderEntryCount(), this->_header.programHeaderEntrySize() );
+                this->_sectionHeaders = Table< SectionHeaderEntry >( sh, sh->data(), this->_header.sectionHeaderEntryCount(), this->_header.sectionHeaderEntrySize() );
+            }
+            
+            {
+                std::optional< SectionHeaderEntry > section( this->_stringTable( size ) );
+                
+                if( section.has_value() )
+                {
+                    auto strings( read( section->offset(), section->size() ) );
+                    
+                    this->_stringsOwner = strings;
+                    this->_strings      = reinterpret_cast< const char * >( strings->data() );
+                    this->_stringsSize  = section->size();
+                }
+            }
+        }
+        
+        /*
+         * Mapped files only decode the ELF header. Tables are views over the
+         * mapping, so opening a multi-GiB core costs the same as a tiny one.
+         */
+        File::IMPL::IMPL( const std::string & path ):
+            IMPL( std::make_shared< const MappedFile >( path ) )
+        {}
+        
+        File::IMPL::IMPL( std::shared_ptr< const MappedFile > file ):
+            IMPL( file, file->data(), file->size() )
+        {}
+        
+        /*
+         * In-memory images work the same way. The owner keeps the memory
+         * alive for as long as any table or view refers to it.
+         */
+        File::IMPL::IMPL( std::shared_ptr< const void > owner, const uint8_t * data, uint64_t size ):
+            IMPL()
+        {
+            if( data == nullptr || size < Header::recordSize )
+            {
+                throw std::runtime_error( "Invalid ELF file - Not enough data available" );
+            }
+            
+            this->_owner  = owner;
+            this->_data   = data;
+            this->_size   = size;
+            this->_header = Header( this->_data );
+            
+            this->_validate( this->_size );
+            
+            this->_programHeaders = Table< ProgramHeaderEntry >( owner, this->_data + this->_header.programHeaderOffset(), this->_header.programHeaderEntryCount(), this->_header.programHeaderEntrySize() );
+            this->_sectionHeaders = Table< SectionHeaderEntry >( owner, this->_data + this->_header.sectionHeaderOffset(), this->_header.sectionHeaderEntryCount(), this->_header.sectionHeaderEntrySize() );
+            
+            {
+                std::optional< SectionHeaderEntry > section( this->_stringTable( this->_size ) );
+                
+                if( section.has_value() )
+                {
+                    this->_stringsOwner = owner;
+                    this->_strings      = reinterpret_cast< const char * >( this->_data + section->offset() );
+                    this->_stringsSize  = section->size();
                 }
             }
         }
         
         File::IMPL::IMPL( const IMPL & o ):
-            _header(        o._header ),
-            _programHeader( o._programHeader )
+            _header(         o._header ),
+            _owner(          o._owner ),
+            _data(           o._data ),
+            _size(           o._size ),
+            _programHeaders( o._programHeaders ),
+            _sectionHeaders( o._sectionHeaders ),
+            _stringsOwner(   o._stringsOwner ),
+            _strings(        o._strings ),
+            _stringsSize(    o._stringsSize )
         {}
+        
+        bool File::IMPL::_fits( uint64_t offset, uint64_t size, uint64_t total )
+        {
+            return offset <= total && size <= total - offset;
+        }
+        
+        /*
+         * Bounds of both header tables are checked once here, so that table
+         * entries can later be decoded without any further check.
+         */
+        void File::IMPL::_validate( uint64_t size )
+        {
+            std::vector< uint8_t > ident( this->_header.ident() );
+            uint64_t               phCount(     this->_header.programHeaderEntryCount() );
+            uint64_t               phEntrySize( this->_header.programHeaderEntrySize() );
+            uint64_t               shCount(     this->_header.sectionHeaderEntryCount() );
+            uint64_t               shEntrySize( this->_header.sectionHeaderEntrySize() );
+            
+            if( ident.size() < 6 || ident[ 0 ] != 0x7F || ident[ 1 ] != 'E' || ident[ 2 ] != 'L' || ident[ 3 ] != 'F' )
+            {
+                throw std::runtime_error( "Invalid ELF file - Bad magic" );
+            }
+            
+            if( ident[ 4 ] != 2 || ident[ 5 ] != 1 )
+            {
+                throw std::runtime_error( "Invalid ELF file - Only little-endian ELF64 is supported" );
+            }
+            
+            if( phCount > 0 && ( phEntrySize < ProgramHeaderEntry::recordSize || _fits( this->_header.programHeaderOffset(), phCount * phEntrySize, size ) == false ) )
+            {
+                throw std::runtime_error( "Invalid ELF file - Program header is out of bounds" );
+            }
+            
+            if( shCount > 0 && ( shEntrySize < SectionHeaderEntry::recordSize || _fits( this->_header.sectionHeaderOffset(), shCount * shEntrySize, size ) == false ) )
+            {
+                throw std::runtime_error( "Invalid ELF file - Section header is out of bounds" );
+            }
+        }
+        
+        std::optional< SectionHeaderEntry > File::IMPL::_stringTable( uint64_t size ) const
+        {
+            if( this->_header.sectionNameStringTableIndex() >= this->_sectionHeaders.size() )
+            {
+                return {};
+            }
+            
+            {
+                SectionHeaderEntry section( this->_sectionHeaders[ this->_header.sectionNameStringTableIndex() ] );
+                
+                if( section.size() == 0 || _fits( section.offset(), section.size(), size ) == false )
+                {
+                    return {};
+                }
+                
+                return section;
+            }
+        }
     }
 }
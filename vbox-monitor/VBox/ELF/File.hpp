@@ -31,7 +31,10 @@
 #include <ostream>
 #include "VBox/ELF/Header.hpp"
 #include "VBox/ELF/ProgramHeaderEntry.hpp"
+#include "VBox/ELF/SectionHeaderEntry.hpp"
+#include "VBox/ELF/Table.hpp"
 #include "VBox/BinaryStream.hpp"
+#include <string>
 
 namespace VBox
 {
@@ -43,14 +46,21 @@ namespace VBox
                 
                 File( void );
                 File( BinaryStream & stream );
+                File( const std::string & path );
+                File( std::shared_ptr< const void > owner, const uint8_t * data, uint64_t size );
                 File( const File & o );
                 File( File && o );
                 ~File( void );
                 
                 File & operator =( File o );
                 
-                Header                            header( void )        const;
-                std::vector< ProgramHeaderEntry > programHeader( void ) const;
+                Header                            header( void )         const;
+                std::vector< ProgramHeaderEntry > programHeader( void )  const;
+                Table< ProgramHeaderEntry >       programHeaders( void ) const;
+                Table< SectionHeaderEntry >       sectionHeaders( void ) const;
+                
+                std::string     sectionName( const SectionHeaderEntry & section ) const;
+                const uint8_t * data( uint64_t offset, uint64_t size )            const;
                 
                 friend void swap( File & o1, File & o2 );
                 
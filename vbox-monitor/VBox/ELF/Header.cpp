@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "VBox/ELF/Header.hpp"
+#include "VBox/BinaryReader.hpp"
 #include "VBox/String.hpp"
 
 namespace VBox
@@ -35,6 +36,7 @@ namespace VBox
                 
                 IMPL( void );
                 IMPL( BinaryStream & stream );
+                IMPL( const uint8_t * data );
                 IMPL( const IMPL & o );
                 
                 std::vector< uint8_t > _ident;
@@ -61,6 +63,10 @@ namespace VBox
             impl( std::make_unique< IMPL >( stream ) )
         {}
         
+        Header::Header( const uint8_t * data ):
+            impl( std::make_unique< IMPL >( data ) )
+        {}
+        
         Header::Header( const Header & o ):
             impl( std::make_unique< IMPL >( *( o.impl ) ) )
         {}
@@ -194,24 +200,27 @@ namespace VBox
         {}
         
         Header::IMPL::IMPL( BinaryStream & stream ):
+            IMPL( BinaryReader< BinaryStream >( stream ).ReadRecord< recordSize, Endianness::Little >().data() )
+        {}
+        
+        Header::IMPL::IMPL( const uint8_t * data ):
             IMPL()
         {
-            this->_ident.resize( 16 );
-            stream.Read( &( this->_ident[ 0 ] ), 16 );
+            this->_ident.assign( data, data + 16 );
             
-            this->_type                        = stream.ReadLittleEndianUInt16();
-            this->_machine                     = stream.ReadLittleEndianUInt16();
-            this->_version                     = stream.ReadLittleEndianUInt32();
-            this->_entry                       = stream.ReadLittleEndianUInt64();
-            this->_programHeaderOffset         = stream.ReadLittleEndianUInt64();
-            this->_sectionHeaderOffset         = stream.ReadLittleEndianUInt64();
-            this->_flags                       = stream.ReadLittleEndianUInt32();
-            this->_elfHeaderSize               = stream.ReadLittleEndianUInt16();
-            this->_programHeaderEntrySize      = stream.ReadLittleEndianUInt16();
-            this->_programHeaderEntryCount     = stream.ReadLittleEndianUInt16();
-            this->_sectionHeaderEntrySize      = stream.ReadLittleEndianUInt16();
-            this->_sectionHeaderEntryCount     = stream.ReadLittleEndianUInt16();
-            this->_sectionNameStringTableIndex = stream.ReadLittleEndianUInt16();
+            this->_type                        = Endian::Load< uint16_t, Endianness::Little >( data + 16 );
+            this->_machine                     = Endian::Load< uint16_t, Endianness::Little >( data + 18 );
+            this->_version                     = Endian::Load< uint32_t, Endianness::Little >( data + 20 );
+            this->_entry                       = Endian::Load< uint64_t, Endianness::Little >( data + 24 );
+            this->_programHeaderOffset         = Endian::Load< uint64_t, Endianness::Little >( data + 32 );
+            this->_sectionHeaderOffset         = Endian::Load< uint64_t, Endianness::Little >( data + 40 );
+            this->_flags                       = Endian::Load< uint32_t, Endianness::Little >( data + 48 );
+            this->_elfHeaderSize               = Endian::Load< uint16_t, Endianness::Little >( data + 52 );
+            this->_programHeaderEntrySize      = Endian::Load< uint16_t, Endianness::Little >( data + 54 );
+            this->_programHeaderEntryCount     = Endian::Load< uint16_t, Endianness::Little >( data + 56 );
+            this->_sectionHeaderEntrySize      = Endian::Load< uint16_t, Endianness::Little >( data + 58 );
+            this->_sectionHeaderEntryCount     = Endian::Load< uint16_t, Endianness::Little >( data + 60 );
+            this->_sectionNameStringTableIndex = Endian::Load< uint16_t, Endianness::Little >( data + 62 );
         }
         
         Header::IMPL::IMPL( const IMPL & o ):
@@ -40,8 +40,11 @@ namespace VBox
         {
             public:
                 
+                static constexpr size_t recordSize = 64;
+                
                 Header( void );
                 Header( BinaryStream & stream );
+                Header( const uint8_t * data );
                 Header( const Header & o );
                 Header( Header && o );
                 ~Header( void );
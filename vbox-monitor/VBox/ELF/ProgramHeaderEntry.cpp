@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "VBox/ELF/ProgramHeaderEntry.hpp"
+#include "VBox/BinaryReader.hpp"
 #include "VBox/String.hpp"
 
 namespace VBox
@@ -35,6 +36,7 @@ namespace VBox
                 
                 IMPL( void );
                 IMPL( BinaryStream & stream );
+                IMPL( const uint8_t * data );
                 IMPL( const IMPL & o );
                 
                 uint32_t _type;
@@ -55,6 +57,10 @@ namespace VBox
             impl( std::make_unique< IMPL >( stream ) )
         {}
         
+        ProgramHeaderEntry::ProgramHeaderEntry( const uint8_t * data ):
+            impl( std::make_unique< IMPL >( data ) )
+        {}
+        
         ProgramHeaderEntry::ProgramHeaderEntry( const ProgramHeaderEntry & o ):
             impl( std::make_unique< IMPL >( *( o.impl ) ) )
         {}
@@ -150,14 +156,18 @@ namespace VBox
         {}
         
         ProgramHeaderEntry::IMPL::IMPL( BinaryStream & stream ):
-            _type(       stream.ReadLittleEndianUInt32() ),
-            _flags(      stream.ReadLittleEndianUInt32() ),
-            _offset(     stream.ReadLittleEndianUInt64() ),
-            _vaddress(   stream.ReadLittleEndianUInt64() ),
-            _paddress(   stream.ReadLittleEndianUInt64() ),
-            _fileSize(   stream.ReadLittleEndianUInt64() ),
-            _memorySize( stream.ReadLittleEndianUInt64() ),
-            _alignment(  stream.ReadLittleEndianUInt64() )
+            IMPL( BinaryReader< BinaryStream >( stream ).ReadRecord< recordSize, Endianness::Little >().data() )
+        {}
+        
+        ProgramHeaderEntry::IMPL::IMPL( const uint8_t * data ):
+            _type(       Endian::Load< uint32_t, Endianness::Little >( data +  0 ) ),
+            _flags(      Endian::Load< uint32_t, Endianness::Little >( data +  4 ) ),
+            _offset(     Endian::Load< uint64_t, Endianness::Little >( data +  8 ) ),
+            _vaddress(   Endian::Load< uint64_t, Endianness::Little >( data + 16 ) ),
+            _paddress(   Endian::Load< uint64_t, Endianness::Little >( data + 24 ) ),
+            _fileSize(   Endian::Load< uint64_t, Endianness::Little >( data + 32 ) ),
+            _memorySize( Endian::Load< uint64_t, Endianness::Little >( data + 40 ) ),
+            _alignment(  Endian::Load< uint64_t, Endianness::Little >( data + 48 ) )
         {}
         
         ProgramHeaderEntry::IMPL::IMPL( const IMPL & o ):
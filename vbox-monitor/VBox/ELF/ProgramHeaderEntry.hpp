@@ -39,8 +39,11 @@ namespace VBox
         {
             public:
                 
+                static constexpr size_t recordSize = 56;
+                
                 ProgramHeaderEntry( void );
                 ProgramHeaderEntry( BinaryStream & stream );
+                ProgramHeaderEntry( const uint8_t * data );
                 ProgramHeaderEntry( const ProgramHeaderEntry & o );
                 ProgramHeaderEntry( ProgramHeaderEntry && o );
                 ~ProgramHeaderEntry( void );
@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/ELF/SectionHeaderEntry.hpp"
+#include "VBox/BinaryReader.hpp"
+#include "VBox/String.hpp"
+
+namespace VBox
+{
+    namespace ELF
+    {
+        class SectionHeaderEntry::IMPL
+        {
+            public:
+                
+                IMPL( void );
+                IMPL( BinaryStream & stream );
+                IMPL( const uint8_t * data );
+                IMPL( const IMPL & o );
+                
+                uint32_t _name;
+                uint32_t _type;
+                uint64_t _flags;
+                uint64_t _address;
+                uint64_t _offset;
+                uint64_t _size;
+                uint32_t _link;
+                uint32_t _info;
+                uint64_t _alignment;
+                uint64_t _entrySize;
+        };
+        
+        SectionHeaderEntry::SectionHeaderEntry( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        SectionHeaderEntry::SectionHeaderEntry( BinaryStream & stream ):
+            impl( std::make_unique< IMPL >( stream ) )
+        {}
+        
+        SectionHeaderEntry::SectionHeaderEntry( const uint8_t * data ):
+            impl( std::make_unique< IMPL >( data ) )
+        {}
+        
+        SectionHeaderEntry::SectionHeaderEntry( const SectionHeaderEntry & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        SectionHeaderEntry::SectionHeaderEntry( SectionHeaderEntry && o ):
+            impl( std::move( o.impl ) )
+        {}
+        
+        SectionHeaderEntry::~SectionHeaderEntry( void )
+        {}
+        
+        SectionHeaderEntry & SectionHeaderEntry::operator =( SectionHeaderEntry o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        uint32_t SectionHeaderEntry::name( void ) const
+        {
+            return this->impl->_name;
+        }
+        
+        uint32_t SectionHeaderEntry::type( void ) const
+        {
+            return this->impl->_type;
+        }
+        
+        uint64_t SectionHeaderEntry::flags( void ) const
+        {
+            return this->impl->_flags;
+        }
+        
+        uint64_t SectionHeaderEntry::address( void ) const
+        {
+            return this->impl->_address;
+        }
+        
+        uint64_t SectionHeaderEntry::offset( void ) const
+        {
+            return this->impl->_offset;
+        }
+        
+        uint64_t SectionHeaderEntry::size( void ) const
+        {
+            return this->impl->_size;
+        }
+        
+        uint32_t SectionHeaderEntry::link( void ) const
+        {
+            return this->impl->_link;
+        }
+        
+        uint32_t SectionHeaderEntry::info( void ) const
+        {
+            return this->impl->_info;
+        }
+        
+        uint64_t SectionHeaderEntry::alignment( void ) const
+        {
+            return this->impl->_alignment;
+        }
+        
+        uint64_t SectionHeaderEntry::entrySize( void ) const
+        {
+            return this->impl->_entrySize;
+        }
+        
+        void swap( SectionHeaderEntry & o1, SectionHeaderEntry & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        std::ostream & operator <<( std::ostream & os, const SectionHeaderEntry & o )
+        {
+            os << "        {" << std::endl
+               << "            Name:        " << String::toHex( o.impl->_name )    << std::endl
+               << "            Type:        " << String::toHex( o.impl->_type )    << std::endl
+               << "            Flags:       " << String::toHex( o.impl->_flags )   << std::endl
+               << "            Address:     " << String::toHex( o.impl->_address ) << std::endl
+               << "            Offset:      " << String::toHex( o.impl->_offset )  << std::endl
+               << "            Size:        " << o.impl->_size                     << std::endl
+               << "            Link:        " << o.impl->_link                     << std::endl
+               << "            Info:        " << o.impl->_info                     << std::endl
+               << "            Alignment:   " << o.impl->_alignment                << std::endl
+               << "            Entry size:  " << o.impl->_entrySize                << std::endl
+               << "        }";
+            
+            return os;
+        }
+        
+        SectionHeaderEntry::IMPL::IMPL( void ):
+            _name(      0 ),
+            _type(      0 ),
+            _flags(     0 ),
+            _address(   0 ),
+            _offset(    0 ),
+            _size(      0 ),
+            _link(      0 ),
+            _info(      0 ),
+            _alignment( 0 ),
+            _entrySize( 0 )
+        {}
+        
+        SectionHeaderEntry::IMPL::IMPL( BinaryStream & stream ):
+            IMPL( BinaryReader< BinaryStream >( stream ).ReadRecord< recordSize, Endianness::Little >().data() )
+        {}
+        
+        SectionHeaderEntry::IMPL::IMPL( const uint8_t * data ):
+            _name(      Endian::Load< uint32_t, Endianness::Little >( data +  0 ) ),
+            _type(      Endian::Load< uint32_t, Endianness::Little >( data +  4 ) ),
+            _flags(     Endian::Load< uint64_t, Endianness::Little >( data +  8 ) ),
+            _address(   Endian::Load< uint64_t, Endianness::Little >( data + 16 ) ),
+            _offset(    Endian::Load< uint64_t, Endianness::Little >( data + 24 ) ),
+            _size(      Endian::Load< uint64_t, Endianness::Little >( data + 32 ) ),
+            _link(      Endian::Load< uint32_t, Endianness::Little >( data + 40 ) ),
+            _info(      Endian::Load< uint32_t, Endianness::Little >( data + 44 ) ),
+            _alignment( Endian::Load< uint64_t, Endianness::Little >( data + 48 ) ),
+            _entrySize( Endian::Load< uint64_t, Endianness::Little >( data + 56 ) )
+        {}
+        
+        SectionHeaderEntry::IMPL::IMPL( const IMPL & o ):
+            _name(      o._name ),
+            _type(      o._type ),
+            _flags(     o._flags ),
+            _address(   o._address ),
+            _offset(    o._offset ),
+            _size(      o._size ),
+            _link(      o._link ),
+            _info(      o._info ),
+            _alignment( o._alignment ),
+            _entrySize( o._entrySize )
+        {}
+    }
+}
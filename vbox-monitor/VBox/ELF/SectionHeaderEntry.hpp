@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_ELF_SECTION_HEADER_ENTRY_HPP
+#define VBOX_ELF_SECTION_HEADER_ENTRY_HPP
+
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <ostream>
+#include "VBox/BinaryStream.hpp"
+
+namespace VBox
+{
+    namespace ELF
+    {
+        class SectionHeaderEntry
+        {
+            public:
+                
+                static constexpr size_t recordSize = 64;
+                
+                SectionHeaderEntry( void );
+                SectionHeaderEntry( BinaryStream & stream );
+                SectionHeaderEntry( const uint8_t * data );
+                SectionHeaderEntry( const SectionHeaderEntry & o );
+                SectionHeaderEntry( SectionHeaderEntry && o );
+                ~SectionHeaderEntry( void );
+                
+                SectionHeaderEntry & operator =( SectionHeaderEntry o );
+                
+                uint32_t name( void )      const;
+                uint32_t type( void )      const;
+                uint64_t flags( void )     const;
+                uint64_t address( void )   const;
+                uint64_t offset( void )    const;
+                uint64_t size( void )      const;
+                uint32_t link( void )      const;
+                uint32_t info( void )      const;
+                uint64_t alignment( void ) const;
+                uint64_t entrySize( void ) const;
+                
+                friend void swap( SectionHeaderEntry & o1, SectionHeaderEntry & o2 );
+                
+                friend std::ostream & operator <<( std::ostream & os, const SectionHeaderEntry & o );
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_ELF_SECTION_HEADER_ENTRY_HPP */
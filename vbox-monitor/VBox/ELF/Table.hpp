@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_ELF_TABLE_HPP
+#define VBOX_ELF_TABLE_HPP
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+namespace VBox
+{
+    namespace ELF
+    {
+        /*
+         * Read-only view over a table of fixed-size ELF records (program or
+         * section headers). The bytes are validated once when the table is
+         * created, and entries are decoded on access. The owner keeps the
+         * underlying storage (usually a file mapping) alive.
+         */
+        template< typename _T_ >
+        class Table
+        {
+            public:
+                
+                class Iterator
+                {
+                    public:
+                        
+                        using iterator_category = std::forward_iterator_tag;
+                        using value_type        = _T_;
+                        using difference_type   = std::ptrdiff_t;
+                        using pointer           = void;
+                        using reference         = _T_;
+                        
+                        Iterator( const Table * table, size_t index ):
+                            _table( table ),
+                            _index( index )
+                        {}
+                        
+                        _T_ operator *( void ) const
+                        {
+                            return ( *( this->_table ) )[ this->_index ];
+                        }
+                        
+                        Iterator & operator ++( void )
+                        {
+                            this->_index++;
+                            
+                            return *( this );
+                        }
+                        
+                        bool operator ==( const Iterator & o ) const
+                        {
+                            return this->_table == o._table && this->_index == o._index;
+                        }
+                        
+                        bool operator !=( const Iterator & o ) const
+                        {
+                            return !( *( this ) == o );
+                        }
+                        
+                    private:
+                        
+                        const Table * _table;
+                        size_t        _index;
+                };
+                
+                Table( void ):
+                    _data(   nullptr ),
+                    _count(  0 ),
+                    _stride( 0 )
+                {}
+                
+                Table( const std::shared_ptr< const void > & owner, const uint8_t * data, size_t count, size_t stride ):
+                    _owner(  owner ),
+                    _data(   data ),
+                    _count(  count ),
+                    _stride( stride )
+                {}
+                
+                size_t size( void ) const
+                {
+                    return this->_count;
+                }
+                
+                bool empty( void ) const
+                {
+                    return this->_count == 0;
+                }
+                
+                _T_ operator []( size_t index ) const
+                {
+                    if( index >= this->_count )
+                    {
+                        throw std::out_of_range( "Invalid table index" );
+                    }
+                    
+                    return _T_( this->_data + ( index * this->_stride ) );
+                }
+                
+                Iterator begin( void ) const
+                {
+                    return Iterator( this, 0 );
+                }
+                
+                Iterator end( void ) const
+                {
+                    return Iterator( this, this->_count );
+                }
+                
+            private:
+                
+                std::shared_ptr< const void > _owner;
+                const uint8_t               * _data;
+                size_t                        _count;
+                size_t                        _stride;
+        };
+    }
+}
+
+#endif /* VBOX_ELF_TABLE_HPP */
@@ -0,0 +1,636 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/FileReader.hpp"
+#include "VBox/Casts.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef VBOX_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+namespace VBox
+{
+    class FileReader::IMPL
+    {
+        public:
+            
+            class Chunk
+            {
+                public:
+                    
+                    size_t   _range;
+                    uint64_t _offset;
+                    uint64_t _start;
+                    size_t   _head;
+                    size_t   _size;
+                    size_t   _length;
+            };
+            
+            class Buffer
+            {
+                public:
+                    
+                    Buffer( size_t size );
+                    ~Buffer( void );
+                    
+                    Buffer( const Buffer & o )              = delete;
+                    Buffer & operator =( const Buffer & o ) = delete;
+                    
+                    uint8_t * _data;
+            };
+            
+            static constexpr size_t threadCount = 4;
+            
+            IMPL( const std::string & path, Backend backend, bool direct, size_t chunkSize, size_t queueDepth );
+            ~IMPL( void );
+            
+            std::vector< Chunk > _chunks( const std::vector< std::pair< uint64_t, uint64_t > > & ranges ) const;
+            size_t               _slotSize( void )                                                            const;
+            void                 _pread( const Chunk & chunk, uint8_t * buf )                                  const;
+            void                 _readThreads( const std::vector< Chunk > & chunks, const Consumer & consume ) const;
+            
+            #ifdef VBOX_HAVE_LIBURING
+            void _readIOUring( const std::vector< Chunk > & chunks, const Consumer & consume ) const;
+            #endif
+            
+            std::string _path;
+            Backend     _backend;
+            bool        _direct;
+            size_t      _chunkSize;
+            size_t      _queueDepth;
+            int         _fd;
+            uint64_t    _size;
+    };
+    
+    /*
+     * io_uring may be compiled in but disabled at runtime (old kernels,
+     * seccomp, kernel.io_uring_disabled), so a ring is created once to
+     * find out.
+     */
+    bool FileReader::supports( Backend backend )
+    {
+        if( backend == Backend::Threads )
+        {
+            return true;
+        }
+        
+        #ifdef VBOX_HAVE_LIBURING
+        
+        static bool supported
+        (
+            []( void )
+            {
+                struct io_uring ring;
+                
+                if( io_uring_queue_init( 1, &ring, 0 ) < 0 )
+                {
+                    return false;
+                }
+                
+                io_uring_queue_exit( &ring );
+                
+                return true;
+            }
+            ()
+        );
+        
+        return supported;
+        
+        #else
+        
+        return false;
+        
+        #endif
+    }
+    
+    FileReader::Backend FileReader::defaultBackend( void )
+    {
+        return supports( Backend::IOUring ) ? Backend::IOUring : Backend::Threads;
+    }
+    
+    FileReader::FileReader( const std::string & path, bool direct, size_t chunkSize, size_t queueDepth ):
+        FileReader( path, defaultBackend(), direct, chunkSize, queueDepth )
+    {}
+    
+    FileReader::FileReader( const std::string & path, Backend backend, bool direct, size_t chunkSize, size_t queueDepth ):
+        impl( std::make_unique< IMPL >( path, backend, direct, chunkSize, queueDepth ) )
+    {}
+    
+    FileReader::~FileReader( void )
+    {}
+    
+    std::string FileReader::path( void ) const
+    {
+        return this->impl->_path;
+    }
+    
+    uint64_t FileReader::size( void ) const
+    {
+        return this->impl->_size;
+    }
+    
+    FileReader::Backend FileReader::backend( void ) const
+    {
+        return this->impl->_backend;
+    }
+    
+    bool FileReader::direct( void ) const
+    {
+        return this->impl->_direct;
+    }
+    
+    /*
+     * Ranges are split into chunks, which are passed to the consumer in
+     * order. Chunks start at multiples of the chunk size within their
+     * range, so a consumer working in pages never sees a page split across
+     * two calls.
+     */
+    void FileReader::read( const std::vector< std::pair< uint64_t, uint64_t > > & ranges, const Consumer & consume )
+    {
+        std::vector< IMPL::Chunk > chunks( this->impl->_chunks( ranges ) );
+        
+        if( chunks.size() == 0 )
+        {
+            return;
+        }
+        
+        #ifdef VBOX_HAVE_LIBURING
+        
+        if( this->impl->_backend == Backend::IOUring )
+        {
+            this->impl->_readIOUring( chunks, consume );
+            
+            return;
+        }
+        
+        #endif
+        
+        this->impl->_readThreads( chunks, consume );
+    }
+    
+    /*
+     * Direct I/O is not supported by every file system (tmpfs, for one),
+     * in which case the file is silently opened for buffered reads.
+     */
+    FileReader::IMPL::IMPL( const std::string & path, Backend backend, bool direct, size_t chunkSize, size_t queueDepth ):
+        _path(       path ),
+        _backend(    backend ),
+        _direct(     false ),
+        _chunkSize(  ( ( std::max< size_t >( chunkSize, 1 ) + alignment - 1 ) / alignment ) * alignment ),
+        _queueDepth( std::max< size_t >( queueDepth, 1 ) ),
+        _fd(         -1 ),
+        _size(       0 )
+    {
+        struct stat st;
+        
+        if( supports( backend ) == false )
+        {
+            throw std::runtime_error( "io_uring is not available" );
+        }
+        
+        #if defined( O_DIRECT )
+        
+        if( direct )
+        {
+            this->_fd     = open( path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT );
+            this->_direct = this->_fd != -1;
+        }
+        
+        #endif
+        
+        if( this->_fd == -1 )
+        {
+            this->_fd = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+        }
+        
+        if( this->_fd == -1 )
+        {
+            throw std::runtime_error( "Cannot open file: " + path );
+        }
+        
+        #if defined( F_NOCACHE )
+        
+        if( direct )
+        {
+            this->_direct = fcntl( this->_fd, F_NOCACHE, 1 ) != -1;
+        }
+        
+        #endif
+        
+        if( fstat( this->_fd, &st ) != 0 )
+        {
+            close( this->_fd );
+            
+            throw std::runtime_error( "Cannot stat file: " + path );
+        }
+        
+        this->_size = numeric_cast< uint64_t >( st.st_size );
+        
+        #if defined( POSIX_FADV_SEQUENTIAL )
+        
+        if( this->_direct == false )
+        {
+            posix_fadvise( this->_fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+        }
+        
+        #endif
+    }
+    
+    FileReader::IMPL::~IMPL( void )
+    {
+        close( this->_fd );
+    }
+    
+    /*
+     * Every read starts and ends on an alignment boundary, as required by
+     * direct I/O, and may therefore cover a few bytes before and after the
+     * chunk.
+     */
+    std::vector< FileReader::IMPL::Chunk > FileReader::IMPL::_chunks( const std::vector< std::pair< uint64_t, uint64_t > > & ranges ) const
+    {
+        std::vector< Chunk > chunks;
+        
+        for( size_t i = 0; i < ranges.size(); i++ )
+        {
+            if( ranges[ i ].first > this->_size || ranges[ i ].second > this->_size - ranges[ i ].first )
+            {
+                throw std::runtime_error( "Invalid read - Not enough data available" );
+            }
+            
+            for( uint64_t offset = 0; offset < ranges[ i ].second; offset += this->_chunkSize )
+            {
+                uint64_t position( ranges[ i ].first + offset );
+                uint64_t start(    position - position % alignment );
+                size_t   size(     numeric_cast< size_t >( std::min< uint64_t >( this->_chunkSize, ranges[ i ].second - offset ) ) );
+                size_t   head(     numeric_cast< size_t >( position - start ) );
+                
+                chunks.push_back( { i, offset, start, head, size, ( ( head + size + alignment - 1 ) / alignment ) * alignment } );
+            }
+        }
+        
+        return chunks;
+    }
+    
+    size_t FileReader::IMPL::_slotSize( void ) const
+    {
+        return this->_chunkSize + 2 * alignment;
+    }
+    
+    /*
+     * Reads may come back short at the end of the file, where the aligned
+     * length runs past it, which is fine as long as the chunk itself was
+     * read.
+     */
+    void FileReader::IMPL::_pread( const Chunk & chunk, uint8_t * buf ) const
+    {
+        size_t done( 0 );
+        
+        while( done < chunk._head + chunk._size )
+        {
+            ssize_t n( ::pread( this->_fd, buf + done, chunk._length - done, numeric_cast< off_t >( chunk._start + done ) ) );
+            
+            if( n < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            
+            if( n < 0 )
+            {
+                throw std::runtime_error( "Cannot read file: " + this->_path + " - " + strerror( errno ) );
+            }
+            
+            if( n == 0 )
+            {
+                throw std::runtime_error( "Invalid read - Unexpected end of file: " + this->_path );
+            }
+            
+            done += numeric_cast< size_t >( n );
+        }
+    }
+    
+    /*
+     * Chunk i is read into slot i % depth, which is only reused once the
+     * consumer is done with chunk i - depth. Reader threads run ahead of
+     * the consumer by at most depth chunks.
+     */
+    void FileReader::IMPL::_readThreads( const std::vector< Chunk > & chunks, const Consumer & consume ) const
+    {
+        size_t                     depth( std::min( this->_queueDepth, chunks.size() ) );
+        Buffer                     buffer( depth * this->_slotSize() );
+        std::vector< size_t >      ready( depth, 0 );
+        std::vector< std::thread > threads;
+        std::mutex                 mtx;
+        std::condition_variable    condition;
+        size_t                     next( 0 );
+        size_t                     consumed( 0 );
+        bool                       stop( false );
+        std::string                error;
+        
+        auto join
+        (
+            [ & ]( void )
+            {
+                {
+                    std::lock_guard< std::mutex > l( mtx );
+                    
+                    stop = stop || consumed < chunks.size();
+                }
+                
+                condition.notify_all();
+                
+                for( auto & thread: threads )
+                {
+                    thread.join();
+                }
+                
+                threads.clear();
+            }
+        );
+        
+        for( size_t i = 0; i < std::min( depth, threadCount ); i++ )
+        {
+            threads.emplace_back
+            (
+                [ & ]( void )
+                {
+                    while( true )
+                    {
+                        size_t n;
+                        
+                        {
+                            std::unique_lock< std::mutex > l( mtx );
+                            
+                            condition.wait( l, [ & ] { return stop || next >= chunks.size() || next < consumed + depth; } );
+                            
+                            if( stop || next >= chunks.size() )
+                            {
+                                return;
+                            }
+                            
+                            n = next++;
+                        }
+                        
+                        try
+                        {
+                            this->_pread( chunks[ n ], buffer._data + ( n % depth ) * this->_slotSize() );
+                        }
+                        catch( const std::exception & e )
+                        {
+                            std::lock_guard< std::mutex > l( mtx );
+                            
+                            error = ( error.length() > 0 ) ? error : e.what();
+                            stop  = true;
+                            
+                            condition.notify_all();
+                            
+                            return;
+                        }
+                        
+                        {
+                            std::lock_guard< std::mutex > l( mtx );
+                            
+                            ready[ n % depth ] = n + 1;
+                        }
+                        
+                        condition.notify_all();
+                    }
+                }
+            );
+        }
+        
+        try
+        {
+            for( size_t i = 0; i < chunks.size(); i++ )
+            {
+                {
+                    std::unique_lock< std::mutex > l( mtx );
+                    
+                    condition.wait( l, [ & ] { return stop || ready[ i % depth ] == i + 1; } );
+                    
+                    if( stop )
+                    {
+                        break;
+                    }
+                }
+                
+                consume( chunks[ i ]._range, chunks[ i ]._offset, buffer._data + ( i % depth ) * this->_slotSize() + chunks[ i ]._head, chunks[ i ]._size );
+                
+                {
+                    std::lock_guard< std::mutex > l( mtx );
+                    
+                    consumed = i + 1;
+                }
+                
+                condition.notify_all();
+            }
+        }
+        catch( ... )
+        {
+            join();
+            
+            throw;
+        }
+        
+        join();
+        
+        if( error.length() > 0 )
+        {
+            throw std::runtime_error( error );
+        }
+    }
+    
+    #ifdef VBOX_HAVE_LIBURING
+    
+    /*
+     * Keeps depth reads in flight. As with threads, chunk i is read into
+     * slot i % depth, and the read for chunk i + depth is only submitted
+     * once chunk i has been consumed. Short reads are resubmitted for the
+     * remaining bytes.
+     * The kernel may still be writing into the buffers if the consumer
+     * throws, so the ring is drained before they are released.
+     */
+    void FileReader::IMPL::_readIOUring( const std::vector< Chunk > & chunks, const Consumer & consume ) const
+    {
+        class Ring
+        {
+            public:
+                
+                Ring( unsigned int entries ):
+                    _inFlight( 0 )
+                {
+                    int res( io_uring_queue_init( entries, &( this->_ring ), 0 ) );
+                    
+                    if( res < 0 )
+                    {
+                        throw std::runtime_error( std::string( "Cannot create io_uring: " ) + strerror( -res ) );
+                    }
+                }
+                
+                ~Ring( void )
+                {
+                    struct io_uring_cqe * cqe;
+                    
+                    while( this->_inFlight > 0 && io_uring_wait_cqe( &( this->_ring ), &cqe ) == 0 )
+                    {
+                        io_uring_cqe_seen( &( this->_ring ), cqe );
+                        
+                        this->_inFlight--;
+                    }
+                    
+                    io_uring_queue_exit( &( this->_ring ) );
+                }
+                
+                Ring( const Ring & o )              = delete;
+                Ring & operator =( const Ring & o ) = delete;
+                
+                struct io_uring _ring;
+                size_t          _inFlight;
+        };
+        
+        size_t                depth( std::min( this->_queueDepth, chunks.size() ) );
+        Buffer                buffer( depth * this->_slotSize() );
+        std::vector< size_t > done( depth, 0 );
+        Ring                  ring( numeric_cast< unsigned int >( depth ) );
+        
+        auto submit
+        (
+            [ & ]( size_t n )
+            {
+                const Chunk         & chunk( chunks[ n ] );
+                size_t                from( done[ n % depth ] );
+                struct io_uring_sqe * sqe( io_uring_get_sqe( &( ring._ring ) ) );
+                int                   res;
+                
+                if( sqe == nullptr )
+                {
+                    throw std::runtime_error( "Cannot read file: " + this->_path + " - io_uring queue is full" );
+                }
+                
+                io_uring_prep_read( sqe, this->_fd, buffer._data + ( n % depth ) * this->_slotSize() + from, numeric_cast< unsigned int >( chunk._length - from ), chunk._start + from );
+                io_uring_sqe_set_data64( sqe, n );
+                
+                res = io_uring_submit( &( ring._ring ) );
+                
+                if( res < 0 )
+                {
+                    throw std::runtime_error( "Cannot read file: " + this->_path + " - " + strerror( -res ) );
+                }
+                
+                ring._inFlight++;
+            }
+        );
+        
+        for( size_t i = 0; i < depth; i++ )
+        {
+            submit( i );
+        }
+        
+        for( size_t i = 0; i < chunks.size(); i++ )
+        {
+            while( done[ i % depth ] < chunks[ i ]._head + chunks[ i ]._size )
+            {
+                struct io_uring_cqe * cqe;
+                int                   res( io_uring_wait_cqe( &( ring._ring ), &cqe ) );
+                size_t                n;
+                
+                if( res == -EINTR )
+                {
+                    continue;
+                }
+                
+                if( res < 0 )
+                {
+                    throw std::runtime_error( "Cannot read file: " + this->_path + " - " + strerror( -res ) );
+                }
+                
+                n   = numeric_cast< size_t >( io_uring_cqe_get_data64( cqe ) );
+                res = cqe->res;
+                
+                io_uring_cqe_seen( &( ring._ring ), cqe );
+                
+                ring._inFlight--;
+                
+                if( res < 0 )
+                {
+                    throw std::runtime_error( "Cannot read file: " + this->_path + " - " + strerror( -res ) );
+                }
+                
+                if( res == 0 )
+                {
+                    throw std::runtime_error( "Invalid read - Unexpected end of file: " + this->_path );
+                }
+                
+                done[ n % depth ] += numeric_cast< size_t >( res );
+                
+                if( done[ n % depth ] < chunks[ n ]._head + chunks[ n ]._size )
+                {
+                    submit( n );
+                }
+            }
+            
+            consume( chunks[ i ]._range, chunks[ i ]._offset, buffer._data + ( i % depth ) * this->_slotSize() + chunks[ i ]._head, chunks[ i ]._size );
+            
+            done[ i % depth ] = 0;
+            
+            if( i + depth < chunks.size() )
+            {
+                submit( i + depth );
+            }
+        }
+    }
+    
+    #endif
+    
+    /*
+     * Direct I/O needs aligned buffers.
+     */
+    FileReader::IMPL::Buffer::Buffer( size_t size ):
+        _data( nullptr )
+    {
+        void * p( nullptr );
+        
+        if( posix_memalign( &p, alignment, size ) != 0 )
+        {
+            throw std::bad_alloc();
+        }
+        
+        this->_data = static_cast< uint8_t * >( p );
+    }
+    
+    FileReader::IMPL::Buffer::~Buffer( void )
+    {
+        free( this->_data );
+    }
+}
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_FILE_READER_HPP
+#define VBOX_FILE_READER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace VBox
+{
+    /*
+     * Reads large ranges of a file with many requests in flight, handing
+     * each chunk to a consumer in file order while the following chunks
+     * are still being read.
+     * Uses io_uring when available, and a few pread() threads otherwise.
+     * Direct I/O bypasses the page cache, so reading a large file does not
+     * evict everything else from it.
+     */
+    class FileReader
+    {
+        public:
+            
+            enum class Backend
+            {
+                Threads,
+                IOUring
+            };
+            
+            using Consumer = std::function< void( size_t range, uint64_t offset, const uint8_t * data, size_t size ) >;
+            
+            static constexpr size_t alignment         = 4096;
+            static constexpr size_t defaultChunkSize  = 1024 * 1024;
+            static constexpr size_t defaultQueueDepth = 8;
+            
+            static bool    supports( Backend backend );
+            static Backend defaultBackend( void );
+            
+            FileReader( const std::string & path, bool direct = false, size_t chunkSize = defaultChunkSize, size_t queueDepth = defaultQueueDepth );
+            FileReader( const std::string & path, Backend backend, bool direct = false, size_t chunkSize = defaultChunkSize, size_t queueDepth = defaultQueueDepth );
+            ~FileReader( void );
+            
+            FileReader( const FileReader & o )              = delete;
+            FileReader( FileReader && o )                   = delete;
+            FileReader & operator =( const FileReader & o ) = delete;
+            FileReader & operator =( FileReader && o )      = delete;
+            
+            std::string path( void )    const;
+            uint64_t    size( void )    const;
+            Backend     backend( void ) const;
+            bool        direct( void )  const;
+            
+            void read( const std::vector< std::pair< uint64_t, uint64_t > > & ranges, const Consumer & consume );
+            
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_FILE_READER_HPP */
@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/Histogram.hpp"
+#include <atomic>
+#include <array>
+#include <cmath>
+
+namespace VBox
+{
+    class Histogram::IMPL
+    {
+        public:
+            
+            /*
+             * Log-linear buckets: values below 8 get one bucket each, larger
+             * values are split in 8 sub-buckets per power of two, which keeps
+             * the relative error of any reported value below 12.5%.
+             */
+            static constexpr size_t subBuckets = 8;
+            static constexpr size_t buckets    = ( 62 * subBuckets );
+            
+            IMPL( void );
+            
+            static size_t   _index( uint64_t value );
+            static uint64_t _upperBound( size_t index );
+            
+            std::array< std::atomic< uint64_t >, buckets > _buckets;
+            std::atomic< uint64_t >                        _count;
+            std::atomic< uint64_t >                        _sum;
+            std::atomic< uint64_t >                        _max;
+    };
+    
+    Histogram::Histogram( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    Histogram::~Histogram( void )
+    {}
+    
+    uint64_t Histogram::count( void ) const
+    {
+        return this->impl->_count.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Histogram::sum( void ) const
+    {
+        return this->impl->_sum.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Histogram::max( void ) const
+    {
+        return this->impl->_max.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Histogram::mean( void ) const
+    {
+        uint64_t count( this->count() );
+        
+        return ( count == 0 ) ? 0 : this->sum() / count;
+    }
+    
+    uint64_t Histogram::percentile( double p ) const
+    {
+        uint64_t count( 0 );
+        uint64_t total( this->count() );
+        uint64_t rank;
+        
+        if( total == 0 )
+        {
+            return 0;
+        }
+        
+        p    = std::min( std::max( p, 0.0 ), 100.0 );
+        rank = std::max< uint64_t >( static_cast< uint64_t >( std::ceil( ( p / 100.0 ) * static_cast< double >( total ) ) ), 1 );
+        
+        for( size_t i = 0; i < IMPL::buckets; i++ )
+        {
+            count += this->impl->_buckets[ i ].load( std::memory_order_relaxed );
+            
+            if( count >= rank )
+            {
+                return std::min( IMPL::_upperBound( i ), this->max() );
+            }
+        }
+        
+        return this->max();
+    }
+    
+    void Histogram::record( uint64_t value )
+    {
+        uint64_t max( this->impl->_max.load( std::memory_order_relaxed ) );
+        
+        this->impl->_buckets[ IMPL::_index( value ) ].fetch_add( 1, std::memory_order_relaxed );
+        this->impl->_count.fetch_add( 1, std::memory_order_relaxed );
+        this->impl->_sum.fetch_add( value, std::memory_order_relaxed );
+        
+        while( value > max && this->impl->_max.compare_exchange_weak( max, value, std::memory_order_relaxed ) == false )
+        {}
+    }
+    
+    void Histogram::reset( void )
+    {
+        for( auto & bucket: this->impl->_buckets )
+        {
+            bucket.store( 0, std::memory_order_relaxed );
+        }
+        
+        this->impl->_count.store( 0, std::memory_order_relaxed );
+        this->impl->_sum.store( 0, std::memory_order_relaxed );
+        this->impl->_max.store( 0, std::memory_order_relaxed );
+    }
+    
+    Histogram::IMPL::IMPL( void ):
+        _count( 0 ),
+        _sum(   0 ),
+        _max(   0 )
+    {
+        for( auto & bucket: this->_buckets )
+        {
+            bucket.store( 0, std::memory_order_relaxed );
+        }
+    }
+    
+    size_t Histogram::IMPL::_index( uint64_t value )
+    {
+        size_t exponent;
+        
+        if( value < subBuckets )
+        {
+            return static_cast< size_t >( value );
+        }
+        
+        exponent = static_cast< size_t >( 63 - __builtin_clzll( value ) );
+        
+        return ( ( exponent - 2 ) * subBuckets ) + static_cast< size_t >( ( value >> ( exponent - 3 ) ) & ( subBuckets - 1 ) );
+    }
+    
+    uint64_t Histogram::IMPL::_upperBound( size_t index )
+    {
+        size_t exponent;
+        
+        if( index < subBuckets )
+        {
+            return index;
+        }
+        
+        exponent = ( index / subBuckets ) + 2;
+        
+        return ( ( ( subBuckets + ( index % subBuckets ) + 1 ) << ( exponent - 3 ) ) - 1 );
+    }
+}
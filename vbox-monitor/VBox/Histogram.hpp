@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_HISTOGRAM_HPP
+#define VBOX_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+
+namespace VBox
+{
+    class Histogram
+    {
+        public:
+            
+            Histogram( void );
+            ~Histogram( void );
+            
+            Histogram( const Histogram & o )              = delete;
+            Histogram( Histogram && o )                   = delete;
+            Histogram & operator =( const Histogram & o ) = delete;
+            Histogram & operator =( Histogram && o )      = delete;
+            
+            uint64_t count( void )          const;
+            uint64_t sum( void )            const;
+            uint64_t max( void )            const;
+            uint64_t mean( void )           const;
+            uint64_t percentile( double p ) const;
+            
+            void record( uint64_t value );
+            void reset( void );
+            
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_HISTOGRAM_HPP */
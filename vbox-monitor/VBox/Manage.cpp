@@ -23,158 +23,460 @@
  ******************************************************************************/
 
 #include "VBox/Manage.hpp"
-#include "VBox/Process.hpp"
+#include "VBox/CLIBackend.hpp"
 #include "VBox/String.hpp"
+#include "VBox/Stats.hpp"
+#include "VBox/VM/DumpTarget.hpp"
+#include <array>
 #include <optional>
 #include <regex>
 #include <iostream>
-#include <unistd.h>
+#include <mutex>
+#include <cstring>
 
 namespace VBox
 {
     namespace Manage
     {
-        bool registerVM( const std::string & path )
+        static std::mutex                                               executableMutex;
+        static std::string                                              executablePath( "/usr/local/bin/VBoxManage" );
+        static std::mutex                                               timeoutMutex;
+        static std::array< std::chrono::milliseconds, Stats::channels > timeouts( { std::chrono::seconds( 5 ), std::chrono::seconds( 5 ), std::chrono::seconds( 60 ), std::chrono::seconds( 5 ), std::chrono::seconds( 5 ) } );
+        static std::chrono::milliseconds                                controlTimeoutValue( std::chrono::seconds( 60 ) );
+        static std::mutex                                               backendMutex;
+        static std::shared_ptr< Backend >                               currentBackend;
+        static StopToken                                                oneShotToken;
+        
+        std::string executable( void )
         {
-            Process proc( "/usr/local/bin/VBoxManage" );
+            std::lock_guard< std::mutex > l( executableMutex );
             
-            proc.arguments
-            (
-                {
-                    "registervm", path
-                }
-            );
+            return executablePath;
+        }
+        
+        void executable( const std::string & path )
+        {
+            std::lock_guard< std::mutex > l( executableMutex );
             
-            proc.start();
-            proc.waitUntilExit();
+            executablePath = path;
+        }
+        
+        /*
+         * How long VBoxManage requests made for a channel may run before
+         * they are killed. Dumps write all of guest memory, so the memory
+         * channel gets longer.
+         */
+        std::chrono::milliseconds timeout( Stats::Channel channel )
+        {
+            std::lock_guard< std::mutex > l( timeoutMutex );
             
-            return proc.terminationStatus().value_or( -1 ) == 0;
+            return timeouts[ static_cast< size_t >( channel ) ];
         }
         
-        bool unregisterVM( const std::string & vmName )
+        void timeout( Stats::Channel channel, std::chrono::milliseconds value )
         {
-            Process proc( "/usr/local/bin/VBoxManage" );
+            std::lock_guard< std::mutex > l( timeoutMutex );
             
-            proc.arguments
-            (
-                {
-                    "unregistervm", vmName
-                }
-            );
+            timeouts[ static_cast< size_t >( channel ) ] = value;
+        }
+        
+        /*
+         * How long commands that register, start or stop VMs may run
+         * before they are killed. Starting a VM can take a while.
+         */
+        std::chrono::milliseconds controlTimeout( void )
+        {
+            std::lock_guard< std::mutex > l( timeoutMutex );
             
-            proc.start();
-            proc.waitUntilExit();
+            return controlTimeoutValue;
+        }
+        
+        void controlTimeout( std::chrono::milliseconds value )
+        {
+            std::lock_guard< std::mutex > l( timeoutMutex );
             
-            return proc.terminationStatus().value_or( -1 ) == 0;
+            controlTimeoutValue = value;
         }
         
-        bool startVM( const std::string & vmName )
+        /*
+         * Defaults to the VBoxManage command line. Setting a null backend
+         * restores the default.
+         */
+        std::shared_ptr< Backend > backend( void )
         {
-            Process proc( "/usr/local/bin/VBoxManage" );
+            std::lock_guard< std::mutex > l( backendMutex );
             
-            proc.arguments
-            (
-                {
-                    "startvm", "--type=separate", vmName
-                }
-            );
+            if( currentBackend == nullptr )
+            {
+                currentBackend = std::make_shared< CLIBackend >();
+            }
             
-            proc.start();
-            proc.waitUntilExit();
+            return currentBackend;
+        }
+        
+        void backend( std::shared_ptr< Backend > value )
+        {
+            std::lock_guard< std::mutex > l( backendMutex );
             
-            return proc.terminationStatus().value_or( -1 ) == 0;
+            currentBackend = value;
+        }
+        
+        bool registerVM( const std::string & path )
+        {
+            return backend()->registerVM( path );
+        }
+        
+        bool unregisterVM( const std::string & vmName )
+        {
+            return backend()->unregisterVM( vmName );
+        }
+        
+        bool startVM( const std::string & vmName )
+        {
+            return backend()->startVM( vmName );
         }
         
         bool powerOffVM( const std::string & vmName )
         {
-            Process proc( "/usr/local/bin/VBoxManage" );
-            
-            proc.arguments
-            (
-                {
-                    "controlvm", vmName, "poweroff"
-                }
-            );
-            
-            proc.start();
-            proc.waitUntilExit();
-            
-            return proc.terminationStatus().value_or( -1 ) == 0;
+            return backend()->powerOffVM( vmName );
         }
         
+        /*
+         * One-shot calls cannot be stopped, so they share a token that
+         * never is, rather than each waiting on a new one, which would
+         * create and close a pipe every time.
+         */
         std::vector< VM::Info > runningVMs( void )
         {
-            std::vector< VM::Info >      running;
-            Process                      proc( "/usr/local/bin/VBoxManage" );
-            std::optional< std::string > out;
-            
-            proc.arguments
-            (
+            return backend()->runningVMs( oneShotToken );
+        }
+        
+        std::optional< pid_t > hostProcess( const std::string & vmName )
+        {
+            return backend()->hostProcess( vmName, oneShotToken );
+        }
+        
+        namespace Debug
+        {
+            std::optional< VM::Registers > registers( const std::string & vmName )
+            {
+                VM::Registers regs;
+                
+                if( registers( vmName, regs ) != Backend::Error::None )
                 {
-                    "list", "runningvms"
+                    return {};
                 }
-            );
+                
+                return regs;
+            }
             
-            proc.start();
-            proc.waitUntilExit();
+            /*
+             * Fills an existing object, so a recycled snapshot can be used.
+             */
+            Backend::Error registers( const std::string & vmName, VM::Registers & registers )
+            {
+                return backend()->registers( vmName, registers, oneShotToken );
+            }
             
-            out = proc.output();
+            std::vector< VM::StackEntry > stack( const std::string & vmName )
+            {
+                std::vector< VM::StackEntry > entries;
+                
+                stack( vmName, entries );
+                
+                return entries;
+            }
             
-            if( out.has_value() == false )
+            /*
+             * Entries are written over the existing ones, so the vector of a
+             * recycled snapshot keeps its storage. Empty on failure.
+             */
+            Backend::Error stack( const std::string & vmName, std::vector< VM::StackEntry > & stack )
             {
-                return {};
+                return backend()->stack( vmName, stack, oneShotToken );
             }
             
+            std::shared_ptr< VM::CoreDump > dump( const std::string & vmName, std::shared_ptr< VM::PageStore > store )
             {
-                std::regex  regex( "\"([^\"]+)\" \\{([^}]+)\\}" );
-                std::smatch match;
-                
-                for( const auto & line: String::lines( out.value() ) )
+                try
                 {
-                    if( std::regex_match( line, match, regex ) )
+                    VM::DumpTarget             target;
+                    std::optional< ELF::File > elf;
+                    
+                    if( capture( vmName, target, elf ) != Backend::Error::None || elf.has_value() == false )
+                    {
+                        return {};
+                    }
+                    
                     {
-                        running.push_back( { match[ 1 ], match[ 2 ] } );
+                        Stats::Scope scope( Stats::Channel::Memory, Stats::Stage::Parse );
+                        
+                        return std::make_shared< VM::CoreDump >( elf.value(), store );
                     }
                 }
+                catch( ... )
+                {
+                    return {};
+                }
             }
             
-            return running;
+            Backend::Error capture( const std::string & vmName, VM::DumpTarget & target, std::optional< ELF::File > & elf )
+            {
+                return backend()->capture( vmName, target, elf, oneShotToken );
+            }
         }
         
-        namespace Debug
+        namespace Parse
         {
-            std::optional< VM::Registers > registers( const std::string & vmName )
+            std::vector< VM::Info > runningVMs( const std::string & output )
+            {
+                std::vector< VM::Info > running;
+                
+                {
+                    std::regex  regex( "\"([^\"]+)\" \\{([^}]+)\\}" );
+                    std::smatch match;
+                    
+                    for( const auto & line: String::lines( output ) )
+                    {
+                        if( std::regex_match( line, match, regex ) )
+                        {
+                            running.push_back( { match[ 1 ], match[ 2 ] } );
+                        }
+                    }
+                }
+                
+                return running;
+            }
+            
+            /*
+             * Takes "ps -o pid=,command=" output. VM processes are started
+             * with the VM's UUID or name after --startvm, and GUI ones also
+             * with its name after --comment.
+             */
+            std::optional< pid_t > hostProcess( const std::string & output, const std::string & vmName, const std::string & uid )
+            {
+                std::vector< std::string > hosts( { "VBoxHeadless", "VirtualBoxVM", "VirtualBox" } );
+                std::vector< std::string > keys(  { "--startvm " + uid, "--startvm " + vmName, "--comment " + vmName } );
+                
+                for( const auto & line: String::lines( output ) )
+                {
+                    size_t      start( line.find_first_not_of( ' ' ) );
+                    size_t      end( ( start == std::string::npos ) ? std::string::npos : line.find( ' ', start ) );
+                    std::string command;
+                    bool        host( false );
+                    
+                    if( end == std::string::npos )
+                    {
+                        continue;
+                    }
+                    
+                    command = line.substr( end + 1 );
+                    
+                    {
+                        std::string executable( command.substr( 0, command.find( ' ' ) ) );
+                        
+                        executable = executable.substr( executable.rfind( '/' ) + 1 );
+                        
+                        for( const auto & name: hosts )
+                        {
+                            host = host || executable == name;
+                        }
+                    }
+                    
+                    if( host == false )
+                    {
+                        continue;
+                    }
+                    
+                    for( const auto & key: keys )
+                    {
+                        size_t pos( ( command + " " ).find( key + " " ) );
+                        
+                        if( pos != std::string::npos )
+                        {
+                            return static_cast< pid_t >( std::strtol( line.substr( start, end - start ).c_str(), nullptr, 10 ) );
+                        }
+                    }
+                }
+                
+                return {};
+            }
+            
+            /*
+             * Takes debugger console display output ("db", "dw", "dd" or "dq"),
+             * one line per 16 bytes: an address, optionally prefixed with "%"
+             * or "%%" and followed by ":", the values, separated by spaces or
+             * a "-", then the characters. Values are byte-swapped from their
+             * displayed order. Only the bytes within the requested range are
+             * written, wherever their line falls in the output, and their
+             * count is returned. Other lines (prompts, errors) are skipped.
+             */
+            size_t memory( const std::string & output, uint64_t address, uint64_t size, uint8_t * data )
+            {
+                const char * p( output.data() );
+                const char * end( p + output.size() );
+                size_t       count( 0 );
+                
+                auto hex = []( char c ) -> int
+                {
+                    if( c >= '0' && c <= '9' ) return c - '0';
+                    if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+                    if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+                    
+                    return -1;
+                };
+                
+                while( p < end )
+                {
+                    const char * eol( static_cast< const char * >( memchr( p, '\n', static_cast< size_t >( end - p ) ) ) );
+                    uint64_t     line( 0 );
+                    uint64_t     offset( 0 );
+                    bool         valid( false );
+                    
+                    eol = ( eol == nullptr ) ? end : eol;
+                    
+                    while( p < eol && ( *( p ) == ' ' || *( p ) == '%' ) )
+                    {
+                        p++;
+                    }
+                    
+                    while( p < eol && hex( *( p ) ) >= 0 )
+                    {
+                        line  = ( line << 4 ) | static_cast< uint64_t >( hex( *( p++ ) ) );
+                        valid = true;
+                    }
+                    
+                    if( p < eol && *( p ) == ':' )
+                    {
+                        p++;
+                    }
+                    
+                    while( valid && offset < 16 && p + 1 < eol && ( *( p ) == ' ' || *( p ) == '-' ) && hex( p[ 1 ] ) >= 0 )
+                    {
+                        const char * value( ++p );
+                        size_t       digits( 0 );
+                        
+                        while( p < eol && hex( *( p ) ) >= 0 )
+                        {
+                            p++;
+                            digits++;
+                        }
+                        
+                        if( digits % 2 != 0 || digits > 16 || ( p < eol && *( p ) != ' ' && *( p ) != '-' && *( p ) != '\r' ) )
+                        {
+                            break;
+                        }
+                        
+                        for( size_t i = 0; i < digits / 2; i++, offset++ )
+                        {
+                            const char * byte( value + digits - ( i + 1 ) * 2 );
+                            uint64_t     at( line + offset );
+                            
+                            if( at >= address && at - address < size )
+                            {
+                                data[ at - address ] = static_cast< uint8_t >( ( hex( byte[ 0 ] ) << 4 ) | hex( byte[ 1 ] ) );
+                                
+                                count++;
+                            }
+                        }
+                    }
+                    
+                    p = eol + 1;
+                }
+                
+                return count;
+            }
+            
+            /*
+             * Takes "showvminfo --machinereadable" output, where the RAM size
+             * is given in MiB.
+             */
+            std::optional< uint64_t > memorySize( const std::string & output )
+            {
+                for( const auto & line: String::lines( output ) )
+                {
+                    if( line.substr( 0, 7 ) == "memory=" )
+                    {
+                        uint64_t size( std::strtoull( line.c_str() + 7, nullptr, 10 ) );
+                        
+                        if( size > 0 )
+                        {
+                            return size * 1024 * 1024;
+                        }
+                    }
+                }
+                
+                return {};
+            }
+            
+            /*
+             * Classifies what VBoxManage prints on standard error when it
+             * fails. It reports COM result codes by name, next to its own
+             * messages, which differ between versions.
+             */
+            Backend::Error error( const std::string & output )
             {
-                VM::Registers                reg;
-                Process                      proc( "/usr/local/bin/VBoxManage" );
-                std::optional< std::string > out;
+                static const std::vector< std::string > notRunning
+                (
+                    {
+                        "is not currently running",
+                        "Could not find a registered machine",
+                        "VBOX_E_OBJECT_NOT_FOUND"
+                    }
+                );
                 
-                proc.arguments
+                static const std::vector< std::string > busy
                 (
                     {
-                        "debugvm", vmName, "getregisters",
-                        "rax", "rbx", "rcx", "rdx", "rdi", "rsi",
-                        "r8",  "r9",  "r10", "r11", "r12", "r13",
-                        "r14", "r15", "rbp", "rsp", "rip", "eflags"
+                        "VBOX_E_INVALID_VM_STATE",
+                        "VBOX_E_INVALID_OBJECT_STATE",
+                        "VBOX_E_INVALID_SESSION_STATE",
+                        "is already locked",
+                        "state is "
                     }
                 );
                 
-                proc.start();
-                proc.waitUntilExit();
+                for( const auto & s: notRunning )
+                {
+                    if( output.find( s ) != std::string::npos )
+                    {
+                        return Backend::Error::NotRunning;
+                    }
+                }
+                
+                for( const auto & s: busy )
+                {
+                    if( output.find( s ) != std::string::npos )
+                    {
+                        return Backend::Error::Busy;
+                    }
+                }
                 
-                out = proc.output();
+                return Backend::Error::Failed;
+            }
+            
+            std::optional< VM::Registers > registers( const std::string & output )
+            {
+                VM::Registers reg;
                 
-                if( out.has_value() == false )
+                if( registers( output, reg ) == false )
                 {
                     return {};
                 }
                 
+                return reg;
+            }
+            
+            bool registers( const std::string & output, VM::Registers & reg )
+            {
+                reg = VM::Registers();
+                
                 {
                     std::regex  regex( "([^ ]+) = (0x[0-9a-f]+)" );
                     std::smatch match;
                     bool        matched( false );
                     
-                    for( const auto & line: String::lines( out.value() ) )
+                    for( const auto & line: String::lines( output ) )
                     {
                         if( std::regex_match( line, match, regex ) )
                         {
@@ -206,46 +508,33 @@ namespace VBox
                         }
                     }
                     
-                    if( matched == false )
-                    {
-                        return {};
-                    }
+                    return matched;
                 }
-                
-                return reg;
             }
             
-            std::vector< VM::StackEntry > stack( const std::string & vmName )
+            std::vector< VM::StackEntry > stack( const std::string & output )
             {
                 std::vector< VM::StackEntry > entries;
-                Process                       proc( "/usr/local/bin/VBoxManage" );
-                std::optional< std::string >  out;
                 
-                proc.arguments
-                (
-                    {
-                        "debugvm", vmName, "stack",
-                    }
-                );
-                
-                proc.start();
-                proc.waitUntilExit();
+                stack( output, entries );
                 
-                out = proc.output();
-                
-                if( out.has_value() == false )
-                {
-                    return entries;
-                }
+                return entries;
+            }
+            
+            void stack( const std::string & output, std::vector< VM::StackEntry > & entries )
+            {
+                size_t count( 0 );
                 
                 {
-                    std::vector< std::string > lines( String::lines( out.value() ) );
+                    std::vector< std::string > lines( String::lines( output ) );
                     std::regex                 regex( "([0-9a-f]+):([0-9a-f]+) ([0-9a-f]+):([0-9a-f]+) ([0-9a-f]+):([0-9a-f]+) ([0-9a-f]+) ([0-9a-f]+) ([0-9a-f]+) ([0-9a-f]+) ([0-9a-f]+):([0-9a-f]+)" );
                     std::smatch                match;
                     
                     if( lines.size() < 2 )
                     {
-                        return entries;
+                        entries.clear();
+                        
+                        return;
                     }
                     
                     lines.erase( lines.begin() );
@@ -266,7 +555,13 @@ namespace VBox
                             uint32_t       u10( String::fromHex< uint32_t >( match[ 10 ] ) );
                             uint32_t       u11( String::fromHex< uint32_t >( match[ 11 ] ) );
                             uint32_t       u12( String::fromHex< uint32_t >( match[ 12 ] ) );
-                            VM::StackEntry entry;
+                            
+                            if( count == entries.size() )
+                            {
+                                entries.emplace_back();
+                            }
+                            
+                            VM::StackEntry & entry( entries[ count++ ] );
                             
                             entry.bp(    { u1, u2 } );
                             entry.retBP( { u3, u4 } );
@@ -276,44 +571,11 @@ namespace VBox
                             entry.arg2(  u9 );
                             entry.arg3(  u10 );
                             entry.ip(   { u11, u12 } );
-                            
-                            entries.push_back( entry );
                         }
                     }
                 }
                 
-                return entries;
-            }
-            
-            std::shared_ptr< VM::CoreDump > dump( const std::string & vmName, const std::string & path )
-            {
-                try
-                {
-                    Process proc( "/usr/local/bin/VBoxManage" );
-                    
-                    proc.arguments
-                    (
-                        {
-                            "debugvm", vmName, "dumpvmcore",
-                            "--filename=" + path,
-                        }
-                    );
-                    
-                    proc.start();
-                    proc.waitUntilExit();
-                    
-                    {
-                        std::shared_ptr< VM::CoreDump > dump( std::make_shared< VM::CoreDump >( path ) );
-                        
-                        unlink( path.c_str() );
-                        
-                        return dump;
-                    }
-                }
-                catch( ... )
-                {
-                    return {};
-                }
+                entries.resize( count );
             }
         }
     }
@@ -29,6 +29,11 @@
 #include "VBox/VM/StackEntry.hpp"
 #include "VBox/VM/CoreDump.hpp"
 #include "VBox/VM/Info.hpp"
+#include "VBox/VM/DumpTarget.hpp"
+#include "VBox/Backend.hpp"
+#include "VBox/Stats.hpp"
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
@@ -37,18 +42,46 @@ namespace VBox
 {
     namespace Manage
     {
+        std::string executable( void );
+        void        executable( const std::string & path );
+        
+        std::chrono::milliseconds timeout( Stats::Channel channel );
+        void                      timeout( Stats::Channel channel, std::chrono::milliseconds value );
+        std::chrono::milliseconds controlTimeout( void );
+        void                      controlTimeout( std::chrono::milliseconds value );
+        
+        std::shared_ptr< Backend > backend( void );
+        void                       backend( std::shared_ptr< Backend > value );
+        
         bool registerVM( const std::string & path );
         bool unregisterVM( const std::string & vmName );
         bool startVM( const std::string & vmName );
         bool powerOffVM( const std::string & vmName );
         
         std::vector< VM::Info > runningVMs( void );
+        std::optional< pid_t >  hostProcess( const std::string & vmName );
         
         namespace Debug
         {
             std::optional< VM::Registers >  registers( const std::string & vmName );
+            Backend::Error                  registers( const std::string & vmName, VM::Registers & registers );
             std::vector< VM::StackEntry >   stack( const std::string & vmName );
-            std::shared_ptr< VM::CoreDump > dump( const std::string & vmName, const std::string & path );
+            Backend::Error                  stack( const std::string & vmName, std::vector< VM::StackEntry > & stack );
+            std::shared_ptr< VM::CoreDump > dump( const std::string & vmName, std::shared_ptr< VM::PageStore > store = nullptr );
+            Backend::Error                  capture( const std::string & vmName, VM::DumpTarget & target, std::optional< ELF::File > & elf );
+        }
+        
+        namespace Parse
+        {
+            std::vector< VM::Info >        runningVMs( const std::string & output );
+            std::optional< pid_t >         hostProcess( const std::string & output, const std::string & vmName, const std::string & uid );
+            std::optional< VM::Registers > registers( const std::string & output );
+            bool                           registers( const std::string & output, VM::Registers & registers );
+            std::vector< VM::StackEntry >  stack( const std::string & output );
+            void                           stack( const std::string & output, std::vector< VM::StackEntry > & stack );
+            size_t                         memory( const std::string & output, uint64_t address, uint64_t size, uint8_t * data );
+            std::optional< uint64_t >      memorySize( const std::string & output );
+            Backend::Error                 error( const std::string & output );
         }
     };
 }
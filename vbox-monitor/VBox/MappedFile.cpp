@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/MappedFile.hpp"
+#include "VBox/Casts.hpp"
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace VBox
+{
+    class MappedFile::IMPL
+    {
+        public:
+            
+            IMPL( const std::string & path );
+            IMPL( int fd );
+            ~IMPL( void );
+            
+            void _map( int fd );
+            
+            std::string _path;
+            uint8_t   * _data;
+            size_t      _size;
+    };
+    
+    MappedFile::MappedFile( const std::string & path ):
+        impl( std::make_unique< IMPL >( path ) )
+    {}
+    
+    MappedFile::MappedFile( int fd ):
+        impl( std::make_unique< IMPL >( fd ) )
+    {}
+    
+    MappedFile::~MappedFile( void )
+    {}
+    
+    std::string MappedFile::path( void ) const
+    {
+        return this->impl->_path;
+    }
+    
+    const uint8_t * MappedFile::data( void ) const
+    {
+        return this->impl->_data;
+    }
+    
+    size_t MappedFile::size( void ) const
+    {
+        return this->impl->_size;
+    }
+    
+    MappedFile::IMPL::IMPL( const std::string & path ):
+        _path( path ),
+        _data( nullptr ),
+        _size( 0 )
+    {
+        int fd( open( path.c_str(), O_RDONLY | O_CLOEXEC ) );
+        
+        if( fd == -1 )
+        {
+            throw std::runtime_error( "Cannot open file: " + path );
+        }
+        
+        try
+        {
+            this->_map( fd );
+        }
+        catch( ... )
+        {
+            close( fd );
+            
+            throw;
+        }
+        
+        close( fd );
+    }
+    
+    /*
+     * Maps an already open descriptor, such as an anonymous memory file.
+     * The descriptor is not closed and may be closed right away, as the
+     * mapping keeps its own reference.
+     */
+    MappedFile::IMPL::IMPL( int fd ):
+        _path( "/dev/fd/" + std::to_string( fd ) ),
+        _data( nullptr ),
+        _size( 0 )
+    {
+        this->_map( fd );
+    }
+    
+    void MappedFile::IMPL::_map( int fd )
+    {
+        struct stat st;
+        
+        if( fstat( fd, &st ) != 0 )
+        {
+            throw std::runtime_error( "Cannot stat file: " + this->_path );
+        }
+        
+        this->_size = numeric_cast< size_t >( st.st_size );
+        
+        if( this->_size > 0 )
+        {
+            void * p( mmap( nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0 ) );
+            
+            if( p == MAP_FAILED )
+            {
+                throw std::runtime_error( "Cannot map file: " + this->_path );
+            }
+            
+            this->_data = static_cast< uint8_t * >( p );
+        }
+    }
+    
+    MappedFile::IMPL::~IMPL( void )
+    {
+        if( this->_data != nullptr )
+        {
+            munmap( this->_data, this->_size );
+        }
+    }
+}
@@ -24,9 +24,16 @@
 
 #include "VBox/Monitor.hpp"
 #include "VBox/Manage.hpp"
+#include "VBox/Stats.hpp"
+#include "VBox/Pool.hpp"
+#include "VBox/ProcessWatcher.hpp"
+#include "VBox/VM/PartialCore.hpp"
 #include <mutex>
 #include <thread>
 #include <optional>
+#include <array>
+#include <deque>
+#include <condition_variable>
 
 namespace VBox
 {
@@ -34,28 +41,67 @@ namespace VBox
     {
         public:
             
-            IMPL( const std::string & vmName );
+            IMPL( const std::string & vmName, std::shared_ptr< VM::PageStore > pages, std::shared_ptr< Backend > backend );
             IMPL( const IMPL & o );
             IMPL( const IMPL & o, const std::lock_guard< std::recursive_mutex > & l );
             
             void _updateRegisters( void );
             void _updateStack( void );
+            void _captureMemory( void );
             void _updateMemory( void );
             void _updateLiveStatus( void );
+            void _notify( void );
+            void _wake( void );
+            void _record( Backoff & backoff, Backend::Error error );
+            void _wait( const SampleRate & rate, const Backoff & backoff, std::chrono::microseconds minimum = std::chrono::microseconds( 0 ) );
+            bool _stopping( void );
+            bool _capturing( void );
             
-            std::string                     _vmName;
-            std::optional< VM::Registers >  _registers;
-            std::vector< VM::StackEntry >   _stack;
-            std::shared_ptr< VM::CoreDump > _dump;
-            mutable std::recursive_mutex    _rmtx;
-            bool                            _running;
-            bool                            _stop;
-            bool                            _live;
-            std::vector< std::thread >      _threads;
+            Acquisition                                    _acquisition( void ) const;
+            std::vector< std::pair< uint64_t, uint64_t > > _interest( void )    const;
+            
+            static constexpr size_t                    captureDepth     = 1;
+            static constexpr std::chrono::milliseconds livePollInterval = std::chrono::milliseconds( 1000 );
+            static constexpr std::chrono::milliseconds liveWatchSlice   = std::chrono::milliseconds( 100 );
+            
+            std::string                                            _vmName;
+            std::shared_ptr< const VM::Registers >                 _registers;
+            std::shared_ptr< const VM::RegisterHistory >           _registerHistory;
+            std::shared_ptr< const std::vector< VM::StackEntry > > _stack;
+            VM::RegisterHistory                                    _history;
+            Pool< VM::Registers >                                  _registersPool;
+            Pool< VM::RegisterHistory >                            _registerHistoryPool;
+            Pool< std::vector< VM::StackEntry > >                  _stackPool;
+            std::shared_ptr< VM::CoreDump >                        _dump;
+            std::shared_ptr< VM::PageStore >                       _pages;
+            std::shared_ptr< Backend >                             _backend;
+            mutable std::recursive_mutex                           _rmtx;
+            bool                                                   _running;
+            bool                                                   _stop;
+            bool                                                   _live;
+            std::vector< std::thread >                             _threads;
+            std::deque< std::optional< ELF::File > >               _captured;
+            std::mutex                                             _captureMtx;
+            std::condition_variable                                _captureCondition;
+            std::map< uint64_t, std::pair< uint64_t, uint64_t > >  _subscriptions;
+            uint64_t                                               _nextSubscription;
+            uint64_t                                               _memorySize;
+            std::chrono::steady_clock::time_point                  _readRetry;
+            SampleRate                                             _registersRate;
+            SampleRate                                             _stackRate;
+            SampleRate                                             _memoryRate;
+            uint64_t                                               _wakeups;
+            Backoff                                                _registersBackoff;
+            Backoff                                                _stackBackoff;
+            Backoff                                                _memoryBackoff;
+            uint64_t                                               _liveChanges;
+            StopToken                                              _token;
+            
+            std::vector< std::function< void( void ) > > _onUpdate;
     };
     
-    Monitor::Monitor( const std::string & vmName ):
-        impl( std::make_unique< IMPL >( vmName ) )
+    Monitor::Monitor( const std::string & vmName, std::shared_ptr< VM::PageStore > pages, std::shared_ptr< Backend > backend ):
+        impl( std::make_unique< IMPL >( vmName, pages, backend ) )
     {}
     
     Monitor::Monitor( const Monitor & o ):
@@ -93,14 +139,25 @@ namespace VBox
         return this->impl->_live;
     }
     
-    std::optional< VM::Registers > Monitor::registers( void ) const
+    /*
+     * Snapshots are immutable once published, so they are shared rather
+     * than copied. A null pointer means registers are not available.
+     */
+    std::shared_ptr< const VM::Registers > Monitor::registers( void ) const
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
         return this->impl->_registers;
     }
     
-    std::vector< VM::StackEntry > Monitor::stack( void ) const
+    std::shared_ptr< const VM::RegisterHistory > Monitor::registerHistory( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return this->impl->_registerHistory;
+    }
+    
+    std::shared_ptr< const std::vector< VM::StackEntry > > Monitor::stack( void ) const
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
@@ -114,6 +171,61 @@ namespace VBox
         return this->impl->_dump;
     }
     
+    /*
+     * The guest's memory size, from its dumps or from the backend, or zero
+     * if it is not known yet. Dumps made of reads only cover part of it.
+     */
+    uint64_t Monitor::memorySize( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return this->impl->_memorySize;
+    }
+    
+    Monitor::Acquisition Monitor::acquisition( void ) const
+    {
+        return this->impl->_acquisition();
+    }
+    
+    std::vector< std::pair< uint64_t, uint64_t > > Monitor::interest( void ) const
+    {
+        return this->impl->_interest();
+    }
+    
+    /*
+     * How long a channel currently waits between samples. Channels that
+     * are not sampled adaptively have no interval.
+     */
+    std::chrono::microseconds Monitor::samplingInterval( Stats::Channel channel ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        switch( channel )
+        {
+            case Stats::Channel::Registers: return this->impl->_registersRate.interval();
+            case Stats::Channel::Stack:     return this->impl->_stackRate.interval();
+            case Stats::Channel::Memory:    return this->impl->_memoryRate.interval();
+            default:                        return std::chrono::microseconds( 0 );
+        }
+    }
+    
+    /*
+     * A copy of a channel's failure state. Channels that are not retried
+     * with a backoff never fail.
+     */
+    Backoff Monitor::backoff( Stats::Channel channel ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        switch( channel )
+        {
+            case Stats::Channel::Registers: return this->impl->_registersBackoff;
+            case Stats::Channel::Stack:     return this->impl->_stackBackoff;
+            case Stats::Channel::Memory:    return this->impl->_memoryBackoff;
+            default:                        return Backoff();
+        }
+    }
+    
     void Monitor::start( void )
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
@@ -125,20 +237,28 @@ namespace VBox
         
         this->impl->_stop    = false;
         this->impl->_running = true;
+        this->impl->_token   = StopToken();
         
         {
             std::thread t1( [ this ] { this->impl->_updateRegisters();  } );
             std::thread t2( [ this ] { this->impl->_updateStack(); } );
-            std::thread t3( [ this ] { this->impl->_updateMemory(); } );
-            std::thread t4( [ this ] { this->impl->_updateLiveStatus(); } );
+            std::thread t3( [ this ] { this->impl->_captureMemory(); } );
+            std::thread t4( [ this ] { this->impl->_updateMemory(); } );
+            std::thread t5( [ this ] { this->impl->_updateLiveStatus(); } );
             
             this->impl->_threads.push_back( std::move( t1 ) );
             this->impl->_threads.push_back( std::move( t2 ) );
             this->impl->_threads.push_back( std::move( t3 ) );
             this->impl->_threads.push_back( std::move( t4 ) );
+            this->impl->_threads.push_back( std::move( t5 ) );
         }
     }
     
+    /*
+     * Stopping the token kills the VBoxManage processes that are still
+     * running and interrupts console reads, so threads are joined without
+     * waiting for requests to complete.
+     */
     void Monitor::stop( void )
     {
         std::vector< std::thread > threads;
@@ -150,6 +270,16 @@ namespace VBox
             this->impl->_stop = true;
         }
         
+        this->impl->_token.requestStop();
+        
+        {
+            std::lock_guard< std::mutex > l( this->impl->_captureMtx );
+            
+            this->impl->_captured.clear();
+        }
+        
+        this->impl->_captureCondition.notify_all();
+        
         for( auto & t: threads )
         {
             t.join();
@@ -162,6 +292,110 @@ namespace VBox
         }
     }
     
+    void Monitor::onUpdate( const std::function< void( void ) > & f )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_onUpdate.push_back( f );
+    }
+    
+    void Monitor::sampling( std::chrono::microseconds floor, std::chrono::microseconds ceiling )
+    {
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            this->impl->_registersRate = SampleRate( floor, ceiling );
+            this->impl->_stackRate     = SampleRate( floor, ceiling );
+            this->impl->_memoryRate    = SampleRate( floor, ceiling );
+            
+            this->impl->_wakeups++;
+        }
+        
+        this->impl->_wake();
+    }
+    
+    /*
+     * The user is looking, so every channel goes back to its floor, and
+     * the ones waiting for their next sample are woken up.
+     */
+    void Monitor::interact( void )
+    {
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            this->impl->_registersRate.reset();
+            this->impl->_stackRate.reset();
+            this->impl->_memoryRate.reset();
+            
+            this->impl->_wakeups++;
+        }
+        
+        this->impl->_wake();
+    }
+    
+    uint64_t Monitor::subscribe( uint64_t address, uint64_t size )
+    {
+        uint64_t subscription;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            subscription = this->impl->_nextSubscription++;
+            
+            this->impl->_subscriptions[ subscription ] = { address, size };
+            
+            this->impl->_memoryRate.reset();
+            this->impl->_wakeups++;
+        }
+        
+        this->impl->_wake();
+        
+        return subscription;
+    }
+    
+    /*
+     * Called for every frame, so memory sampling only goes back to its
+     * floor when the range actually moves.
+     */
+    void Monitor::resubscribe( uint64_t subscription, uint64_t address, uint64_t size )
+    {
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            auto                                    i( this->impl->_subscriptions.find( subscription ) );
+            
+            if( i == this->impl->_subscriptions.end() )
+            {
+                throw std::runtime_error( "Invalid memory subscription" );
+            }
+            
+            if( i->second == std::make_pair( address, size ) )
+            {
+                return;
+            }
+            
+            i->second = { address, size };
+            
+            this->impl->_memoryRate.reset();
+            this->impl->_wakeups++;
+        }
+        
+        this->impl->_wake();
+    }
+    
+    void Monitor::unsubscribe( uint64_t subscription )
+    {
+        {
+            std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+            
+            this->impl->_subscriptions.erase( subscription );
+            
+            this->impl->_memoryRate.reset();
+            this->impl->_wakeups++;
+        }
+        
+        this->impl->_wake();
+    }
+    
     void swap( Monitor & o1, Monitor & o2 )
     {
         using std::swap;
@@ -176,13 +410,27 @@ namespace VBox
         }
     }
     
-    Monitor::IMPL::IMPL( const std::string & vmName ):
-        _vmName(         vmName ),
-        _running(        false ),
-        _stop(           false ),
-        _live(           false )
+    /*
+     * Without a backend, the one Manage uses at this point is kept.
+     */
+    Monitor::IMPL::IMPL( const std::string & vmName, std::shared_ptr< VM::PageStore > pages, std::shared_ptr< Backend > backend ):
+        _vmName(           vmName ),
+        _registerHistory(  std::make_shared< VM::RegisterHistory >() ),
+        _stack(            std::make_shared< std::vector< VM::StackEntry > >() ),
+        _pages(            pages ),
+        _backend(          ( backend != nullptr ) ? backend : Manage::backend() ),
+        _running(          false ),
+        _stop(             false ),
+        _live(             false ),
+        _nextSubscription( 1 ),
+        _memorySize(       0 ),
+        _registersRate(    samplingFloor, samplingCeiling ),
+        _stackRate(        samplingFloor, samplingCeiling ),
+        _memoryRate(       samplingFloor, samplingCeiling ),
+        _wakeups(          0 ),
+        _liveChanges(      0 )
     {
-        for( const auto & info: Manage::runningVMs() )
+        for( const auto & info: this->_backend->runningVMs( this->_token ) )
         {
             if( info.name() == vmName )
             {
@@ -196,17 +444,35 @@ namespace VBox
     {}
     
     Monitor::IMPL::IMPL( const IMPL & o, const std::lock_guard< std::recursive_mutex > & l ):
-        _vmName(         o._vmName ),
-        _registers(      o._registers ),
-        _stack(          o._stack ),
-        _dump(           o._dump ),
-        _running(        false ),
-        _stop(           false ),
-        _live(           false )
+        _vmName(           o._vmName ),
+        _registers(        o._registers ),
+        _registerHistory(  o._registerHistory ),
+        _stack(            o._stack ),
+        _history(          o._history ),
+        _dump(             o._dump ),
+        _pages(            o._pages ),
+        _backend(          o._backend ),
+        _running(          false ),
+        _stop(             false ),
+        _live(             false ),
+        _subscriptions(    o._subscriptions ),
+        _nextSubscription( o._nextSubscription ),
+        _memorySize(       o._memorySize ),
+        _readRetry(        o._readRetry ),
+        _registersRate(    o._registersRate.floor(), o._registersRate.ceiling() ),
+        _stackRate(        o._stackRate.floor(),     o._stackRate.ceiling() ),
+        _memoryRate(       o._memoryRate.floor(),    o._memoryRate.ceiling() ),
+        _wakeups(          0 ),
+        _liveChanges(      0 )
     {
         ( void )l;
     }
     
+    /*
+     * Samples are parsed into pooled objects, which are published as they
+     * are. Once the UI has dropped older snapshots, the pools hand them
+     * back, so steady-state sampling does not allocate new snapshots.
+     */
     void Monitor::IMPL::_updateRegisters( void )
     {
         while( 1 )
@@ -220,14 +486,62 @@ namespace VBox
                 }
             }
             
+            this->_wait( this->_registersRate, this->_registersBackoff );
+            
             {
-                std::optional< VM::Registers > regs( Manage::Debug::registers( this->_vmName ) );
+                std::shared_ptr< VM::Registers > regs( this->_registersPool.acquire() );
+                Backend::Error                   error( this->_backend->registers( this->_vmName, *( regs ), this->_token ) );
+                bool                             ok( error == Backend::Error::None );
+                uint64_t                         hash( ( ok ) ? SampleRate::hash( regs.get(), sizeof( VM::Registers ) ) : 0 );
+                
+                this->_record( this->_registersBackoff, error );
                 
                 {
+                    Stats::Scope                            scope( Stats::Channel::Registers, Stats::Stage::Publish );
                     std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                    bool                                    settled( this->_history.settled() );
+                    bool                                    same;
+                    
+                    /*
+                     * Change highlights fade over samples, so registers are
+                     * sampled at full rate until the history has settled.
+                     */
+                    if( this->_registersRate.sample( hash ) == false && settled == false )
+                    {
+                        this->_registersRate.reset();
+                    }
+                    
+                    if( ok )
+                    {
+                        Stats::shared().reach( Stats::Milestone::FirstSample );
+                        this->_history.add( *( regs ) );
+                        
+                        same = this->_registers != nullptr && *( this->_registers ) == *( regs );
+                    }
+                    else
+                    {
+                        same = this->_registers == nullptr;
+                    }
+                    
+                    if( same && settled )
+                    {
+                        continue;
+                    }
                     
-                    this->_registers = regs;
+                    if( same == false )
+                    {
+                        this->_registers = ( ok ) ? regs : nullptr;
+                    }
+                    
+                    {
+                        std::shared_ptr< VM::RegisterHistory > history( this->_registerHistoryPool.acquire() );
+                        
+                        *( history )           = this->_history;
+                        this->_registerHistory = history;
+                    }
                 }
+                
+                this->_notify();
             }
         }
     }
@@ -245,69 +559,460 @@ namespace VBox
                 }
             }
             
+            this->_wait( this->_stackRate, this->_stackBackoff );
+            
             {
-                std::vector< VM::StackEntry > stack( Manage::Debug::stack( this->_vmName ) );
+                std::shared_ptr< std::vector< VM::StackEntry > > stack( this->_stackPool.acquire() );
+                
+                this->_record( this->_stackBackoff, this->_backend->stack( this->_vmName, *( stack ), this->_token ) );
                 
                 {
+                    Stats::Scope                            scope( Stats::Channel::Stack, Stats::Stage::Publish );
                     std::lock_guard< std::recursive_mutex > l( this->_rmtx );
                     
+                    this->_stackRate.sample( SampleRate::hash( stack->data(), stack->size() * sizeof( VM::StackEntry ) ) );
+                    
+                    if( *( stack ) == *( this->_stack ) )
+                    {
+                        continue;
+                    }
+                    
                     this->_stack = stack;
                 }
+                
+                this->_notify();
+            }
+        }
+    }
+    
+    /*
+     * Memory is captured as a pipeline: this thread produces dumps while
+     * _updateMemory() parses and publishes the previous one, so a refresh
+     * costs the slowest stage rather than the sum of both. Two dump targets
+     * are used in turn, so the one being parsed is never overwritten, and
+     * capture waits while captureDepth dumps are already queued.
+     */
+    /*
+     * Reads are cheap enough to repeat back to back, so they are paced to
+     * at least readInterval. After a failed read, memory is dumped for
+     * readRetry, as the backend may not be able to read at all. That is
+     * only counted as a failure when the backend can read.
+     */
+    void Monitor::IMPL::_captureMemory( void )
+    {
+        std::array< std::unique_ptr< VM::DumpTarget >, 2 > targets;
+        size_t                                             next( 0 );
+        VM::PartialCore                                    core;
+        bool                                               sized( false );
+        
+        while( 1 )
+        {
+            {
+                std::unique_lock< std::mutex > l( this->_captureMtx );
+                
+                this->_captureCondition.wait( l, [ this ] { return ( this->_captured.size() < captureDepth && this->_capturing() ) || this->_stopping(); } );
+            }
+            
+            if( this->_stopping() )
+            {
+                return;
+            }
+            
+            {
+                std::optional< ELF::File > elf;
+                Acquisition                acquisition( this->_acquisition() );
+                Backend::Error             error( Backend::Error::Failed );
+                
+                if( acquisition == Acquisition::Read )
+                {
+                    try
+                    {
+                        error = this->_backend->read( this->_vmName, this->_interest(), core, this->_token );
+                        
+                        if( error == Backend::Error::None && core.size() > 0 )
+                        {
+                            elf = core.file();
+                        }
+                    }
+                    catch( ... )
+                    {
+                        error = Backend::Error::Output;
+                    }
+                    
+                    if( error != Backend::Error::None )
+                    {
+                        {
+                            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                            
+                            this->_readRetry = std::chrono::steady_clock::now() + readRetry;
+                        }
+                        
+                        if( error != Backend::Error::Unsupported )
+                        {
+                            this->_record( this->_memoryBackoff, error );
+                        }
+                        
+                        continue;
+                    }
+                    
+                    /*
+                     * No range came back, so there is nothing to replace
+                     * the current dump with.
+                     */
+                    if( elf.has_value() == false )
+                    {
+                        this->_record( this->_memoryBackoff, error );
+                        
+                        {
+                            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                            
+                            this->_memoryRate.update( false );
+                        }
+                        
+                        this->_wait( this->_memoryRate, this->_memoryBackoff, readInterval );
+                        
+                        continue;
+                    }
+                    
+                    if( sized == false )
+                    {
+                        uint64_t size( this->_backend->memorySize( this->_vmName, this->_token ) );
+                        
+                        {
+                            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                            
+                            this->_memorySize = std::max( this->_memorySize, size );
+                        }
+                        
+                        sized = true;
+                    }
+                }
+                else
+                {
+                    try
+                    {
+                        if( targets[ next ] == nullptr )
+                        {
+                            targets[ next ] = std::make_unique< VM::DumpTarget >();
+                        }
+                        else
+                        {
+                            targets[ next ]->reset();
+                        }
+                        
+                        error = this->_backend->capture( this->_vmName, *( targets[ next ] ), elf, this->_token );
+                    }
+                    catch( ... )
+                    {
+                        targets[ next ] = nullptr;
+                    }
+                    
+                    next = ( next + 1 ) % targets.size();
+                }
+                
+                this->_record( this->_memoryBackoff, error );
+                
+                {
+                    std::lock_guard< std::mutex > l( this->_captureMtx );
+                    
+                    this->_captured.push_back( std::move( elf ) );
+                }
+                
+                this->_captureCondition.notify_all();
+                
+                this->_wait( this->_memoryRate, this->_memoryBackoff, ( acquisition == Acquisition::Read ) ? readInterval : std::chrono::microseconds( 0 ) );
             }
         }
     }
     
+    /*
+     * Each dump is indexed against the last one that was indexed, so a
+     * failed capture does not make every page look changed, and the last
+     * dump stays published until a capture succeeds again. Memory is
+     * sampled less often while no page changes; page hashes are already
+     * computed for the index, so nothing else is hashed.
+     */
     void Monitor::IMPL::_updateMemory( void )
     {
-        #ifdef __clang__
-        #pragma clang diagnostic push
-        #pragma clang diagnostic ignored "-Wdeprecated-declarations"
-        #endif
-        std::string tmp( std::tmpnam( nullptr ) );
-        #ifdef __clang__
-        #pragma clang diagnostic pop
-        #endif
+        std::shared_ptr< const VM::PageIndex > previous;
         
         while( 1 )
         {
+            std::optional< ELF::File > elf;
+            
             {
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+                std::unique_lock< std::mutex > l( this->_captureMtx );
                 
-                if( this->_stop )
+                this->_captureCondition.wait( l, [ this ] { return this->_captured.size() > 0 || this->_stopping(); } );
+                
+                if( this->_captured.size() == 0 )
                 {
                     return;
                 }
+                
+                elf = std::move( this->_captured.front() );
+                
+                this->_captured.pop_front();
             }
             
+            this->_captureCondition.notify_all();
+            
             {
-                std::shared_ptr< VM::CoreDump > dump( Manage::Debug::dump( this->_vmName, tmp ) );
+                std::shared_ptr< VM::CoreDump > dump;
                 
+                if( elf.has_value() )
                 {
+                    Stats::Scope scope( Stats::Channel::Memory, Stats::Stage::Parse );
+                    
+                    try
+                    {
+                        dump = std::make_shared< VM::CoreDump >( elf.value(), this->_pages );
+                    }
+                    catch( ... )
+                    {}
+                    
+                    elf.reset();
+                }
+                
+                bool changed( false );
+                
+                if( dump != nullptr )
+                {
+                    Stats::Scope scope( Stats::Channel::Memory, Stats::Stage::Index );
+                    
+                    try
+                    {
+                        dump->buildPageIndex( previous );
+                        
+                        changed  = previous == nullptr || dump->pageIndex()->changedPages() > 0 || dump->pageIndex()->pages() != previous->pages();
+                        previous = dump->pageIndex();
+                    }
+                    catch( ... )
+                    {
+                        changed = true;
+                    }
+                }
+                
+                {
+                    Stats::Scope                            scope( Stats::Channel::Memory, Stats::Stage::Publish );
                     std::lock_guard< std::recursive_mutex > l( this->_rmtx );
                     
-                    this->_dump = dump;
+                    this->_memoryRate.update( changed );
+                    
+                    if( dump != nullptr )
+                    {
+                        this->_dump       = dump;
+                        this->_memorySize = std::max( this->_memorySize, dump->memorySize() );
+                    }
+                }
+                
+                if( dump != nullptr )
+                {
+                    this->_notify();
                 }
             }
         }
     }
     
-    void Monitor::IMPL::_updateLiveStatus( void )
+    Monitor::Acquisition Monitor::IMPL::_acquisition( void ) const
     {
-        while( 1 )
+        uint64_t size( 0 );
+        
+        for( const auto & range: this->_interest() )
         {
+            size += range.second;
+        }
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            if( this->_subscriptions.size() == 0 )
             {
-                std::lock_guard< std::recursive_mutex > l( this->_rmtx );
-                
-                if( this->_stop )
+                return Acquisition::None;
+            }
+            
+            if( size > readLimit || std::chrono::steady_clock::now() < this->_readRetry )
+            {
+                return Acquisition::Dump;
+            }
+            
+            return Acquisition::Read;
+        }
+    }
+    
+    /*
+     * The subscribed ranges, sorted, with overlapping and adjacent ones
+     * merged.
+     */
+    std::vector< std::pair< uint64_t, uint64_t > > Monitor::IMPL::_interest( void ) const
+    {
+        std::vector< std::pair< uint64_t, uint64_t > > ranges;
+        std::vector< std::pair< uint64_t, uint64_t > > merged;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            for( const auto & p: this->_subscriptions )
+            {
+                ranges.push_back( p.second );
+            }
+        }
+        
+        std::sort( ranges.begin(), ranges.end() );
+        
+        for( const auto & range: ranges )
+        {
+            if( merged.size() > 0 && range.first <= merged.back().first + merged.back().second )
+            {
+                merged.back().second = std::max( merged.back().second, range.first + range.second - merged.back().first );
+            }
+            else
+            {
+                merged.push_back( range );
+            }
+        }
+        
+        return merged;
+    }
+    
+    /*
+     * Used by the capture predicates, with the capture mutex held. This is
+     * safe because the recursive mutex is never held while taking the
+     * capture mutex.
+     */
+    bool Monitor::IMPL::_stopping( void )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+        
+        return this->_stop;
+    }
+    
+    /*
+     * Like _stopping(), used by the capture predicates. Dumps are only
+     * taken while some memory is subscribed to.
+     */
+    bool Monitor::IMPL::_capturing( void )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+        
+        return this->_subscriptions.size() > 0;
+    }
+    
+    /*
+     * The capture mutex is taken so a thread checking its predicate
+     * cannot miss the change.
+     */
+    void Monitor::IMPL::_wake( void )
+    {
+        {
+            std::lock_guard< std::mutex > l( this->_captureMtx );
+        }
+        
+        this->_captureCondition.notify_all();
+    }
+    
+    /*
+     * Failures are published right away, as they do not change samples
+     * and would not show otherwise. Cancelled requests are not failures.
+     */
+    void Monitor::IMPL::_record( Backoff & backoff, Backend::Error error )
+    {
+        if( error == Backend::Error::Cancelled )
+        {
+            return;
+        }
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            backoff.record( error );
+        }
+        
+        if( error != Backend::Error::None )
+        {
+            this->_notify();
+        }
+    }
+    
+    /*
+     * Waits for a channel's current interval, or minimum if it is longer,
+     * on the capture condition like the other waits. Stopping, a change
+     * of subscriptions and user interaction end the wait early.
+     * A failing channel waits for its backoff delay instead, which only
+     * stopping and a change of liveness end early, so it is not retried
+     * on every key press.
+     */
+    void Monitor::IMPL::_wait( const SampleRate & rate, const Backoff & backoff, std::chrono::microseconds minimum )
+    {
+        std::chrono::microseconds interval;
+        const uint64_t          * counter;
+        uint64_t                  wakeups;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            if( backoff.delay().count() > 0 )
+            {
+                interval = backoff.delay();
+                counter  = &( this->_liveChanges );
+            }
+            else
+            {
+                interval = std::max( rate.interval(), minimum );
+                counter  = &( this->_wakeups );
+            }
+            
+            wakeups = *( counter );
+        }
+        
+        if( interval.count() == 0 )
+        {
+            return;
+        }
+        
+        {
+            std::unique_lock< std::mutex > l( this->_captureMtx );
+            
+            this->_captureCondition.wait_for
+            (
+                l,
+                interval,
+                [ & ]
                 {
-                    return;
+                    std::lock_guard< std::recursive_mutex > l2( this->_rmtx );
+                    
+                    return this->_stop || *( counter ) != wakeups;
                 }
-            }
+            );
+        }
+    }
+    
+    /*
+     * Listing running VMs means a VBoxManage process each time, so once
+     * the VM is seen running, its host process is watched for exit
+     * instead. The list is only polled, and slowly, while the VM is not
+     * running or when its process cannot be found.
+     */
+    void Monitor::IMPL::_updateLiveStatus( void )
+    {
+        std::unique_ptr< ProcessWatcher > watcher;
+        
+        while( this->_stopping() == false )
+        {
+            bool live( false );
             
+            if( watcher != nullptr )
             {
-                bool live( false );
+                if( watcher->wait( liveWatchSlice, this->_token ) == false )
+                {
+                    continue;
+                }
                 
-                for( const auto & info: Manage::runningVMs() )
+                watcher.reset();
+            }
+            else
+            {
+                for( const auto & info: this->_backend->runningVMs( this->_token ) )
                 {
                     if( info.name() == this->_vmName )
                     {
@@ -315,12 +1020,66 @@ namespace VBox
                     }
                 }
                 
+                if( live )
+                {
+                    std::optional< pid_t > pid( this->_backend->hostProcess( this->_vmName, this->_token ) );
+                    
+                    if( pid.has_value() )
+                    {
+                        watcher = std::make_unique< ProcessWatcher >( pid.value() );
+                    }
+                }
+            }
+            
+            {
+                bool changed( false );
+                
                 {
+                    Stats::Scope                            scope( Stats::Channel::Live, Stats::Stage::Publish );
                     std::lock_guard< std::recursive_mutex > l( this->_rmtx );
                     
+                    changed     = live != this->_live;
                     this->_live = live;
+                    
+                    if( changed )
+                    {
+                        this->_registersBackoff.close();
+                        this->_stackBackoff.close();
+                        this->_memoryBackoff.close();
+                        
+                        this->_liveChanges++;
+                    }
+                }
+                
+                if( changed )
+                {
+                    this->_wake();
+                    this->_notify();
                 }
             }
+            
+            if( watcher == nullptr )
+            {
+                std::unique_lock< std::mutex > l( this->_captureMtx );
+                
+                this->_captureCondition.wait_for( l, livePollInterval, [ this ] { return this->_stopping(); } );
+            }
+        }
+    }
+    
+    void Monitor::IMPL::_notify( void )
+    {
+        std::vector< std::function< void( void ) > > onUpdate;
+        
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            onUpdate = this->_onUpdate;
+        }
+        
+        for( const auto & f: onUpdate )
+        {
+            f();
         }
     }
 }
@@ -31,9 +31,16 @@
 #include <chrono>
 #include <vector>
 #include <optional>
+#include <functional>
+#include <map>
 #include "VBox/VM/Registers.hpp"
+#include "VBox/VM/RegisterHistory.hpp"
 #include "VBox/VM/StackEntry.hpp"
 #include "VBox/VM/CoreDump.hpp"
+#include "VBox/Backend.hpp"
+#include "VBox/SampleRate.hpp"
+#include "VBox/Backoff.hpp"
+#include "VBox/Stats.hpp"
 
 namespace VBox
 {
@@ -41,21 +48,61 @@ namespace VBox
     {
         public:
             
-            Monitor( const std::string & vmName );
+            /*
+             * How guest memory is acquired for the current subscriptions.
+             * Nothing is captured while no range is subscribed to. Up to
+             * readLimit bytes of interest are read from the backend, when
+             * it can; more than that, or when reads fail, the guest is
+             * dumped.
+             */
+            enum class Acquisition
+            {
+                None,
+                Read,
+                Dump
+            };
+            
+            static constexpr uint64_t                  readLimit    = 1024 * 1024;
+            static constexpr std::chrono::milliseconds readInterval = std::chrono::milliseconds( 33 );
+            static constexpr std::chrono::milliseconds readRetry    = std::chrono::milliseconds( 10000 );
+            
+            /*
+             * Registers, stack and memory are sampled back to back while
+             * they change, and less and less often while they do not, up
+             * to the ceiling. See SampleRate.
+             */
+            static constexpr std::chrono::milliseconds samplingFloor   = std::chrono::milliseconds( 0 );
+            static constexpr std::chrono::milliseconds samplingCeiling = std::chrono::milliseconds( 1000 );
+            
+            Monitor( const std::string & vmName, std::shared_ptr< VM::PageStore > pages = nullptr, std::shared_ptr< Backend > backend = nullptr );
             Monitor( const Monitor & o );
             Monitor( Monitor && o );
             ~Monitor( void );
             
             Monitor & operator =( Monitor o );
             
-            bool                            live( void )      const;
-            std::optional< VM::Registers >  registers( void ) const;
-            std::vector< VM::StackEntry >   stack( void )     const;
-            std::shared_ptr< VM::CoreDump > dump( void )      const;
+            bool                                                   live( void )            const;
+            std::shared_ptr< const VM::Registers >                 registers( void )       const;
+            std::shared_ptr< const VM::RegisterHistory >           registerHistory( void ) const;
+            std::shared_ptr< const std::vector< VM::StackEntry > > stack( void )           const;
+            std::shared_ptr< VM::CoreDump >                        dump( void )            const;
+            uint64_t                                               memorySize( void )      const;
+            Acquisition                                            acquisition( void )     const;
+            std::vector< std::pair< uint64_t, uint64_t > >         interest( void )        const;
+            std::chrono::microseconds                              samplingInterval( Stats::Channel channel ) const;
+            Backoff                                                backoff( Stats::Channel channel )          const;
             
             void start( void );
             void stop( void );
             
+            void onUpdate( const std::function< void( void ) > & f );
+            void sampling( std::chrono::microseconds floor, std::chrono::microseconds ceiling );
+            void interact( void );
+            
+            uint64_t subscribe( uint64_t address, uint64_t size );
+            void     resubscribe( uint64_t subscription, uint64_t address, uint64_t size );
+            void     unsubscribe( uint64_t subscription );
+            
             friend void swap( Monitor & o1, Monitor & o2 );
             
         private:
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_POOL_HPP
+#define VBOX_POOL_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VBox
+{
+    /*
+     * Recycles objects that are published as shared snapshots. The pool
+     * keeps a reference to every object it created, and acquire() returns
+     * one that nobody else references anymore, creating a new one only
+     * when all are in use. Once readers have let go of old snapshots, no
+     * allocation takes place.
+     * Recycled objects keep their previous contents (and capacity), and
+     * are meant to be overwritten.
+     */
+    template< typename _T_ >
+    class Pool
+    {
+        public:
+            
+            Pool( void )
+            {}
+            
+            Pool( const Pool & o )              = delete;
+            Pool( Pool && o )                   = delete;
+            Pool & operator =( const Pool & o ) = delete;
+            Pool & operator =( Pool && o )      = delete;
+            
+            size_t size( void ) const
+            {
+                std::lock_guard< std::mutex > l( this->_mtx );
+                
+                return this->_objects.size();
+            }
+            
+            /*
+             * Only the pool hands out references, under its lock, so an
+             * object whose only reference is the pool's stays free. The
+             * fence orders our writes after the last reader's release.
+             */
+            std::shared_ptr< _T_ > acquire( void )
+            {
+                std::lock_guard< std::mutex > l( this->_mtx );
+                
+                for( const auto & object: this->_objects )
+                {
+                    if( object.use_count() == 1 )
+                    {
+                        std::atomic_thread_fence( std::memory_order_acquire );
+                        
+                        return object;
+                    }
+                }
+                
+                this->_objects.push_back( std::make_shared< _T_ >() );
+                
+                return this->_objects.back();
+            }
+            
+        private:
+            
+            mutable std::mutex                    _mtx;
+            std::vector< std::shared_ptr< _T_ > > _objects;
+    };
+}
+
+#endif /* VBOX_POOL_HPP */
@@ -24,6 +24,25 @@
 
 #include "VBox/Process.hpp"
 #include <unistd.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#ifdef __APPLE__
+#include <sys/event.h>
+#endif
 
 namespace VBox
 {
@@ -32,16 +51,30 @@ namespace VBox
         public:
             
             IMPL( const std::string & path, const std::vector< std::string > & args, const std::vector< std::string > & env );
+            ~IMPL( void );
+            
+            bool _wait( std::chrono::steady_clock::time_point deadline, const StopToken * token );
+            bool _reap( bool block );
+            void _drain( void );
+            void _poll( std::chrono::steady_clock::duration timeout, int interrupt );
+            void _kill( int signal );
             
-            std::string                  _path;
-            std::vector< std::string >   _args;
-            std::vector< std::string >   _env;
-            std::optional< pid_t >       _pid;
-            std::optional< int >         _terminationStatus;
-            std::optional< std::string > _output;
-            std::optional< std::string > _error;
-            int                          _fdOut[ 2 ];
-            int                          _fdErr[ 2 ];
+            static constexpr std::chrono::milliseconds probeInterval = std::chrono::milliseconds( 10 );
+            
+            std::string                               _path;
+            std::vector< std::string >                _args;
+            std::vector< std::string >                _env;
+            std::optional< pid_t >                    _pid;
+            std::optional< int >                      _terminationStatus;
+            std::string                               _output;
+            std::string                               _error;
+            bool                                      _timedOut;
+            std::chrono::steady_clock::time_point     _start;
+            std::optional< std::chrono::nanoseconds > _wallTime;
+            std::optional< std::chrono::nanoseconds > _cpuTime;
+            int                                       _fdOut[ 2 ];
+            int                                       _fdErr[ 2 ];
+            int                                       _fd;
     };
 
     Process::Process( const std::string & path, const std::vector< std::string > & args, const std::vector< std::string > & env ):
@@ -49,13 +82,7 @@ namespace VBox
     {}
 
     Process::~Process( void )
-    {
-        if( this->impl->_terminationStatus.has_value() )
-        {
-            close( this->impl->_fdOut[ 0 ] );
-            close( this->impl->_fdErr[ 0 ] );
-        }
-    }
+    {}
 
     std::vector< std::string > Process::arguments( void ) const
     {
@@ -87,6 +114,29 @@ namespace VBox
         return this->impl->_terminationStatus;
     }
 
+    bool Process::timedOut( void ) const
+    {
+        return this->impl->_timedOut;
+    }
+
+    std::optional< std::chrono::nanoseconds > Process::wallTime( void ) const
+    {
+        return this->impl->_wallTime;
+    }
+
+    std::optional< std::chrono::nanoseconds > Process::cpuTime( void ) const
+    {
+        return this->impl->_cpuTime;
+    }
+
+    /*
+     * The child is spawned rather than forked, so starting it does not
+     * copy the page tables of this process, which holds memory dumps and
+     * may take several milliseconds to fork. A child that cannot be
+     * executed terminates with status 127, as after a failed exec.
+     * The child's exit is watched through a pidfd on Linux, or a kqueue
+     * on macOS. Elsewhere, waits poll for it every probeInterval.
+     */
     void Process::start( void )
     {
         if( this->impl->_pid.has_value() )
@@ -99,128 +149,371 @@ namespace VBox
             throw std::runtime_error( "Cannot create pipe" );
         }
         
-        this->impl->_pid = fork();
-        
-        if( this->impl->_pid.value() == -1 )
+        for( int fd: { this->impl->_fdOut[ 0 ], this->impl->_fdOut[ 1 ], this->impl->_fdErr[ 0 ], this->impl->_fdErr[ 1 ] } )
         {
-            throw std::runtime_error( "Cannot fork process" );
+            fcntl( fd, F_SETFD, FD_CLOEXEC );
         }
-        else if( this->impl->_pid.value() > 0 )
-        {
-            close( this->impl->_fdOut[ 1 ] );
-            close( this->impl->_fdErr[ 1 ] );
-        }
-        else if( this->impl->_pid.value() == 0 )
+        
         {
-            std::vector< char * > args;
-            std::vector< char * > env;
-            
-            dup2(  this->impl->_fdOut[ 1 ], STDOUT_FILENO );
-            close( this->impl->_fdOut[ 0 ] );
-            close( this->impl->_fdOut[ 1 ] );
-            
-            dup2(  this->impl->_fdErr[ 1 ], STDERR_FILENO );
-            close( this->impl->_fdErr[ 0 ] );
-            close( this->impl->_fdErr[ 1 ] );
+            std::vector< char * >      args;
+            posix_spawnattr_t          attributes;
+            posix_spawn_file_actions_t actions;
+            pid_t                      pid;
+            int                        error;
             
-            args.push_back( strdup( this->impl->_path.c_str() ) );
+            args.push_back( const_cast< char * >( this->impl->_path.c_str() ) );
             
             for( const auto & s: this->impl->_args )
             {
-                args.push_back( strdup( s.c_str() ) );
+                args.push_back( const_cast< char * >( s.c_str() ) );
             }
             
             for( const auto & s: this->impl->_env )
             {
-                args.push_back( strdup( s.c_str() ) );
+                args.push_back( const_cast< char * >( s.c_str() ) );
             }
             
             args.push_back( nullptr );
-            env.push_back( nullptr );
             
-            execve( this->impl->_path.c_str(), &( args[ 0 ] ), &( args[ 0 ] ) );
+            posix_spawnattr_init( &attributes );
+            posix_spawnattr_setflags( &attributes, POSIX_SPAWN_SETPGROUP );
+            posix_spawnattr_setpgroup( &attributes, 0 );
             
-            for( auto cp: args )
+            posix_spawn_file_actions_init( &actions );
+            posix_spawn_file_actions_adddup2( &actions, this->impl->_fdOut[ 1 ], STDOUT_FILENO );
+            posix_spawn_file_actions_adddup2( &actions, this->impl->_fdErr[ 1 ], STDERR_FILENO );
+            
+            this->impl->_start = std::chrono::steady_clock::now();
+            error              = posix_spawn( &pid, this->impl->_path.c_str(), &actions, &attributes, &( args[ 0 ] ), &( args[ 0 ] ) );
+            
+            posix_spawn_file_actions_destroy( &actions );
+            posix_spawnattr_destroy( &attributes );
+            
+            close( this->impl->_fdOut[ 1 ] );
+            close( this->impl->_fdErr[ 1 ] );
+            
+            this->impl->_fdOut[ 1 ] = -1;
+            this->impl->_fdErr[ 1 ] = -1;
+            
+            if( error == EAGAIN || error == ENOMEM )
+            {
+                throw std::runtime_error( "Cannot spawn process" );
+            }
+            else if( error != 0 )
             {
-                free( cp );
+                this->impl->_pid               = 0;
+                this->impl->_terminationStatus = 127 << 8;
+                this->impl->_wallTime          = std::chrono::steady_clock::now() - this->impl->_start;
+                this->impl->_cpuTime           = std::chrono::nanoseconds( 0 );
+                
+                return;
             }
             
-            for( auto cp: env )
+            this->impl->_pid = pid;
+        }
+        
+        fcntl( this->impl->_fdOut[ 0 ], F_SETFL, fcntl( this->impl->_fdOut[ 0 ], F_GETFL ) | O_NONBLOCK );
+        fcntl( this->impl->_fdErr[ 0 ], F_SETFL, fcntl( this->impl->_fdErr[ 0 ], F_GETFL ) | O_NONBLOCK );
+        
+        #if defined( __linux__ ) && defined( SYS_pidfd_open )
+        
+        this->impl->_fd = static_cast< int >( syscall( SYS_pidfd_open, this->impl->_pid.value(), 0 ) );
+        
+        #elif defined( __APPLE__ )
+        
+        this->impl->_fd = kqueue();
+        
+        if( this->impl->_fd != -1 )
+        {
+            struct kevent event;
+            
+            EV_SET( &event, this->impl->_pid.value(), EVFILT_PROC, EV_ADD | EV_ONESHOT, NOTE_EXIT, 0, nullptr );
+            
+            if( kevent( this->impl->_fd, &event, 1, nullptr, 0, nullptr ) == -1 )
             {
-                free( cp );
+                close( this->impl->_fd );
+                
+                this->impl->_fd = -1;
             }
         }
+        
+        #endif
+        
+        if( this->impl->_fd != -1 )
+        {
+            fcntl( this->impl->_fd, F_SETFD, FD_CLOEXEC );
+        }
     }
 
     void Process::waitUntilExit( void )
     {
-        int status;
-        
-        if( this->impl->_pid.has_value() == false || this->impl->_pid.value() <= 0 )
+        this->waitFor( std::chrono::steady_clock::time_point::max() );
+    }
+
+    /*
+     * Stopping the token kills the child's process group right away, so
+     * the wait returns as soon as it is reaped.
+     */
+    void Process::waitUntilExit( const StopToken & token )
+    {
+        this->waitFor( std::chrono::steady_clock::time_point::max(), token );
+    }
+
+    /*
+     * Returns whether the child exited by itself, before the deadline.
+     * Either way, it has exited and been reaped on return.
+     */
+    bool Process::waitFor( std::chrono::steady_clock::time_point deadline )
+    {
+        return this->impl->_wait( deadline, nullptr );
+    }
+
+    bool Process::waitFor( std::chrono::steady_clock::time_point deadline, const StopToken & token )
+    {
+        return this->impl->_wait( deadline, &token );
+    }
+
+    std::optional< std::string > Process::output( void ) const
+    {
+        if( this->impl->_terminationStatus.has_value() == false )
         {
-            throw std::runtime_error( "Process is not running" );
+            return {};
         }
         
-        waitpid( this->impl->_pid.value(), &status, 0 );
+        this->impl->_drain();
         
-        this->impl->_terminationStatus = status;
+        return this->impl->_output;
     }
 
-    std::optional< std::string > Process::output( void ) const
+    std::optional< std::string > Process::error( void ) const
     {
         if( this->impl->_terminationStatus.has_value() == false )
         {
             return {};
         }
         
-        if( this->impl->_output.has_value() )
+        this->impl->_drain();
+        
+        return this->impl->_error;
+    }
+
+    Process::IMPL::IMPL( const std::string & path, const std::vector< std::string > & args, const std::vector< std::string > & env ):
+        _path(     path ),
+        _args(     args ),
+        _env(      env ),
+        _timedOut( false ),
+        _fdOut{    -1, -1 },
+        _fdErr{    -1, -1 },
+        _fd(       -1 )
+    {}
+
+    Process::IMPL::~IMPL( void )
+    {
+        for( int fd: { this->_fdOut[ 0 ], this->_fdOut[ 1 ], this->_fdErr[ 0 ], this->_fdErr[ 1 ], this->_fd } )
+        {
+            if( fd != -1 )
+            {
+                close( fd );
+            }
+        }
+    }
+
+    /*
+     * Output is drained on every wakeup, and the child is checked for
+     * exit after that, so nothing it wrote before exiting is lost.
+     */
+    bool Process::IMPL::_wait( std::chrono::steady_clock::time_point deadline, const StopToken * token )
+    {
+        int  interrupt( ( token != nullptr ) ? token->fd() : -1 );
+        bool terminated( false );
+        
+        if( this->_terminationStatus.has_value() )
         {
-            return this->impl->_output.value();
+            return this->_timedOut == false;
+        }
+        
+        if( this->_pid.has_value() == false || this->_pid.value() <= 0 )
+        {
+            throw std::runtime_error( "Process is not running" );
         }
         
-        std::string out;
-        char        buf[ 1024 ];
-        ssize_t     n;
+        while( true )
+        {
+            std::chrono::steady_clock::time_point now;
+            
+            this->_drain();
+            
+            if( this->_reap( false ) )
+            {
+                return terminated == false;
+            }
+            
+            if( token != nullptr && token->stopRequested() )
+            {
+                this->_kill( SIGKILL );
+                this->_reap( true );
+                
+                return false;
+            }
+            
+            now = std::chrono::steady_clock::now();
+            
+            if( now >= deadline && terminated )
+            {
+                this->_kill( SIGKILL );
+                this->_reap( true );
+                
+                return false;
+            }
+            else if( now >= deadline )
+            {
+                this->_kill( SIGTERM );
+                
+                terminated      = true;
+                deadline        = now + killDelay;
+                this->_timedOut = true;
+                
+                continue;
+            }
+            
+            this->_poll( deadline - now, interrupt );
+        }
+    }
+
+    /*
+     * A child that cannot be waited for, as it was reaped elsewhere, is
+     * reported as failed.
+     */
+    bool Process::IMPL::_reap( bool block )
+    {
+        int           status( -1 );
+        struct rusage usage;
+        pid_t         pid;
+        
+        memset( &usage, 0, sizeof( usage ) );
+        
+        do
+        {
+            pid = wait4( this->_pid.value(), &status, ( block ) ? 0 : WNOHANG, &usage );
+        }
+        while( pid == -1 && errno == EINTR );
         
-        while( ( n = read( this->impl->_fdOut[ 0 ], buf, sizeof( buf ) ) ) > 0 )
+        if( pid == 0 )
         {
-            out += buf;
+            return false;
         }
         
-        this->impl->_output = out;
+        this->_terminationStatus = ( pid == -1 ) ? -1 : status;
+        this->_wallTime          = std::chrono::steady_clock::now() - this->_start;
+        this->_cpuTime           = std::chrono::seconds( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) + std::chrono::microseconds( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec );
+        
+        if( this->_fd != -1 )
+        {
+            close( this->_fd );
+            
+            this->_fd = -1;
+        }
         
-        return out;
+        return true;
     }
 
-    std::optional< std::string > Process::error( void ) const
+    /*
+     * Reads whatever is available without blocking. A pipe is closed
+     * once the child and anything it started have closed it.
+     */
+    void Process::IMPL::_drain( void )
     {
-        if( this->impl->_terminationStatus.has_value() == false )
+        for( auto p: { std::make_pair( this->_fdOut, &( this->_output ) ), std::make_pair( this->_fdErr, &( this->_error ) ) } )
         {
-            return {};
+            char    buf[ 4096 ];
+            ssize_t n;
+            
+            if( p.first[ 0 ] == -1 )
+            {
+                continue;
+            }
+            
+            while( ( n = read( p.first[ 0 ], buf, sizeof( buf ) ) ) > 0 || ( n == -1 && errno == EINTR ) )
+            {
+                if( n > 0 )
+                {
+                    p.second->append( buf, static_cast< size_t >( n ) );
+                }
+            }
+            
+            if( n == 0 )
+            {
+                close( p.first[ 0 ] );
+                
+                p.first[ 0 ] = -1;
+            }
         }
+    }
+
+    /*
+     * Returns when the child exits, when it writes, when the interrupt
+     * descriptor is readable, or after the timeout.
+     */
+    void Process::IMPL::_poll( std::chrono::steady_clock::duration timeout, int interrupt )
+    {
+        long long ms( std::chrono::ceil< std::chrono::milliseconds >( timeout ).count() );
         
-        if( this->impl->_error.has_value() )
+        if( this->_fd == -1 )
         {
-            return this->impl->_error.value();
+            ms = std::min< long long >( ms, probeInterval.count() );
         }
         
-        std::string out;
-        char        buf[ 1024 ];
-        ssize_t     n;
+        ms = std::min< long long >( ms, INT_MAX );
+        
+        #ifdef __APPLE__
         
-        while( ( n = read( this->impl->_fdErr[ 0 ], buf, sizeof( buf ) ) ) > 0 )
+        if( this->_fd != -1 )
         {
-            out += buf;
+            struct kevent   events[ 4 ];
+            struct timespec ts;
+            int             n( 0 );
+            
+            for( int fd: { this->_fdOut[ 0 ], this->_fdErr[ 0 ], interrupt } )
+            {
+                if( fd != -1 )
+                {
+                    EV_SET( &( events[ n++ ] ), fd, EVFILT_READ, EV_ADD, 0, 0, nullptr );
+                }
+            }
+            
+            ts.tv_sec  = static_cast< time_t >( ms / 1000 );
+            ts.tv_nsec = static_cast< long >( ( ms % 1000 ) * 1000000 );
+            
+            kevent( this->_fd, events, n, events, 4, &ts );
+            
+            return;
         }
         
-        this->impl->_error = out;
+        #endif
         
-        return out;
+        {
+            struct pollfd p[ 4 ];
+            int           i( 0 );
+            
+            for( int fd: { this->_fd, this->_fdOut[ 0 ], this->_fdErr[ 0 ], interrupt } )
+            {
+                p[ i ].fd      = fd;
+                p[ i ].events  = POLLIN;
+                p[ i ].revents = 0;
+                
+                i++;
+            }
+            
+            poll( p, 4, static_cast< int >( ms ) );
+        }
     }
 
-    Process::IMPL::IMPL( const std::string & path, const std::vector< std::string > & args, const std::vector< std::string > & env ):
-        _path( path ),
-        _args( args ),
-        _env(  env )
-    {}
+    /*
+     * The child is signaled through its process group, which also exists
+     * while the child is a zombie that has not been reaped.
+     */
+    void Process::IMPL::_kill( int signal )
+    {
+        kill( -( this->_pid.value() ), signal );
+    }
 }
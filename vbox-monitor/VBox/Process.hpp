@@ -29,13 +29,26 @@
 #include <vector>
 #include <optional>
 #include <memory>
+#include <chrono>
+#include "VBox/StopToken.hpp"
 
 namespace VBox
 {
+    /*
+     * Children run in their own process group. A child still running at
+     * its deadline is sent SIGTERM, then SIGKILL after killDelay, and
+     * waiting with a stop token kills it once the token is stopped. The
+     * whole group is signaled, so anything the child started itself goes
+     * too. Its output is read while it runs, so it cannot block on a full
+     * pipe. Once it has exited, wallTime() is the time from start() to
+     * its exit, and cpuTime() the user and system time it used.
+     */
     class Process
     {
         public:
             
+            static constexpr std::chrono::milliseconds killDelay = std::chrono::milliseconds( 500 );
+            
             Process( const std::string & path, const std::vector< std::string > & args = {}, const std::vector< std::string > & env = {} );
             ~Process( void );
             
@@ -51,13 +64,19 @@ namespace VBox
             void arguments( const std::vector< std::string > & args );
             void environment( const std::vector< std::string > & env );
             
-            std::optional< pid_t >       pid( void )               const;
-            std::optional< int >         terminationStatus( void ) const;
-            std::optional< std::string > output( void )            const;
-            std::optional< std::string > error( void )             const;
+            std::optional< pid_t >                    pid( void )               const;
+            std::optional< int >                      terminationStatus( void ) const;
+            std::optional< std::string >              output( void )            const;
+            std::optional< std::string >              error( void )             const;
+            bool                                      timedOut( void )          const;
+            std::optional< std::chrono::nanoseconds > wallTime( void )          const;
+            std::optional< std::chrono::nanoseconds > cpuTime( void )           const;
             
             void start( void );
             void waitUntilExit( void );
+            void waitUntilExit( const StopToken & token );
+            bool waitFor( std::chrono::steady_clock::time_point deadline );
+            bool waitFor( std::chrono::steady_clock::time_point deadline, const StopToken & token );
             
         private:
             
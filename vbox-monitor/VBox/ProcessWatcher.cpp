@@ -0,0 +1,290 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/ProcessWatcher.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#ifdef __APPLE__
+#include <sys/event.h>
+#endif
+
+namespace VBox
+{
+    class ProcessWatcher::IMPL
+    {
+        public:
+            
+            IMPL( pid_t pid );
+            ~IMPL( void );
+            
+            bool _probe( void ) const;
+            bool _wait( std::chrono::milliseconds timeout, int interrupt );
+            
+            pid_t _pid;
+            int   _fd;
+            bool  _exited;
+    };
+    
+    /*
+     * pidfd_open() needs Linux 5.3, so its support is checked at runtime.
+     */
+    bool ProcessWatcher::supports( void )
+    {
+        #if defined( __linux__ ) && defined( SYS_pidfd_open )
+        
+        static bool supported = []
+        {
+            int fd( static_cast< int >( syscall( SYS_pidfd_open, getpid(), 0 ) ) );
+            
+            if( fd == -1 )
+            {
+                return false;
+            }
+            
+            close( fd );
+            
+            return true;
+        }
+        ();
+        
+        return supported;
+        
+        #elif defined( __APPLE__ )
+        
+        return true;
+        
+        #else
+        
+        return false;
+        
+        #endif
+    }
+    
+    ProcessWatcher::ProcessWatcher( pid_t pid ):
+        impl( std::make_unique< IMPL >( pid ) )
+    {}
+    
+    ProcessWatcher::~ProcessWatcher( void )
+    {}
+    
+    pid_t ProcessWatcher::pid( void ) const
+    {
+        return this->impl->_pid;
+    }
+    
+    bool ProcessWatcher::exited( void )
+    {
+        return this->wait( std::chrono::milliseconds( 0 ) );
+    }
+    
+    /*
+     * Returns whether the process has exited, waiting up to the timeout
+     * for it to do so.
+     */
+    bool ProcessWatcher::wait( std::chrono::milliseconds timeout )
+    {
+        return this->impl->_wait( timeout, -1 );
+    }
+    
+    /*
+     * Also returns false as soon as the token is stopped.
+     */
+    bool ProcessWatcher::wait( std::chrono::milliseconds timeout, const StopToken & token )
+    {
+        return this->impl->_wait( timeout, token.fd() );
+    }
+    
+    /*
+     * Watching starts here, so an exit after construction is never
+     * missed. A process that is already gone is reported as exited.
+     */
+    ProcessWatcher::IMPL::IMPL( pid_t pid ):
+        _pid(    pid ),
+        _fd(     -1 ),
+        _exited( false )
+    {
+        if( pid <= 0 )
+        {
+            throw std::runtime_error( "Invalid process ID" );
+        }
+        
+        #if defined( __linux__ ) && defined( SYS_pidfd_open )
+        
+        if( supports() )
+        {
+            this->_fd = static_cast< int >( syscall( SYS_pidfd_open, pid, 0 ) );
+            
+            if( this->_fd == -1 && errno == ESRCH )
+            {
+                this->_exited = true;
+            }
+        }
+        
+        #elif defined( __APPLE__ )
+        
+        this->_fd = kqueue();
+        
+        if( this->_fd != -1 )
+        {
+            struct kevent event;
+            
+            EV_SET( &event, pid, EVFILT_PROC, EV_ADD | EV_ONESHOT, NOTE_EXIT, 0, nullptr );
+            
+            if( kevent( this->_fd, &event, 1, nullptr, 0, nullptr ) == -1 )
+            {
+                this->_exited = errno == ESRCH;
+                
+                close( this->_fd );
+                
+                this->_fd = -1;
+            }
+        }
+        
+        #endif
+        
+        if( this->_fd == -1 && this->_exited == false )
+        {
+            this->_exited = this->_probe() == false;
+        }
+    }
+    
+    ProcessWatcher::IMPL::~IMPL( void )
+    {
+        if( this->_fd != -1 )
+        {
+            close( this->_fd );
+        }
+    }
+    
+    /*
+     * EPERM means the process exists but belongs to someone else.
+     */
+    bool ProcessWatcher::IMPL::_probe( void ) const
+    {
+        return kill( this->_pid, 0 ) == 0 || errno == EPERM;
+    }
+    
+    /*
+     * The interrupt descriptor, when there is one, is polled along with
+     * the process, and ends the wait once it is readable.
+     */
+    bool ProcessWatcher::IMPL::_wait( std::chrono::milliseconds timeout, int interrupt )
+    {
+        if( this->_exited )
+        {
+            return true;
+        }
+        
+        if( this->_fd == -1 )
+        {
+            std::chrono::steady_clock::time_point end( std::chrono::steady_clock::now() + timeout );
+            
+            while( this->_probe() )
+            {
+                std::chrono::steady_clock::time_point now( std::chrono::steady_clock::now() );
+                struct pollfd                         p;
+                
+                if( now >= end )
+                {
+                    return false;
+                }
+                
+                p.fd      = interrupt;
+                p.events  = POLLIN;
+                p.revents = 0;
+                
+                if( poll( &p, 1, static_cast< int >( std::chrono::duration_cast< std::chrono::milliseconds >( std::min< std::chrono::steady_clock::duration >( end - now, probeInterval ) ).count() ) ) > 0 )
+                {
+                    return false;
+                }
+            }
+            
+            this->_exited = true;
+            
+            return true;
+        }
+        
+        #if defined( __linux__ )
+        {
+            struct pollfd p[ 2 ];
+            int           n;
+            
+            p[ 0 ].fd      = this->_fd;
+            p[ 0 ].events  = POLLIN;
+            p[ 0 ].revents = 0;
+            p[ 1 ].fd      = interrupt;
+            p[ 1 ].events  = POLLIN;
+            p[ 1 ].revents = 0;
+            
+            do
+            {
+                n = poll( p, 2, static_cast< int >( timeout.count() ) );
+            }
+            while( n == -1 && errno == EINTR );
+            
+            this->_exited = n > 0 && p[ 0 ].revents != 0;
+        }
+        #elif defined( __APPLE__ )
+        {
+            struct kevent   events[ 2 ];
+            struct timespec ts;
+            int             n;
+            
+            ts.tv_sec  = static_cast< time_t >( timeout.count() / 1000 );
+            ts.tv_nsec = static_cast< long >( ( timeout.count() % 1000 ) * 1000000 );
+            
+            if( interrupt != -1 )
+            {
+                EV_SET( &( events[ 0 ] ), interrupt, EVFILT_READ, EV_ADD, 0, 0, nullptr );
+                kevent( this->_fd, &( events[ 0 ] ), 1, nullptr, 0, nullptr );
+            }
+            
+            do
+            {
+                n = kevent( this->_fd, nullptr, 0, events, 2, &ts );
+            }
+            while( n == -1 && errno == EINTR );
+            
+            for( int i = 0; i < n; i++ )
+            {
+                if( events[ i ].filter == EVFILT_PROC )
+                {
+                    this->_exited = true;
+                }
+            }
+        }
+        #endif
+        
+        return this->_exited;
+    }
+}
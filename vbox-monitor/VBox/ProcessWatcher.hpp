@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_PROCESS_WATCHER_HPP
+#define VBOX_PROCESS_WATCHER_HPP
+
+#include <chrono>
+#include <memory>
+#include <sys/types.h>
+#include "VBox/StopToken.hpp"
+
+namespace VBox
+{
+    /*
+     * Waits for a process that is not our child to exit, through a pidfd
+     * on Linux or a kqueue on macOS, so the exit is seen as soon as it
+     * happens, and a reused PID cannot be mistaken for the process.
+     * Elsewhere, the process is probed with kill( pid, 0 ) periodically.
+     * A wait with a stop token ends early once the token is stopped.
+     */
+    class ProcessWatcher
+    {
+        public:
+            
+            static constexpr std::chrono::milliseconds probeInterval = std::chrono::milliseconds( 50 );
+            
+            static bool supports( void );
+            
+            ProcessWatcher( pid_t pid );
+            ~ProcessWatcher( void );
+            
+            ProcessWatcher( const ProcessWatcher & o )              = delete;
+            ProcessWatcher( ProcessWatcher && o )                   = delete;
+            ProcessWatcher & operator =( const ProcessWatcher & o ) = delete;
+            ProcessWatcher & operator =( ProcessWatcher && o )      = delete;
+            
+            pid_t pid( void ) const;
+            
+            bool exited( void );
+            bool wait( std::chrono::milliseconds timeout );
+            bool wait( std::chrono::milliseconds timeout, const StopToken & token );
+            
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_PROCESS_WATCHER_HPP */
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/SampleRate.hpp"
+
+namespace VBox
+{
+    class SampleRate::IMPL
+    {
+        public:
+            
+            IMPL( std::chrono::microseconds floor, std::chrono::microseconds ceiling );
+            IMPL( const IMPL & o );
+            
+            std::chrono::microseconds _floor;
+            std::chrono::microseconds _ceiling;
+            std::chrono::microseconds _interval;
+            uint64_t                  _hash;
+            bool                      _sampled;
+    };
+    
+    SampleRate::SampleRate( std::chrono::microseconds floor, std::chrono::microseconds ceiling ):
+        impl( std::make_unique< IMPL >( floor, ceiling ) )
+    {}
+    
+    SampleRate::SampleRate( const SampleRate & o ):
+        impl( std::make_unique< IMPL >( *( o.impl ) ) )
+    {}
+    
+    SampleRate::SampleRate( SampleRate && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    SampleRate::~SampleRate( void )
+    {}
+    
+    SampleRate & SampleRate::operator =( SampleRate o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    std::chrono::microseconds SampleRate::floor( void ) const
+    {
+        return this->impl->_floor;
+    }
+    
+    std::chrono::microseconds SampleRate::ceiling( void ) const
+    {
+        return this->impl->_ceiling;
+    }
+    
+    std::chrono::microseconds SampleRate::interval( void ) const
+    {
+        return this->impl->_interval;
+    }
+    
+    /*
+     * Compares the sample's hash with the previous one. The first sample
+     * always counts as a change.
+     */
+    bool SampleRate::sample( uint64_t hash )
+    {
+        bool changed( this->impl->_sampled == false || hash != this->impl->_hash );
+        
+        this->impl->_hash    = hash;
+        this->impl->_sampled = true;
+        
+        this->update( changed );
+        
+        return changed;
+    }
+    
+    void SampleRate::update( bool changed )
+    {
+        if( changed )
+        {
+            this->impl->_interval = this->impl->_floor;
+        }
+        else
+        {
+            this->impl->_interval = std::min( std::max( this->impl->_interval * 2, step ), this->impl->_ceiling );
+            this->impl->_interval = std::max( this->impl->_interval, this->impl->_floor );
+        }
+    }
+    
+    void SampleRate::reset( void )
+    {
+        this->impl->_interval = this->impl->_floor;
+    }
+    
+    /*
+     * FNV-1a, which is enough to tell samples of a few hundred bytes
+     * apart, and costs far less than fetching them.
+     */
+    uint64_t SampleRate::hash( const void * data, size_t size )
+    {
+        const uint8_t * bytes( static_cast< const uint8_t * >( data ) );
+        uint64_t        hash( 0xCBF29CE484222325 );
+        
+        for( size_t i = 0; i < size; i++ )
+        {
+            hash ^= bytes[ i ];
+            hash *= 0x00000100000001B3;
+        }
+        
+        return hash;
+    }
+    
+    void swap( SampleRate & o1, SampleRate & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    /*
+     * A ceiling below the floor means the floor is used as a fixed rate.
+     */
+    SampleRate::IMPL::IMPL( std::chrono::microseconds floor, std::chrono::microseconds ceiling ):
+        _floor(    std::max( floor, std::chrono::microseconds( 0 ) ) ),
+        _ceiling(  std::max( ceiling, _floor ) ),
+        _interval( _floor ),
+        _hash(     0 ),
+        _sampled(  false )
+    {}
+    
+    SampleRate::IMPL::IMPL( const IMPL & o ):
+        _floor(    o._floor ),
+        _ceiling(  o._ceiling ),
+        _interval( o._interval ),
+        _hash(     o._hash ),
+        _sampled(  o._sampled )
+    {}
+}
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_SAMPLE_RATE_HPP
+#define VBOX_SAMPLE_RATE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+
+namespace VBox
+{
+    /*
+     * Paces a sampling loop. While samples stay the same, the interval
+     * doubles, starting at step, from the floor up to the ceiling. It
+     * goes back to the floor as soon as a sample changes, or on reset().
+     */
+    class SampleRate
+    {
+        public:
+            
+            static constexpr std::chrono::microseconds step = std::chrono::microseconds( 1000 );
+            
+            SampleRate( std::chrono::microseconds floor, std::chrono::microseconds ceiling );
+            SampleRate( const SampleRate & o );
+            SampleRate( SampleRate && o ) noexcept;
+            ~SampleRate( void );
+            
+            SampleRate & operator =( SampleRate o );
+            
+            std::chrono::microseconds floor( void )    const;
+            std::chrono::microseconds ceiling( void )  const;
+            std::chrono::microseconds interval( void ) const;
+            
+            bool sample( uint64_t hash );
+            void update( bool changed );
+            void reset( void );
+            
+            static uint64_t hash( const void * data, size_t size );
+            
+            friend void swap( SampleRate & o1, SampleRate & o2 );
+            
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_SAMPLE_RATE_HPP */
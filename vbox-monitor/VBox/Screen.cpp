@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "VBox/Screen.hpp"
+#include "VBox/Casts.hpp"
 #include <algorithm>
 #include <ncurses.h>
 #include <sys/ioctl.h>
@@ -30,7 +31,10 @@
 #include <thread>
 #include <chrono>
 #include <vector>
+#include <cstring>
 #include <poll.h>
+#include <fcntl.h>
+#include <csignal>
 #include <condition_variable>
 #include <mutex>
 
@@ -43,6 +47,10 @@ namespace VBox
             IMPL( void );
             ~IMPL( void );
             
+            static void _handleSignal( int sig );
+            
+            static int _signalFD;
+            
             std::vector< std::function< void( void ) > > _onResize;
             std::vector< std::function< void( int ) > >  _onKeyPress;
             std::vector< std::function< void( void ) > > _onUpdate;
@@ -51,9 +59,13 @@ namespace VBox
             std::size_t          _height;
             bool                 _colors;
             bool                 _running;
+            size_t               _maximumFPS;
+            int                  _wakeFD[ 2 ];
             std::recursive_mutex _rmtx;
     };
     
+    int Screen::IMPL::_signalFD = -1;
+    
     Screen & Screen::shared( void )
     {
         static Screen       * screen( nullptr );
@@ -99,6 +111,31 @@ namespace VBox
         
         this->impl->_width  = s.ws_col;
         this->impl->_height = s.ws_row;
+        
+        if( pipe( this->impl->_wakeFD ) == -1 )
+        {
+            throw std::runtime_error( "Cannot create pipe" );
+        }
+        
+        for( int fd: this->impl->_wakeFD )
+        {
+            fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+            fcntl( fd, F_SETFD, fcntl( fd, F_GETFD ) | FD_CLOEXEC );
+        }
+        
+        {
+            struct sigaction sa;
+            
+            memset( &sa, 0, sizeof( sa ) );
+            sigemptyset( &( sa.sa_mask ) );
+            
+            sa.sa_handler = IMPL::_handleSignal;
+            sa.sa_flags   = SA_RESTART;
+            
+            IMPL::_signalFD = this->impl->_wakeFD[ 1 ];
+            
+            sigaction( SIGWINCH, &sa, nullptr );
+        }
     }
     
     std::size_t Screen::width( void ) const
@@ -150,6 +187,34 @@ namespace VBox
         ::refresh();
     }
     
+    void Screen::update( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        ::doupdate();
+    }
+    
+    size_t Screen::maximumFPS( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return this->impl->_maximumFPS;
+    }
+    
+    void Screen::maximumFPS( size_t value )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_maximumFPS = std::max< size_t >( value, 1 );
+    }
+    
+    void Screen::setNeedsUpdate( void ) const
+    {
+        uint8_t c( 0 );
+        
+        ( void )write( this->impl->_wakeFD[ 1 ], &c, 1 );
+    }
+    
     void Screen::print( const std::string & s )
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
@@ -187,63 +252,103 @@ namespace VBox
             this->impl->_running = true;
         }
         
-        while( this->impl->_running )
         {
-            struct winsize                               s;
-            std::vector< std::function< void( void ) > > onResize;
-            std::vector< std::function< void( int ) > >  onKeyPress;
-            std::vector< std::function< void( void ) > > onUpdate;
-            int                                          key( 0 );
-            
-            ::ioctl( STDOUT_FILENO, TIOCGWINSZ, &s );
+            std::chrono::steady_clock::time_point lastFrame;
+            bool                                  needsUpdate( true );
             
+            while( this->isRunning() )
             {
-                std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                struct winsize                               s;
+                struct pollfd                                fds[ 2 ];
+                std::vector< std::function< void( void ) > > onResize;
+                std::vector< std::function< void( int ) > >  onKeyPress;
+                std::vector< std::function< void( void ) > > onUpdate;
+                std::chrono::nanoseconds                     frame( std::chrono::nanoseconds( std::chrono::seconds( 1 ) ) / this->maximumFPS() );
+                std::chrono::nanoseconds                     elapsed( std::chrono::steady_clock::now() - lastFrame );
+                int                                          wait( -1 );
+                uint8_t                                      key( 0 );
+                
+                if( needsUpdate )
+                {
+                    wait = ( elapsed >= frame ) ? 0 : numeric_cast< int >( std::chrono::duration_cast< std::chrono::milliseconds >( frame - elapsed ).count() + 1 );
+                }
+                
+                memset( fds, 0, sizeof( fds ) );
                 
-                onKeyPress = this->impl->_onKeyPress;
-                onUpdate   = this->impl->_onUpdate;
+                fds[ 0 ].fd     = STDIN_FILENO;
+                fds[ 0 ].events = POLLIN;
+                fds[ 1 ].fd     = this->impl->_wakeFD[ 0 ];
+                fds[ 1 ].events = POLLIN;
                 
-                if( s.ws_col != this->impl->_width || s.ws_row != this->impl->_height )
+                if( poll( fds, 2, wait ) > 0 )
                 {
-                    this->impl->_width  = s.ws_col;
-                    this->impl->_height = s.ws_row;
+                    if( fds[ 1 ].revents & POLLIN )
+                    {
+                        uint8_t buf[ 64 ];
+                        
+                        while( read( this->impl->_wakeFD[ 0 ], buf, sizeof( buf ) ) > 0 )
+                        {}
+                        
+                        needsUpdate = true;
+                    }
                     
-                    onResize = this->impl->_onResize;
+                    if( ( fds[ 0 ].revents & POLLIN ) && read( STDIN_FILENO, &key, 1 ) == 1 )
+                    {
+                        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                        
+                        onKeyPress  = this->impl->_onKeyPress;
+                        needsUpdate = true;
+                    }
                 }
                 
+                ::ioctl( STDOUT_FILENO, TIOCGWINSZ, &s );
+                
                 {
-                    static struct pollfd p;
-                    
-                    memset( &p, 0, sizeof( p ) );
+                    std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
                     
-                    p.fd      = 0;
-                    p.events  = POLLIN;
-                    p.revents = 0;
-                    
-                    if( poll( &p, 1, 0 ) > 0 )
+                    if( s.ws_col != this->impl->_width || s.ws_row != this->impl->_height )
                     {
-                        key        = getc( stdin );
-                        onKeyPress = this->impl->_onKeyPress;
+                        this->impl->_width  = s.ws_col;
+                        this->impl->_height = s.ws_row;
+                        
+                        ::resizeterm( s.ws_row, s.ws_col );
+                        
+                        onResize    = this->impl->_onResize;
+                        needsUpdate = true;
                     }
                 }
+                
+                for( const auto & f: onResize )
+                {
+                    f();
+                }
+                
+                for( const auto & f: onKeyPress )
+                {
+                    f( key );
+                }
+                
+                if( needsUpdate == false || std::chrono::steady_clock::now() - lastFrame < frame )
+                {
+                    continue;
+                }
+                
+                {
+                    std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                    
+                    onUpdate = this->impl->_onUpdate;
+                }
+                
+                for( const auto & f: onUpdate )
+                {
+                    f();
+                }
+                
+                this->update();
+                
+                lastFrame   = std::chrono::steady_clock::now();
+                needsUpdate = false;
             }
-            
-            for( const auto & f: onResize )
-            {
-                f();
-            }
-            
-            for( const auto & f: onKeyPress )
-            {
-                f( key );
-            }
-            
-            for( const auto & f: onUpdate )
-            {
-                f();
-            }
-            
-            this->refresh();
         }
         
         this->clear();
@@ -255,6 +360,8 @@ namespace VBox
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
         this->impl->_running = false;
+        
+        this->setNeedsUpdate();
     }
     
     void Screen::onResize( const std::function< void( void ) > & f )
@@ -282,7 +389,9 @@ namespace VBox
         _width( 0 ),
         _height( 0 ),
         _colors( false ),
-        _running( false )
+        _running( false ),
+        _maximumFPS( 30 ),
+        _wakeFD{ -1, -1 }
     {}
     
     Screen::IMPL::~IMPL( void )
@@ -290,5 +399,25 @@ namespace VBox
         ::clrtoeol();
         ::refresh();
         ::endwin();
+        
+        _signalFD = -1;
+        
+        close( this->_wakeFD[ 0 ] );
+        close( this->_wakeFD[ 1 ] );
+    }
+    
+    void Screen::IMPL::_handleSignal( int sig )
+    {
+        uint8_t c( 0 );
+        int     e( errno );
+        
+        ( void )sig;
+        
+        if( _signalFD != -1 )
+        {
+            ( void )write( _signalFD, &c, 1 );
+        }
+        
+        errno = e;
     }
 }
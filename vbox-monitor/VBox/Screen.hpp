@@ -50,6 +50,11 @@ namespace VBox
             bool isRunning( void )      const;
             void clear( void )          const;
             void refresh( void )        const;
+            void update( void )         const;
+            void setNeedsUpdate( void ) const;
+            
+            size_t maximumFPS( void ) const;
+            void   maximumFPS( size_t value );
             
             void print( const std::string & s );
             void print( const Color & color, const std::string & s );
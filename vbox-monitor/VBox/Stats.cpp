@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/Stats.hpp"
+#include "VBox/Allocations.hpp"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+
+namespace VBox
+{
+    class Stats::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            
+            std::array< std::array< Histogram, stages >, channels > _histograms;
+            std::chrono::steady_clock::time_point                   _start;
+            std::array< std::atomic< int64_t >, milestones >        _milestones;
+    };
+    
+    Stats::Scope::Scope( Channel channel, Stage stage ):
+        _channel( channel ),
+        _stage(   stage ),
+        _start(   std::chrono::steady_clock::now() )
+    {}
+    
+    Stats::Scope::~Scope( void )
+    {
+        Stats::shared().record( this->_channel, this->_stage, std::chrono::steady_clock::now() - this->_start );
+    }
+    
+    Stats & Stats::shared( void )
+    {
+        static Stats        * stats( nullptr );
+        static std::once_flag once;
+        
+        std::call_once( once, [ & ]{ stats = new Stats(); } );
+        
+        return *( stats );
+    }
+    
+    std::string Stats::name( Channel channel )
+    {
+        switch( channel )
+        {
+            case Channel::Registers: return "registers";
+            case Channel::Stack:     return "stack";
+            case Channel::Memory:    return "memory";
+            case Channel::Live:      return "live";
+            case Channel::UI:        return "ui";
+        }
+        
+        return "";
+    }
+    
+    std::string Stats::name( Stage stage )
+    {
+        switch( stage )
+        {
+            case Stage::Spawn:   return "spawn";
+            case Stage::Wait:    return "wait";
+            case Stage::CPU:     return "cpu";
+            case Stage::Read:    return "read";
+            case Stage::Parse:   return "parse";
+            case Stage::Index:   return "index";
+            case Stage::Publish: return "publish";
+            case Stage::Render:  return "render";
+        }
+        
+        return "";
+    }
+    
+    Stats::Stats( void ):
+        impl( std::make_unique< IMPL >() )
+    {}
+    
+    const Histogram & Stats::histogram( Channel channel, Stage stage ) const
+    {
+        return this->impl->_histograms[ static_cast< size_t >( channel ) ][ static_cast< size_t >( stage ) ];
+    }
+    
+    void Stats::record( Channel channel, Stage stage, std::chrono::nanoseconds duration )
+    {
+        this->impl->_histograms[ static_cast< size_t >( channel ) ][ static_cast< size_t >( stage ) ].record( static_cast< uint64_t >( std::max< int64_t >( duration.count(), 0 ) ) );
+    }
+    
+    void Stats::reset( void )
+    {
+        for( auto & channel: this->impl->_histograms )
+        {
+            for( auto & histogram: channel )
+            {
+                histogram.reset();
+            }
+        }
+    }
+    
+    std::string Stats::name( Milestone milestone )
+    {
+        switch( milestone )
+        {
+            case Milestone::Running:     return "running";
+            case Milestone::FirstSample: return "first_sample";
+            case Milestone::FirstFrame:  return "first_frame";
+        }
+        
+        return "";
+    }
+    
+    /*
+     * Called on hot paths, so reaching a milestone again is a single
+     * atomic load.
+     */
+    void Stats::reach( Milestone milestone )
+    {
+        std::atomic< int64_t > & elapsed( this->impl->_milestones[ static_cast< size_t >( milestone ) ] );
+        int64_t                  expected( -1 );
+        
+        if( elapsed.load( std::memory_order_relaxed ) != -1 )
+        {
+            return;
+        }
+        
+        elapsed.compare_exchange_strong( expected, std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - this->impl->_start ).count() );
+    }
+    
+    std::optional< std::chrono::nanoseconds > Stats::elapsed( Milestone milestone ) const
+    {
+        int64_t elapsed( this->impl->_milestones[ static_cast< size_t >( milestone ) ].load() );
+        
+        if( elapsed == -1 )
+        {
+            return {};
+        }
+        
+        return std::chrono::nanoseconds( elapsed );
+    }
+    
+    std::string Stats::json( void ) const
+    {
+        std::stringstream ss;
+        bool              firstChannel( true );
+        
+        ss << "{";
+        
+        for( size_t i = 0; i < channels; i++ )
+        {
+            bool firstStage( true );
+            
+            ss << ( ( firstChannel ) ? "" : "," ) << std::endl
+               << "    \"" << name( static_cast< Channel >( i ) ) << "\": {";
+            
+            firstChannel = false;
+            
+            for( size_t j = 0; j < stages; j++ )
+            {
+                const Histogram & h( this->impl->_histograms[ i ][ j ] );
+                
+                if( h.count() == 0 )
+                {
+                    continue;
+                }
+                
+                ss << ( ( firstStage ) ? "" : "," ) << std::endl
+                   << "        \"" << name( static_cast< Stage >( j ) ) << "\": { "
+                   << "\"count\": " << h.count()            << ", "
+                   << "\"mean\": "  << h.mean()             << ", "
+                   << "\"p50\": "   << h.percentile( 50 )   << ", "
+                   << "\"p90\": "   << h.percentile( 90 )   << ", "
+                   << "\"p99\": "   << h.percentile( 99 )   << ", "
+                   << "\"max\": "   << h.max()
+                   << " }";
+                
+                firstStage = false;
+            }
+            
+            ss << ( ( firstStage ) ? "}" : "\n    }" );
+        }
+        
+        ss << "," << std::endl
+           << "    \"allocations\": { "
+           << "\"count\": " << Allocations::count() << ", "
+           << "\"bytes\": " << Allocations::bytes() << ", "
+           << "\"live\": "  << Allocations::live()
+           << " }";
+        
+        {
+            bool first( true );
+            
+            for( size_t i = 0; i < milestones; i++ )
+            {
+                std::optional< std::chrono::nanoseconds > elapsed( this->elapsed( static_cast< Milestone >( i ) ) );
+                
+                if( elapsed.has_value() == false )
+                {
+                    continue;
+                }
+                
+                ss << ( ( first ) ? ",\n    \"startup\": { " : ", " )
+                   << "\"" << name( static_cast< Milestone >( i ) ) << "\": " << elapsed->count();
+                
+                first = false;
+            }
+            
+            ss << ( ( first ) ? "" : " }" );
+        }
+        
+        ss << std::endl << "}" << std::endl;
+        
+        return ss.str();
+    }
+    
+    Stats::IMPL::IMPL( void ):
+        _start( std::chrono::steady_clock::now() )
+    {
+        for( auto & milestone: this->_milestones )
+        {
+            milestone = -1;
+        }
+    }
+}
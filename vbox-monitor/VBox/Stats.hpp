@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_STATS_HPP
+#define VBOX_STATS_HPP
+
+#include "VBox/Histogram.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <optional>
+
+namespace VBox
+{
+    class Stats
+    {
+        public:
+            
+            enum class Channel: size_t
+            {
+                Registers,
+                Stack,
+                Memory,
+                Live,
+                UI
+            };
+            
+            /*
+             * CPU is the user and system time VBoxManage used to serve a
+             * request, rather than a stage of its own.
+             */
+            enum class Stage: size_t
+            {
+                Spawn,
+                Wait,
+                CPU,
+                Read,
+                Parse,
+                Index,
+                Publish,
+                Render
+            };
+            
+            /*
+             * Startup milestones are reached once, and timed from the
+             * creation of the shared statistics, which main does first.
+             */
+            enum class Milestone: size_t
+            {
+                Running,
+                FirstSample,
+                FirstFrame
+            };
+            
+            static constexpr size_t channels   = 5;
+            static constexpr size_t stages     = 8;
+            static constexpr size_t milestones = 3;
+            
+            class Scope
+            {
+                public:
+                    
+                    Scope( Channel channel, Stage stage );
+                    ~Scope( void );
+                    
+                    Scope( const Scope & o )              = delete;
+                    Scope( Scope && o )                   = delete;
+                    Scope & operator =( const Scope & o ) = delete;
+                    Scope & operator =( Scope && o )      = delete;
+                    
+                private:
+                    
+                    Channel                               _channel;
+                    Stage                                 _stage;
+                    std::chrono::steady_clock::time_point _start;
+            };
+            
+            static Stats & shared( void );
+            
+            static std::string name( Channel channel );
+            static std::string name( Stage stage );
+            static std::string name( Milestone milestone );
+            
+            Stats( const Stats & o )              = delete;
+            Stats( Stats && o )                   = delete;
+            Stats & operator =( const Stats & o ) = delete;
+            Stats & operator =( Stats && o )      = delete;
+            
+            const Histogram & histogram( Channel channel, Stage stage ) const;
+            
+            void record( Channel channel, Stage stage, std::chrono::nanoseconds duration );
+            void reset( void );
+            
+            void                                      reach( Milestone milestone );
+            std::optional< std::chrono::nanoseconds > elapsed( Milestone milestone ) const;
+            
+            std::string json( void ) const;
+            
+        private:
+            
+            Stats( void );
+            
+            class IMPL;
+            
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_STATS_HPP */
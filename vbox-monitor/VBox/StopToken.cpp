@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/StopToken.hpp"
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace VBox
+{
+    class StopToken::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            ~IMPL( void );
+            
+            void _signal( void );
+            
+            mutable std::mutex                                   _mtx;
+            bool                                                 _stopped;
+            std::map< uint64_t, std::function< void( void ) > > _callbacks;
+            uint64_t                                             _nextCallback;
+            int                                                  _fd[ 2 ];
+    };
+    
+    StopToken::StopToken( void ):
+        impl( std::make_shared< IMPL >() )
+    {}
+    
+    StopToken::StopToken( const StopToken & o ):
+        impl( o.impl )
+    {}
+    
+    StopToken::StopToken( StopToken && o ) noexcept:
+        impl( std::move( o.impl ) )
+    {}
+    
+    StopToken::~StopToken( void )
+    {}
+    
+    StopToken & StopToken::operator =( StopToken o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    bool StopToken::stopRequested( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_stopped;
+    }
+    
+    /*
+     * The pipe is only created when a descriptor is asked for, as most
+     * tokens are never polled.
+     */
+    int StopToken::fd( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( this->impl->_fd[ 0 ] == -1 )
+        {
+            if( pipe( this->impl->_fd ) == -1 )
+            {
+                throw std::runtime_error( "Cannot create pipe" );
+            }
+            
+            for( int fd: this->impl->_fd )
+            {
+                fcntl( fd, F_SETFD, FD_CLOEXEC );
+                fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+            }
+            
+            if( this->impl->_stopped )
+            {
+                this->impl->_signal();
+            }
+        }
+        
+        return this->impl->_fd[ 0 ];
+    }
+    
+    /*
+     * Callbacks run with the token locked, so remove() waits for one
+     * that is running. They must not use the token themselves.
+     */
+    void StopToken::requestStop( void )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( this->impl->_stopped )
+        {
+            return;
+        }
+        
+        this->impl->_stopped = true;
+        
+        this->impl->_signal();
+        
+        for( const auto & p: this->impl->_callbacks )
+        {
+            p.second();
+        }
+        
+        this->impl->_callbacks.clear();
+    }
+    
+    /*
+     * On a token that is already stopped, the callback runs right away.
+     */
+    uint64_t StopToken::onStop( const std::function< void( void ) > & f ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        uint64_t id( this->impl->_nextCallback++ );
+        
+        if( this->impl->_stopped )
+        {
+            f();
+        }
+        else
+        {
+            this->impl->_callbacks[ id ] = f;
+        }
+        
+        return id;
+    }
+    
+    void StopToken::remove( uint64_t callback ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_callbacks.erase( callback );
+    }
+    
+    void swap( StopToken & o1, StopToken & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    StopToken::IMPL::IMPL( void ):
+        _stopped(      false ),
+        _nextCallback( 1 ),
+        _fd{           -1, -1 }
+    {}
+    
+    StopToken::IMPL::~IMPL( void )
+    {
+        if( this->_fd[ 0 ] != -1 )
+        {
+            close( this->_fd[ 0 ] );
+            close( this->_fd[ 1 ] );
+        }
+    }
+    
+    /*
+     * The byte is never read, so the descriptor stays readable.
+     */
+    void StopToken::IMPL::_signal( void )
+    {
+        char c( 0 );
+        
+        if( this->_fd[ 1 ] != -1 )
+        {
+            while( write( this->_fd[ 1 ], &c, 1 ) == -1 && errno == EINTR )
+            {}
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_STOP_TOKEN_HPP
+#define VBOX_STOP_TOKEN_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace VBox
+{
+    /*
+     * Asks work running on other threads to stop. Copies share the same
+     * state, so stopping a token stops all its copies, including the
+     * ones handed to blocking calls.
+     * Stopping runs the callbacks registered with onStop(), once, so a
+     * blocking call can be interrupted, for instance by killing a child
+     * process, and makes fd() readable, so it can be polled along with
+     * other descriptors. A callback is never running once remove() has
+     * returned.
+     */
+    class StopToken
+    {
+        public:
+            
+            StopToken( void );
+            StopToken( const StopToken & o );
+            StopToken( StopToken && o ) noexcept;
+            ~StopToken( void );
+            
+            StopToken & operator =( StopToken o );
+            
+            bool stopRequested( void ) const;
+            int  fd( void )            const;
+            
+            void requestStop( void );
+            
+            uint64_t onStop( const std::function< void( void ) > & f ) const;
+            void     remove( uint64_t callback )                      const;
+            
+            friend void swap( StopToken & o1, StopToken & o2 );
+            
+        private:
+            
+            class IMPL;
+            std::shared_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_STOP_TOKEN_HPP */
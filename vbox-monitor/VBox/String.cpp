@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "VBox/String.hpp"
+#include <algorithm>
 
 namespace VBox
 {
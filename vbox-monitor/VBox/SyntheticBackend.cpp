@@ -0,0 +1,541 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/SyntheticBackend.hpp"
+#include "VBox/Pool.hpp"
+#include "VBox/Stats.hpp"
+#include "VBox/Casts.hpp"
+#include <map>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
+
+namespace VBox
+{
+    class SyntheticBackend::IMPL
+    {
+        public:
+            
+            struct Guest
+            {
+                std::vector< uint8_t >       memory;
+                std::vector< VM::Registers > cpus;
+                std::vector< uint64_t >      cursors;
+                uint64_t                     random;
+            };
+            
+            static constexpr size_t   pageSize      = 4096;
+            static constexpr size_t   headerSize    = 0x1000;
+            static constexpr uint64_t codeAddress   = 0x100000;
+            static constexpr uint64_t codeSize      = 0x10000;
+            static constexpr size_t   wordsPerWrite = 8;
+            
+            IMPL( uint64_t memorySize, size_t writeRate, size_t cpus, size_t stackDepth, uint64_t seed );
+            
+            static uint64_t _mix( uint64_t value );
+            static uint64_t _next( Guest & guest );
+            static uint64_t _hash( const std::string & s );
+            
+            std::unique_ptr< Guest > _create( const std::string & vmName );
+            void                     _step( Guest & guest );
+            void                     _write( Guest & guest );
+            uint64_t                 _regionStart( size_t cpu ) const;
+            uint64_t                 _regionEnd( size_t cpu )   const;
+            
+            uint64_t                                          _memorySize;
+            size_t                                            _writeRate;
+            size_t                                            _cpus;
+            size_t                                            _stackDepth;
+            uint64_t                                          _seed;
+            bool                                              _halted;
+            std::vector< uint8_t >                            _header;
+            mutable std::mutex                                _mtx;
+            std::map< std::string, std::unique_ptr< Guest > > _running;
+            Pool< std::vector< uint8_t > >                    _images;
+    };
+    
+    SyntheticBackend::SyntheticBackend( uint64_t memorySize, size_t writeRate, size_t cpus, size_t stackDepth, uint64_t seed ):
+        impl( std::make_unique< IMPL >( memorySize, writeRate, cpus, stackDepth, seed ) )
+    {}
+    
+    SyntheticBackend::~SyntheticBackend( void )
+    {}
+    
+    uint64_t SyntheticBackend::memorySize( void ) const
+    {
+        return this->impl->_memorySize;
+    }
+    
+    size_t SyntheticBackend::writeRate( void ) const
+    {
+        return this->impl->_writeRate;
+    }
+    
+    size_t SyntheticBackend::cpus( void ) const
+    {
+        return this->impl->_cpus;
+    }
+    
+    size_t SyntheticBackend::stackDepth( void ) const
+    {
+        return this->impl->_stackDepth;
+    }
+    
+    uint64_t SyntheticBackend::seed( void ) const
+    {
+        return this->impl->_seed;
+    }
+    
+    bool SyntheticBackend::halted( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_halted;
+    }
+    
+    void SyntheticBackend::halted( bool value )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_halted = value;
+    }
+    
+    bool SyntheticBackend::registerVM( const std::string & path )
+    {
+        ( void )path;
+        
+        return true;
+    }
+    
+    bool SyntheticBackend::unregisterVM( const std::string & vmName )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_running.count( vmName ) == 0;
+    }
+    
+    bool SyntheticBackend::startVM( const std::string & vmName )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( this->impl->_running.count( vmName ) > 0 )
+        {
+            return false;
+        }
+        
+        this->impl->_running[ vmName ] = this->impl->_create( vmName );
+        
+        return true;
+    }
+    
+    bool SyntheticBackend::powerOffVM( const std::string & vmName )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_running.erase( vmName ) > 0;
+    }
+    
+    std::vector< VM::Info > SyntheticBackend::runningVMs( const StopToken & token )
+    {
+        std::vector< VM::Info >       running;
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        ( void )token;
+        
+        for( const auto & p: this->impl->_running )
+        {
+            uint64_t hash( IMPL::_hash( p.first ) );
+            char     uid[ 40 ];
+            
+            snprintf
+            (
+                uid,
+                sizeof( uid ),
+                "%08x-0000-4000-8000-%012llx",
+                static_cast< unsigned int >( hash >> 32 ),
+                static_cast< unsigned long long >( hash & 0xFFFFFFFFFFFF )
+            );
+            
+            running.push_back( { p.first, uid } );
+        }
+        
+        return running;
+    }
+    
+    /*
+     * The guest runs in our own process, so there is nothing to watch.
+     */
+    std::optional< pid_t > SyntheticBackend::hostProcess( const std::string & vmName, const StopToken & token )
+    {
+        ( void )vmName;
+        ( void )token;
+        
+        return {};
+    }
+    
+    Backend::Error SyntheticBackend::registers( const std::string & vmName, VM::Registers & registers, const StopToken & token )
+    {
+        Stats::Scope                  scope( Stats::Channel::Registers, Stats::Stage::Read );
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        auto                          it( this->impl->_running.find( vmName ) );
+        
+        ( void )token;
+        
+        if( it == this->impl->_running.end() )
+        {
+            return Error::NotRunning;
+        }
+        
+        if( this->impl->_halted == false )
+        {
+            this->impl->_step( *( it->second ) );
+        }
+        
+        registers = it->second->cpus[ 0 ];
+        
+        return Error::None;
+    }
+    
+    /*
+     * Frames are chained from the current RBP and RIP, and only depend on
+     * the registers, so the stack is stable while they are.
+     */
+    Backend::Error SyntheticBackend::stack( const std::string & vmName, std::vector< VM::StackEntry > & stack, const StopToken & token )
+    {
+        Stats::Scope                  scope( Stats::Channel::Stack, Stats::Stage::Read );
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        auto                          it( this->impl->_running.find( vmName ) );
+        
+        ( void )token;
+        
+        if( it == this->impl->_running.end() )
+        {
+            stack.clear();
+            
+            return Error::NotRunning;
+        }
+        
+        {
+            const VM::Registers & regs( it->second->cpus[ 0 ] );
+            uint32_t              bp( static_cast< uint32_t >( regs.rbp() ) );
+            uint32_t              ip( static_cast< uint32_t >( regs.rip() ) );
+            
+            stack.resize( this->impl->_stackDepth );
+            
+            for( size_t i = 0; i < stack.size(); i++ )
+            {
+                uint64_t hash( IMPL::_mix( ( static_cast< uint64_t >( bp ) << 32 ) | ip ) );
+                uint32_t next( bp + 0x20 + static_cast< uint32_t >( hash & 0xF0 ) );
+                uint32_t ret( static_cast< uint32_t >( IMPL::codeAddress + ( ( hash >> 8 ) % IMPL::codeSize ) ) );
+                
+                stack[ i ].bp(    { 0x10, bp } );
+                stack[ i ].retBP( { 0x10, next } );
+                stack[ i ].retIP( { 0x08, ret } );
+                stack[ i ].arg0(  static_cast< uint32_t >( IMPL::_mix( hash + 0 ) ) );
+                stack[ i ].arg1(  static_cast< uint32_t >( IMPL::_mix( hash + 1 ) ) );
+                stack[ i ].arg2(  static_cast< uint32_t >( IMPL::_mix( hash + 2 ) ) );
+                stack[ i ].arg3(  static_cast< uint32_t >( IMPL::_mix( hash + 3 ) ) );
+                stack[ i ].ip(    { 0x08, ip } );
+                
+                bp = next;
+                ip = ret;
+            }
+        }
+        
+        return Error::None;
+    }
+    
+    /*
+     * The dump is a copy of guest memory behind an ELF core header, like
+     * the one dumpvmcore writes, so the whole capture pipeline runs on it.
+     * Images are pooled, so a new one is only allocated while all others
+     * are still referenced by parsed dumps.
+     */
+    Backend::Error SyntheticBackend::capture( const std::string & vmName, VM::DumpTarget & target, std::optional< ELF::File > & elf, const StopToken & token )
+    {
+        std::shared_ptr< std::vector< uint8_t > > image;
+        
+        ( void )target;
+        ( void )token;
+        
+        elf.reset();
+        
+        {
+            Stats::Scope                  scope( Stats::Channel::Memory, Stats::Stage::Read );
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            auto                          it( this->impl->_running.find( vmName ) );
+            
+            if( it == this->impl->_running.end() )
+            {
+                return Error::NotRunning;
+            }
+            
+            if( this->impl->_halted == false )
+            {
+                this->impl->_write( *( it->second ) );
+            }
+            
+            image = this->impl->_images.acquire();
+            
+            image->resize( this->impl->_header.size() + it->second->memory.size() );
+            
+            memcpy( image->data(), this->impl->_header.data(), this->impl->_header.size() );
+            memcpy( image->data() + this->impl->_header.size(), it->second->memory.data(), it->second->memory.size() );
+        }
+        
+        elf = ELF::File( image, image->data(), image->size() );
+        
+        return Error::None;
+    }
+    
+    /*
+     * Reads advance the guest like captures do. Ranges are clipped to the
+     * guest's memory.
+     */
+    Backend::Error SyntheticBackend::read( const std::string & vmName, const std::vector< std::pair< uint64_t, uint64_t > > & ranges, VM::PartialCore & core, const StopToken & token )
+    {
+        Stats::Scope                  scope( Stats::Channel::Memory, Stats::Stage::Read );
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        auto                          it( this->impl->_running.find( vmName ) );
+        
+        ( void )token;
+        
+        if( it == this->impl->_running.end() )
+        {
+            return Error::NotRunning;
+        }
+        
+        if( this->impl->_halted == false )
+        {
+            this->impl->_write( *( it->second ) );
+        }
+        
+        core.reset();
+        
+        for( const auto & range: ranges )
+        {
+            const std::vector< uint8_t > & memory( it->second->memory );
+            
+            if( range.first >= memory.size() || range.second == 0 )
+            {
+                continue;
+            }
+            
+            {
+                uint64_t size( std::min< uint64_t >( range.second, memory.size() - range.first ) );
+                
+                memcpy( core.data( core.add( range.first, size ) ), memory.data() + range.first, numeric_cast< size_t >( size ) );
+            }
+        }
+        
+        return Error::None;
+    }
+    
+    uint64_t SyntheticBackend::memorySize( const std::string & vmName, const StopToken & token )
+    {
+        ( void )vmName;
+        ( void )token;
+        
+        return this->impl->_memorySize;
+    }
+    
+    SyntheticBackend::IMPL::IMPL( uint64_t memorySize, size_t writeRate, size_t cpus, size_t stackDepth, uint64_t seed ):
+        _memorySize( ( std::max( memorySize, minimumMemorySize ) + pageSize - 1 ) & ~static_cast< uint64_t >( pageSize - 1 ) ),
+        _writeRate(  writeRate ),
+        _cpus(       std::max< size_t >( cpus, 1 ) ),
+        _stackDepth( stackDepth ),
+        _seed(       seed ),
+        _halted(     false )
+    {
+        auto put = [ & ]( uint64_t value, size_t size )
+        {
+            for( size_t i = 0; i < size; i++ )
+            {
+                this->_header.push_back( static_cast< uint8_t >( value >> ( i * 8 ) ) );
+            }
+        };
+        
+        this->_cpus = std::min< size_t >( this->_cpus, numeric_cast< size_t >( this->_memorySize / pageSize ) );
+        
+        this->_header = { 0x7F, 'E', 'L', 'F', 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        put( 4, 2 );                   /* ET_CORE */
+        put( 0x3E, 2 );                /* EM_X86_64 */
+        put( 1, 4 );
+        put( 0, 8 );
+        put( 64, 8 );                  /* Program headers */
+        put( 0, 8 );
+        put( 0, 4 );
+        put( 64, 2 );
+        put( 56, 2 );
+        put( 1, 2 );
+        put( 0, 2 );
+        put( 0, 2 );
+        put( 0, 2 );
+        
+        put( 1, 4 );                   /* PT_LOAD */
+        put( 6, 4 );
+        put( headerSize, 8 );
+        put( 0, 8 );
+        put( 0, 8 );
+        put( this->_memorySize, 8 );
+        put( this->_memorySize, 8 );
+        put( pageSize, 8 );
+        
+        this->_header.resize( headerSize, 0 );
+    }
+    
+    /* SplitMix64 finalizer */
+    uint64_t SyntheticBackend::IMPL::_mix( uint64_t value )
+    {
+        value = ( value ^ ( value >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+        value = ( value ^ ( value >> 27 ) ) * 0x94D049BB133111EBULL;
+        
+        return value ^ ( value >> 31 );
+    }
+    
+    uint64_t SyntheticBackend::IMPL::_next( Guest & guest )
+    {
+        guest.random += 0x9E3779B97F4A7C15ULL;
+        
+        return _mix( guest.random );
+    }
+    
+    /* FNV-1a, as std::hash is not the same everywhere */
+    uint64_t SyntheticBackend::IMPL::_hash( const std::string & s )
+    {
+        uint64_t hash( 0xCBF29CE484222325ULL );
+        
+        for( char c: s )
+        {
+            hash = ( hash ^ static_cast< uint8_t >( c ) ) * 0x100000001B3ULL;
+        }
+        
+        return hash;
+    }
+    
+    /*
+     * Memory starts zeroed, apart from the code the vCPUs run, and each
+     * vCPU has its own region of memory, with its stack at the top.
+     */
+    std::unique_ptr< SyntheticBackend::IMPL::Guest > SyntheticBackend::IMPL::_create( const std::string & vmName )
+    {
+        std::unique_ptr< Guest > guest( std::make_unique< Guest >() );
+        
+        guest->random = this->_seed ^ _hash( vmName );
+        
+        guest->memory.resize( numeric_cast< size_t >( this->_memorySize ) );
+        
+        for( uint64_t i = 0; i < codeSize; i += sizeof( uint64_t ) )
+        {
+            uint64_t value( _next( *( guest ) ) );
+            
+            memcpy( guest->memory.data() + codeAddress + i, &value, sizeof( value ) );
+        }
+        
+        for( size_t i = 0; i < this->_cpus; i++ )
+        {
+            VM::Registers regs;
+            uint64_t      top( this->_regionEnd( i ) - pageSize );
+            
+            regs.rip( codeAddress );
+            regs.rsp( top );
+            regs.rbp( top );
+            regs.eflags( 0x202 );
+            
+            guest->cpus.push_back( regs );
+            guest->cursors.push_back( this->_regionStart( i ) / pageSize );
+        }
+        
+        return guest;
+    }
+    
+    void SyntheticBackend::IMPL::_step( Guest & guest )
+    {
+        for( size_t i = 0; i < guest.cpus.size(); i++ )
+        {
+            VM::Registers & regs( guest.cpus[ i ] );
+            uint64_t        r( _next( guest ) );
+            uint64_t        rip( regs.rip() + 1 + ( r % 15 ) );
+            
+            if( rip >= codeAddress + codeSize )
+            {
+                rip = codeAddress + ( ( r >> 4 ) % codeSize );
+            }
+            
+            regs.rip( rip );
+            regs.eflags( 0x202 | ( ( r >> 24 ) & 0x8D5 ) );
+            
+            if( ( ( r >> 8 ) & 3 ) == 0 )
+            {
+                regs.value( static_cast< VM::Registers::ID >( ( r >> 12 ) % 14 ), _next( guest ) );
+            }
+            
+            if( ( ( r >> 10 ) & 7 ) == 0 )
+            {
+                uint64_t top( this->_regionEnd( i ) - pageSize );
+                uint64_t rsp( top - ( ( r >> 32 ) & 0x7F8 ) );
+                
+                regs.rsp( rsp );
+                regs.rbp( rsp + 0x10 + ( ( r >> 48 ) & 0xF0 ) );
+            }
+        }
+    }
+    
+    /*
+     * Each vCPU writes a few words in pages around a cursor that wanders
+     * through its region, so writes have some locality.
+     */
+    void SyntheticBackend::IMPL::_write( Guest & guest )
+    {
+        for( size_t i = 0; i < this->_writeRate; i++ )
+        {
+            size_t   cpu( i % guest.cpus.size() );
+            uint64_t first( this->_regionStart( cpu ) / pageSize );
+            uint64_t pages( this->_regionEnd( cpu ) / pageSize - first );
+            uint64_t r( _next( guest ) );
+            uint64_t page;
+            
+            guest.cursors[ cpu ] = first + ( guest.cursors[ cpu ] - first + pages + ( r % 17 ) - 8 ) % pages;
+            page                 = guest.cursors[ cpu ];
+            
+            for( size_t j = 0; j < wordsPerWrite; j++ )
+            {
+                uint64_t value( _next( guest ) );
+                uint64_t offset( page * pageSize + ( ( value >> 52 ) % ( pageSize / sizeof( uint64_t ) ) ) * sizeof( uint64_t ) );
+                
+                memcpy( guest.memory.data() + offset, &value, sizeof( value ) );
+            }
+        }
+    }
+    
+    uint64_t SyntheticBackend::IMPL::_regionStart( size_t cpu ) const
+    {
+        return ( ( this->_memorySize / pageSize ) * cpu / this->_cpus ) * pageSize;
+    }
+    
+    uint64_t SyntheticBackend::IMPL::_regionEnd( size_t cpu ) const
+    {
+        return this->_regionStart( cpu + 1 );
+    }
+}
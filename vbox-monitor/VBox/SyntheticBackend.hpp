@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_SYNTHETIC_BACKEND_HPP
+#define VBOX_SYNTHETIC_BACKEND_HPP
+
+#include "VBox/Backend.hpp"
+#include <cstdint>
+#include <memory>
+
+namespace VBox
+{
+    /*
+     * An in-process guest for load testing, which needs no VirtualBox.
+     * Registering always succeeds, and every started VM gets its own guest,
+     * seeded from its name, so the same calls always produce the same
+     * samples.
+     * The guest advances with each sample: every register sample runs all
+     * vCPUs for a step, and every capture first dirties writeRate pages
+     * around the vCPUs' working sets. The stack is stackDepth frames,
+     * derived from the first vCPU's registers.
+     * A halted guest does not advance, as a guest sitting in its idle
+     * loop, so every sample is the same until it is resumed.
+     * Requests never block, so stop tokens are ignored.
+     */
+    class SyntheticBackend: public Backend
+    {
+        public:
+            
+            static constexpr uint64_t defaultMemorySize = 64 * 1024 * 1024;
+            static constexpr size_t   defaultWriteRate  = 256;
+            static constexpr size_t   defaultCPUs       = 1;
+            static constexpr size_t   defaultStackDepth = 16;
+            static constexpr uint64_t minimumMemorySize = 4 * 1024 * 1024;
+            
+            SyntheticBackend( uint64_t memorySize = defaultMemorySize, size_t writeRate = defaultWriteRate, size_t cpus = defaultCPUs, size_t stackDepth = defaultStackDepth, uint64_t seed = 0 );
+            ~SyntheticBackend( void ) override;
+            
+            SyntheticBackend( const SyntheticBackend & o )              = delete;
+            SyntheticBackend( SyntheticBackend && o )                   = delete;
+            SyntheticBackend & operator =( const SyntheticBackend & o ) = delete;
+            SyntheticBackend & operator =( SyntheticBackend && o )      = delete;
+            
+            uint64_t memorySize( void ) const;
+            size_t   writeRate( void )  const;
+            size_t   cpus( void )       const;
+            size_t   stackDepth( void ) const;
+            uint64_t seed( void )       const;
+            bool     halted( void )     const;
+            
+            void halted( bool value );
+            
+            bool registerVM( const std::string & path )     override;
+            bool unregisterVM( const std::string & vmName ) override;
+            bool startVM( const std::string & vmName )      override;
+            bool powerOffVM( const std::string & vmName )   override;
+            
+            std::vector< VM::Info > runningVMs( const StopToken & token )                              override;
+            std::optional< pid_t >  hostProcess( const std::string & vmName, const StopToken & token ) override;
+            
+            Error registers( const std::string & vmName, VM::Registers & registers, const StopToken & token )                                                        override;
+            Error stack( const std::string & vmName, std::vector< VM::StackEntry > & stack, const StopToken & token )                                                override;
+            Error capture( const std::string & vmName, VM::DumpTarget & target, std::optional< ELF::File > & elf, const StopToken & token )                          override;
+            Error read( const std::string & vmName, const std::vector< std::pair< uint64_t, uint64_t > > & ranges, VM::PartialCore & core, const StopToken & token ) override;
+            
+            uint64_t memorySize( const std::string & vmName, const StopToken & token ) override;
+            
+        private:
+            
+            class IMPL;
+            std::unique_ptr< IMPL > impl;
+    };
+}
+
+#endif /* VBOX_SYNTHETIC_BACKEND_HPP */
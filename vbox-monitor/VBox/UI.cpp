@@ -29,6 +29,8 @@
 #include "VBox/Monitor.hpp"
 #include "VBox/Casts.hpp"
 #include "VBox/Capstone.hpp"
+#include "VBox/Stats.hpp"
+#include "VBox/Allocations.hpp"
 #include <ncurses.h>
 
 namespace VBox
@@ -37,37 +39,60 @@ namespace VBox
     {
         public:
             
-            IMPL( const std::string & vmName );
+            IMPL( const std::string & vmName, std::shared_ptr< VM::PageStore > pages );
             IMPL( const IMPL & o );
             
             void _setup( void );
+            void _layout( void );
+            void _setNeedsDisplay( void );
+            void _updateSubscriptions( void );
+            void _subscribe( uint64_t & subscription, std::optional< std::pair< uint64_t, uint64_t > > range );
+            void _updateErrors( void );
             void _drawTitle( void );
             void _drawRegisters( void );
             void _drawStack( void );
             void _drawDisassembly( void );
             void _drawMemory( void );
+            void _drawStats( void );
             
             void _memoryScrollUp( size_t n = 1 );
             void _memoryScrollDown( size_t n = 1 );
             void _memoryPageUp( void );
             void _memoryPageDown( void );
             
-            bool                            _running;
-            bool                            _paused;
-            std::string                     _vmName;
-            Monitor                         _monitor;
-            size_t                          _memoryOffset;
-            size_t                          _memoryBytesPerLine;
-            size_t                          _memoryLines;
-            size_t                          _totalMemory;
-            std::optional< VM::Registers >  _registers;
-            std::vector< VM::StackEntry >   _stack;
-            std::shared_ptr< VM::CoreDump > _dump;
-            std::optional< std::string >    _memoryAddressPrompt;
+            bool                                                   _running;
+            bool                                                   _paused;
+            bool                                                   _showStats;
+            std::string                                            _vmName;
+            Monitor                                                _monitor;
+            size_t                                                 _memoryOffset;
+            size_t                                                 _memoryBytesPerLine;
+            size_t                                                 _memoryLines;
+            size_t                                                 _totalMemory;
+            uint64_t                                               _memorySubscription;
+            uint64_t                                               _disassemblySubscription;
+            std::shared_ptr< const VM::Registers >                 _registers;
+            std::shared_ptr< const VM::RegisterHistory >           _registerHistory;
+            std::shared_ptr< const std::vector< VM::StackEntry > > _stack;
+            std::shared_ptr< VM::CoreDump >                        _dump;
+            std::optional< std::string >                           _memoryAddressPrompt;
+            std::string                                            _errors;
+            std::optional< Window >                                _titleWindow;
+            std::optional< Window >                                _registersWindow;
+            std::optional< Window >                                _stackWindow;
+            std::optional< Window >                                _disassemblyWindow;
+            std::optional< Window >                                _memoryWindow;
+            std::optional< Window >                                _statsWindow;
+            bool                                                   _titleNeedsDisplay;
+            bool                                                   _registersNeedsDisplay;
+            bool                                                   _stackNeedsDisplay;
+            bool                                                   _disassemblyNeedsDisplay;
+            bool                                                   _memoryNeedsDisplay;
+            bool                                                   _statsNeedsDisplay;
     };
     
-    UI::UI( const std::string & vmName ):
-        impl( std::make_unique< IMPL >( vmName ) )
+    UI::UI( const std::string & vmName, std::shared_ptr< VM::PageStore > pages ):
+        impl( std::make_unique< IMPL >( vmName, pages ) )
     {}
     
     UI::UI( const UI & o ):
@@ -99,6 +124,11 @@ namespace VBox
         Screen::shared().start();
     }
     
+    void UI::sampling( std::chrono::microseconds floor, std::chrono::microseconds ceiling )
+    {
+        this->impl->_monitor.sampling( floor, ceiling );
+    }
+    
     void swap( UI & o1, UI & o2 )
     {
         using std::swap;
@@ -106,53 +136,134 @@ namespace VBox
         swap( o1.impl, o2.impl );
     }
     
-    UI::IMPL::IMPL( const std::string & vmName ):
-        _running(            false ),
-        _paused(             false ),
-        _vmName(             vmName ),
-        _monitor(            vmName ),
-        _memoryOffset(       0 ),
-        _memoryBytesPerLine( 0 ),
-        _memoryLines(        0 ),
-        _totalMemory(        0 )
+    UI::IMPL::IMPL( const std::string & vmName, std::shared_ptr< VM::PageStore > pages ):
+        _running(                 false ),
+        _paused(                  false ),
+        _showStats(               false ),
+        _vmName(                  vmName ),
+        _monitor(                 vmName, pages ),
+        _memoryOffset(            0 ),
+        _memoryBytesPerLine(      0 ),
+        _memoryLines(             0 ),
+        _totalMemory(             0 ),
+        _memorySubscription(      0 ),
+        _disassemblySubscription( 0 ),
+        _titleNeedsDisplay(       true ),
+        _registersNeedsDisplay(   true ),
+        _stackNeedsDisplay(       true ),
+        _disassemblyNeedsDisplay( true ),
+        _memoryNeedsDisplay(      true ),
+        _statsNeedsDisplay(       true )
     {
         this->_setup();
     }
     
     UI::IMPL::IMPL( const IMPL & o ):
-        _running(            false ),
-        _paused(             o._paused ),
-        _vmName(             o._vmName ),
-        _monitor(            o._monitor ),
-        _memoryOffset(       o._memoryOffset ),
-        _memoryBytesPerLine( o._memoryBytesPerLine ),
-        _memoryLines(        o._memoryLines ),
-        _totalMemory(        o._totalMemory ),
-        _registers(          o._registers ),
-        _stack(              o._stack ),
-        _dump(               o._dump )
+        _running(                 false ),
+        _paused(                  o._paused ),
+        _showStats(               o._showStats ),
+        _vmName(                  o._vmName ),
+        _monitor(                 o._monitor ),
+        _memoryOffset(            o._memoryOffset ),
+        _memoryBytesPerLine(      o._memoryBytesPerLine ),
+        _memoryLines(             o._memoryLines ),
+        _totalMemory(             o._totalMemory ),
+        _memorySubscription(      o._memorySubscription ),
+        _disassemblySubscription( o._disassemblySubscription ),
+        _registers(               o._registers ),
+        _registerHistory(         o._registerHistory ),
+        _stack(                   o._stack ),
+        _dump(                    o._dump ),
+        _titleNeedsDisplay(       true ),
+        _registersNeedsDisplay(   true ),
+        _stackNeedsDisplay(       true ),
+        _disassemblyNeedsDisplay( true ),
+        _memoryNeedsDisplay(      true ),
+        _statsNeedsDisplay(       true )
     {
         this->_setup();
     }
     
     void UI::IMPL::_setup( void )
     {
+        this->_layout();
+        
+        this->_monitor.onUpdate
+        (
+            []( void )
+            {
+                Screen::shared().setNeedsUpdate();
+            }
+        );
+        
+        Screen::shared().onResize
+        (
+            [ & ]( void )
+            {
+                Screen::shared().clear();
+                Screen::shared().refresh();
+                
+                this->_layout();
+            }
+        );
+        
         Screen::shared().onUpdate
         (
             [ & ]( void )
             {
                 if( this->_paused == false )
                 {
-                    this->_registers = this->_monitor.registers();
-                    this->_stack     = this->_monitor.stack();
-                    this->_dump      = this->_monitor.dump();
+                    std::shared_ptr< const VM::Registers >                 registers( this->_monitor.registers() );
+                    std::shared_ptr< const VM::RegisterHistory >           history(   this->_monitor.registerHistory() );
+                    std::shared_ptr< const std::vector< VM::StackEntry > > stack(     this->_monitor.stack() );
+                    std::shared_ptr< VM::CoreDump >                        dump(      this->_monitor.dump() );
+                    
+                    /* Snapshots are immutable, so a new pointer means new data */
+                    if( registers != this->_registers || history != this->_registerHistory )
+                    {
+                        this->_registers               = registers;
+                        this->_registerHistory         = history;
+                        this->_registersNeedsDisplay   = true;
+                        this->_disassemblyNeedsDisplay = true;
+                    }
+                    
+                    if( stack != this->_stack )
+                    {
+                        this->_stack             = stack;
+                        this->_stackNeedsDisplay = true;
+                    }
+                    
+                    if( dump != this->_dump )
+                    {
+                        this->_dump                    = dump;
+                        this->_disassemblyNeedsDisplay = true;
+                        this->_memoryNeedsDisplay      = true;
+                    }
                 }
                 
-                this->_drawTitle();
-                this->_drawRegisters();
-                this->_drawStack();
-                this->_drawDisassembly();
-                this->_drawMemory();
+                this->_updateSubscriptions();
+                this->_updateErrors();
+                
+                if( this->_showStats )
+                {
+                    this->_statsNeedsDisplay = true;
+                }
+                
+                {
+                    Stats::Scope scope( Stats::Channel::UI, Stats::Stage::Render );
+                    
+                    this->_drawTitle();
+                    this->_drawRegisters();
+                    this->_drawStack();
+                    this->_drawDisassembly();
+                    this->_drawMemory();
+                    this->_drawStats();
+                }
+                
+                if( this->_registers != nullptr )
+                {
+                    Stats::shared().reach( Stats::Milestone::FirstFrame );
+                }
                 
                 if( this->_monitor.live() == false )
                 {
@@ -166,6 +277,11 @@ namespace VBox
         (
             [ & ]( int key )
             {
+                this->_titleNeedsDisplay  = true;
+                this->_memoryNeedsDisplay = true;
+                
+                this->_monitor.interact();
+                
                 if( key == 'q' )
                 {
                     this->_monitor.stop();
@@ -232,16 +348,191 @@ namespace VBox
                     {
                         this->_paused = ( this->_paused ) ? false : true;
                     }
+                    else if( key == 'i' )
+                    {
+                        this->_showStats = ( this->_showStats ) ? false : true;
+                        
+                        Screen::shared().clear();
+                        Screen::shared().refresh();
+                        
+                        this->_layout();
+                    }
                 }
             }
         );
     }
     
+    void UI::IMPL::_layout( void )
+    {
+        size_t width(  Screen::shared().width() );
+        size_t height( Screen::shared().height() );
+        
+        this->_titleWindow.emplace( 0, 0, width, 3 );
+        
+        if( this->_showStats && width >= 40 && height >= 25 )
+        {
+            this->_statsWindow.emplace( 0, 3, width, 22 );
+        }
+        else
+        {
+            this->_statsWindow.reset();
+        }
+        
+        if( this->_showStats == false && width >= 40 && height >= 25 )
+        {
+            this->_registersWindow.emplace( 0, 3, 40, 22 );
+        }
+        else
+        {
+            this->_registersWindow.reset();
+        }
+        
+        if( this->_showStats == false && width >= 190 && height >= 25 )
+        {
+            this->_stackWindow.emplace( 40, 3, 150, 22 );
+        }
+        else
+        {
+            this->_stackWindow.reset();
+        }
+        
+        if( this->_showStats == false && width >= 230 && height >= 25 )
+        {
+            this->_disassemblyWindow.emplace( 190, 3, width - 190, 22 );
+        }
+        else
+        {
+            this->_disassemblyWindow.reset();
+        }
+        
+        if( width >= 30 && height >= 35 )
+        {
+            this->_memoryWindow.emplace( 0, 25, width, height - 25 );
+        }
+        else
+        {
+            this->_memoryWindow.reset();
+        }
+        
+        this->_setNeedsDisplay();
+    }
+    
+    void UI::IMPL::_setNeedsDisplay( void )
+    {
+        this->_titleNeedsDisplay       = true;
+        this->_registersNeedsDisplay   = true;
+        this->_stackNeedsDisplay       = true;
+        this->_disassemblyNeedsDisplay = true;
+        this->_memoryNeedsDisplay      = true;
+        this->_statsNeedsDisplay       = true;
+    }
+    
+    /*
+     * The monitor only captures guest memory for the panes that show it,
+     * so nothing is dumped while they are hidden or the UI is paused.
+     */
+    void UI::IMPL::_updateSubscriptions( void )
+    {
+        std::optional< std::pair< uint64_t, uint64_t > > memory;
+        std::optional< std::pair< uint64_t, uint64_t > > disassembly;
+        
+        if( this->_paused == false && this->_memoryWindow.has_value() )
+        {
+            size_t cols(  this->_memoryWindow->width()  - 4 );
+            size_t lines( this->_memoryWindow->height() - 4 );
+            
+            memory = { this->_memoryOffset, ( ( cols / 4 ) - 5 ) * lines };
+        }
+        
+        if( this->_paused == false && this->_disassemblyWindow.has_value() && this->_registers != nullptr )
+        {
+            disassembly = { this->_registers->rip(), 512 };
+        }
+        
+        this->_subscribe( this->_memorySubscription,      memory );
+        this->_subscribe( this->_disassemblySubscription, disassembly );
+    }
+    
+    void UI::IMPL::_subscribe( uint64_t & subscription, std::optional< std::pair< uint64_t, uint64_t > > range )
+    {
+        if( range.has_value() == false )
+        {
+            if( subscription != 0 )
+            {
+                this->_monitor.unsubscribe( subscription );
+            }
+            
+            subscription = 0;
+        }
+        else if( subscription == 0 )
+        {
+            subscription = this->_monitor.subscribe( range->first, range->second );
+        }
+        else
+        {
+            this->_monitor.resubscribe( subscription, range->first, range->second );
+        }
+    }
+    
+    /*
+     * Failing channels are summed up in the title bar, with their total
+     * failures, their recent rate and the last error. Channels that have
+     * stopped retrying until the VM's state changes are shown as parked.
+     */
+    void UI::IMPL::_updateErrors( void )
+    {
+        std::string errors;
+        
+        for( Stats::Channel channel: { Stats::Channel::Registers, Stats::Channel::Stack, Stats::Channel::Memory } )
+        {
+            Backoff backoff( this->_monitor.backoff( channel ) );
+            char    buf[ 128 ];
+            
+            if( backoff.failures() == 0 )
+            {
+                continue;
+            }
+            
+            snprintf( buf, sizeof( buf ), "%s %llu (%.1f/s", Stats::name( channel ).c_str(), static_cast< unsigned long long >( backoff.failures() ), backoff.rate() );
+            
+            errors += ( ( errors.length() > 0 ) ? ", " : "" ) + std::string( buf );
+            
+            switch( backoff.error() )
+            {
+                case Backend::Error::None:        break;
+                case Backend::Error::Spawn:       errors += ", cannot run VBoxManage"; break;
+                case Backend::Error::NotRunning:  errors += ", not running";           break;
+                case Backend::Error::Busy:        errors += ", busy";                  break;
+                case Backend::Error::Failed:      errors += ", failed";                break;
+                case Backend::Error::Output:      errors += ", invalid output";        break;
+                case Backend::Error::Unsupported: errors += ", unsupported";           break;
+                case Backend::Error::Cancelled:   errors += ", cancelled";             break;
+                case Backend::Error::Timeout:     errors += ", timed out";             break;
+            }
+            
+            errors += ( backoff.open() ) ? ", parked)" : ")";
+        }
+        
+        if( errors != this->_errors )
+        {
+            this->_errors            = errors;
+            this->_titleNeedsDisplay = true;
+        }
+    }
+    
     void UI::IMPL::_drawTitle( void )
     {
-        Window win( 0, 0, Screen::shared().width(), 3 );
+        if( this->_titleNeedsDisplay == false || this->_titleWindow.has_value() == false )
+        {
+            return;
+        }
+        
+        this->_titleNeedsDisplay = false;
         
         {
+            Window & win( this->_titleWindow.value() );
+            
+            win.clear();
             win.box();
             win.move( 2, 1 );
             win.print( "VirtualBox: ");
@@ -251,43 +542,52 @@ namespace VBox
             {
                 win.print( Color::red(), " [PAUSED]" );
             }
+            
+            if( this->_errors.length() > 0 )
+            {
+                win.print( " - " );
+                win.print( Color::red(), "Errors: %s", this->_errors.c_str() );
+            }
+            
+            win.noutrefresh();
         }
-        
-        Screen::shared().refresh();
-        win.refresh();
     }
     
     void UI::IMPL::_drawRegisters( void )
     {
-        if( Screen::shared().width() < 30 || Screen::shared().height() < 25 )
+        if( this->_registersNeedsDisplay == false || this->_registersWindow.has_value() == false )
         {
             return;
         }
         
+        this->_registersNeedsDisplay = false;
+        
         {
-            Window win( 0, 3, 30, 22 );
+            Window & win( this->_registersWindow.value() );
             
             {
+                win.clear();
                 win.box();
                 win.move( 2, 1 );
                 win.print( Color::blue(), "CPU Registers:" );
                 win.move( 1, 2 );
-                win.addHorizontalLine( 28 );
+                win.addHorizontalLine( win.width() - 2 );
             }
             
             {
+                std::shared_ptr< const VM::Registers >       regs(    this->_registers );
+                std::shared_ptr< const VM::RegisterHistory > history( this->_registerHistory );
                 
-                std::optional< VM::Registers > regs( this->_registers );
-                
-                if( regs.has_value() )
+                if( regs != nullptr && history != nullptr )
                 {
                     size_t y( 3 );
                     
-                    for( const auto & p: regs.value().all() )
+                    for( size_t i = 0; i < VM::Registers::count; i++ )
                     {
-                        std::string reg( String::toUpper( p.first ) );
+                        VM::Registers::ID id( static_cast< VM::Registers::ID >( i ) );
+                        std::string       reg( String::toUpper( VM::Registers::name( id ) ) );
                         
-                        for( size_t i = reg.size(); i < 6; i++ )
+                        for( size_t j = reg.size(); j < 6; j++ )
                         {
                             reg = " " + reg;
                         }
@@ -295,29 +595,33 @@ namespace VBox
                         win.move( 2, y );
                         win.print( Color::cyan(), reg );
                         win.print( ": " );
-                        win.print( Color::yellow(), String::toHex( p.second ) );
+                        win.print( ( history->changed( id ) ) ? Color::red() : Color::yellow(), String::toHex( regs->value( id ) ) );
+                        win.print( " " );
+                        win.print( Color::magenta(), history->sparkline( id, 8 ) );
                         
                         y++;
                     }
                 }
             }
             
-            Screen::shared().refresh();
-            win.refresh();
+            win.noutrefresh();
         }
     }
     
     void UI::IMPL::_drawStack( void )
     {
-        if( Screen::shared().width() < 180 || Screen::shared().height() < 25 )
+        if( this->_stackNeedsDisplay == false || this->_stackWindow.has_value() == false )
         {
             return;
         }
         
+        this->_stackNeedsDisplay = false;
+        
         {
-            Window win( 30, 3, 150, 22 );
+            Window & win( this->_stackWindow.value() );
             
             {
+                win.clear();
                 win.box();
                 win.move( 2, 1 );
                 win.print( Color::blue(), "Stack:" );
@@ -347,10 +651,10 @@ namespace VBox
             }
             
             {
-                std::vector< VM::StackEntry > stack( this->_stack );
-                size_t                        y( 5 );
+                std::shared_ptr< const std::vector< VM::StackEntry > > entries( this->_stack );
+                size_t                                                 y( 5 );
                 
-                for( size_t i = 0; i < stack.size(); i++ )
+                for( size_t i = 0; entries != nullptr && i < entries->size(); i++ )
                 {
                     if( i == 16 )
                     {
@@ -359,74 +663,76 @@ namespace VBox
                     
                     win.move( 2, y );
                     
-                    win.print( Color::cyan(), String::toHex( stack[ i ].bp().segment() ) );
+                    win.print( Color::cyan(), String::toHex( entries->at( i ).bp().segment() ) );
                     win.print( ":" );
-                    win.print( Color::yellow(), String::toHex( stack[ i ].bp().address() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).bp().address() ) );
                     win.print( " | " );
                     
-                    win.print( Color::cyan(), String::toHex( stack[ i ].retBP().segment() ) );
+                    win.print( Color::cyan(), String::toHex( entries->at( i ).retBP().segment() ) );
                     win.print( ":" );
-                    win.print( Color::yellow(), String::toHex( stack[ i ].retBP().address() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).retBP().address() ) );
                     win.print( " | " );
                     
-                    win.print( Color::cyan(), String::toHex( stack[ i ].retIP().segment() ) );
+                    win.print( Color::cyan(), String::toHex( entries->at( i ).retIP().segment() ) );
                     win.print( ":" );
-                    win.print( Color::yellow(), String::toHex( stack[ i ].retIP().address() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).retIP().address() ) );
                     win.print( " | " );
                     
-                    win.print( Color::yellow(), String::toHex( stack[ i ].arg0() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).arg0() ) );
                     win.print( " | " );
-                    win.print( Color::yellow(), String::toHex( stack[ i ].arg1() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).arg1() ) );
                     win.print( " | " );
-                    win.print( Color::yellow(), String::toHex( stack[ i ].arg2() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).arg2() ) );
                     win.print( " | " );
-                    win.print( Color::yellow(), String::toHex( stack[ i ].arg3() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).arg3() ) );
                     win.print( " | " );
                     
-                    win.print( Color::cyan(), String::toHex( stack[ i ].ip().segment() ) );
+                    win.print( Color::cyan(), String::toHex( entries->at( i ).ip().segment() ) );
                     win.print( ":" );
-                    win.print( Color::yellow(), String::toHex( stack[ i ].ip().address() ) );
+                    win.print( Color::yellow(), String::toHex( entries->at( i ).ip().address() ) );
                     
                     y++;
                 }
             }
             
-            Screen::shared().refresh();
-            win.refresh();
+            win.noutrefresh();
         }
     }
     
     void UI::IMPL::_drawDisassembly( void )
     {
-        if( Screen::shared().width() < 220 || Screen::shared().height() < 25 )
+        if( this->_disassemblyNeedsDisplay == false || this->_disassemblyWindow.has_value() == false )
         {
             return;
         }
         
+        this->_disassemblyNeedsDisplay = false;
+        
         {
-            Window win( 180, 3, Screen::shared().width() - 180, 22 );
+            Window & win( this->_disassemblyWindow.value() );
             
             {
+                win.clear();
                 win.box();
                 win.move( 2, 1 );
                 win.print( Color::blue(), "Disassembly:" );
                 win.move( 1, 2 );
-                win.addHorizontalLine( Screen::shared().width() - 182 );
+                win.addHorizontalLine( win.width() - 2 );
             }
             
             {
-                std::shared_ptr< VM::CoreDump > dump( this->_dump );
-                std::optional< VM::Registers >  regs( this->_registers );
+                std::shared_ptr< VM::CoreDump >        dump( this->_dump );
+                std::shared_ptr< const VM::Registers > regs( this->_registers );
                 
-                if( dump != nullptr && dump->memorySize() > 0 && regs.has_value() )
+                if( dump != nullptr && dump->memorySize() > 0 && regs != nullptr )
                 {
-                    std::vector< uint8_t > code( dump->readMemory( regs.value().rip(), 512 ) );
+                    std::vector< uint8_t > code( dump->readMemory( regs->rip(), 512 ) );
                     
                     if( code.size() > 0 )
                     {
                         size_t y( 2 );
                         
-                        for( const auto & p: Capstone::disassemble( code, regs.value().rip() ) )
+                        for( const auto & p: Capstone::disassemble( code, regs->rip() ) )
                         {
                             if( y > 19 )
                             {
@@ -442,27 +748,29 @@ namespace VBox
                 }
             }
             
-            Screen::shared().refresh();
-            win.refresh();
+            win.noutrefresh();
         }
     }
     
     void UI::IMPL::_drawMemory( void )
     {
-        if( Screen::shared().width() < 30 || Screen::shared().height() < 35 )
+        if( this->_memoryNeedsDisplay == false || this->_memoryWindow.has_value() == false )
         {
             return;
         }
         
+        this->_memoryNeedsDisplay = false;
+        
         {
-            Window win( 0, 25, Screen::shared().width(), Screen::shared().height() - 25 );
+            Window & win( this->_memoryWindow.value() );
             
             {
+                win.clear();
                 win.box();
                 win.move( 2, 1 );
                 win.print( Color::blue(), "Memory:" );
                 win.move( 1, 2 );
-                win.addHorizontalLine( Screen::shared().width() - 2 );
+                win.addHorizontalLine( win.width() - 2 );
             }
             
             if( this->_memoryAddressPrompt.has_value() )
@@ -479,10 +787,10 @@ namespace VBox
                 if( dump != nullptr && dump->memorySize() > 0 )
                 {
                     size_t y( 2 );
-                    size_t cols(  Screen::shared().width()  - 4 );
-                    size_t lines( Screen::shared().height() - 29 );
+                    size_t cols(  win.width()  - 4 );
+                    size_t lines( win.height() - 4 );
                     
-                    this->_totalMemory        = dump->memorySize();
+                    this->_totalMemory        = std::max( dump->memorySize(), this->_monitor.memorySize() );
                     this->_memoryBytesPerLine = ( cols / 4 ) - 5;
                     this->_memoryLines        = lines;
                     
@@ -531,8 +839,155 @@ namespace VBox
                 }
             }
             
-            Screen::shared().refresh();
-            win.refresh();
+            win.noutrefresh();
+        }
+    }
+    
+    void UI::IMPL::_drawStats( void )
+    {
+        if( this->_statsNeedsDisplay == false || this->_statsWindow.has_value() == false )
+        {
+            return;
+        }
+        
+        this->_statsNeedsDisplay = false;
+        
+        {
+            Window & win( this->_statsWindow.value() );
+            
+            auto format = []( uint64_t ns ) -> std::string
+            {
+                char buf[ 32 ];
+                
+                if( ns < 1000 )
+                {
+                    snprintf( buf, sizeof( buf ), "%lluns", static_cast< unsigned long long >( ns ) );
+                }
+                else if( ns < 1000000 )
+                {
+                    snprintf( buf, sizeof( buf ), "%.1fus", static_cast< double >( ns ) / 1e3 );
+                }
+                else if( ns < 1000000000 )
+                {
+                    snprintf( buf, sizeof( buf ), "%.1fms", static_cast< double >( ns ) / 1e6 );
+                }
+                else
+                {
+                    snprintf( buf, sizeof( buf ), "%.2fs", static_cast< double >( ns ) / 1e9 );
+                }
+                
+                return buf;
+            };
+            
+            {
+                win.clear();
+                win.box();
+                win.move( 2, 1 );
+                win.print( Color::blue(), "Latency (p50 / p99 / max):" );
+                win.move( 1, 2 );
+                win.addHorizontalLine( win.width() - 2 );
+            }
+            
+            {
+                win.move( 2, 3 );
+                win.print( Color::blue(), "%-12s", "Channel:" );
+                
+                for( size_t i = 0; i < Stats::stages; i++ )
+                {
+                    win.print( "| " );
+                    win.print( Color::blue(), "%-26s", ( Stats::name( static_cast< Stats::Stage >( i ) ) + ":" ).c_str() );
+                }
+                
+                win.move( 1, 4 );
+                win.addHorizontalLine( win.width() - 2 );
+            }
+            
+            {
+                size_t y( 5 );
+                
+                for( size_t i = 0; i < Stats::channels; i++ )
+                {
+                    Stats::Channel channel( static_cast< Stats::Channel >( i ) );
+                    
+                    win.move( 2, y );
+                    win.print( Color::cyan(), "%-12s", Stats::name( channel ).c_str() );
+                    
+                    for( size_t j = 0; j < Stats::stages; j++ )
+                    {
+                        const Histogram & h( Stats::shared().histogram( channel, static_cast< Stats::Stage >( j ) ) );
+                        
+                        win.print( "| " );
+                        
+                        if( h.count() == 0 )
+                        {
+                            win.print( "%-26s", "-" );
+                        }
+                        else
+                        {
+                            std::string s( format( h.percentile( 50 ) ) + " / " + format( h.percentile( 99 ) ) + " / " + format( h.max() ) );
+                            
+                            win.print( Color::yellow(), "%-26s", s.c_str() );
+                        }
+                    }
+                    
+                    y++;
+                }
+                
+                win.move( 2, y + 1 );
+                win.print( Color::blue(), "Allocations: " );
+                win.print( Color::yellow(), "%llu", static_cast< unsigned long long >( Allocations::count() ) );
+                win.print( " (" );
+                win.print( Color::yellow(), "%llu", static_cast< unsigned long long >( Allocations::live() ) );
+                win.print( " live, " );
+                win.print( Color::yellow(), "%llu", static_cast< unsigned long long >( Allocations::bytes() ) );
+                win.print( " bytes)" );
+                
+                win.move( 2, y + 2 );
+                win.print( Color::blue(), "Startup: " );
+                
+                for( size_t i = 0; i < Stats::milestones; i++ )
+                {
+                    Stats::Milestone                          milestone( static_cast< Stats::Milestone >( i ) );
+                    std::optional< std::chrono::nanoseconds > elapsed( Stats::shared().elapsed( milestone ) );
+                    
+                    win.print( "%s%s ", ( i == 0 ) ? "" : ", ", Stats::name( milestone ).c_str() );
+                    
+                    if( elapsed.has_value() )
+                    {
+                        win.print( Color::yellow(), "%s", format( static_cast< uint64_t >( elapsed->count() ) ).c_str() );
+                    }
+                    else
+                    {
+                        win.print( "-" );
+                    }
+                }
+                
+                win.move( 2, y + 3 );
+                win.print( Color::blue(), "Memory capture: " );
+                
+                switch( this->_monitor.acquisition() )
+                {
+                    case Monitor::Acquisition::None: win.print( Color::yellow(), "none" );      break;
+                    case Monitor::Acquisition::Read: win.print( Color::yellow(), "reads" );     break;
+                    case Monitor::Acquisition::Dump: win.print( Color::yellow(), "full dump" ); break;
+                }
+                
+                win.move( 2, y + 4 );
+                win.print( Color::blue(), "Sampling interval: " );
+                
+                for( Stats::Channel channel: { Stats::Channel::Registers, Stats::Channel::Stack, Stats::Channel::Memory } )
+                {
+                    std::chrono::nanoseconds interval( this->_monitor.samplingInterval( channel ) );
+                    
+                    win.print( "%s%s ", ( channel == Stats::Channel::Registers ) ? "" : ", ", Stats::name( channel ).c_str() );
+                    win.print( Color::yellow(), "%s", format( static_cast< uint64_t >( interval.count() ) ).c_str() );
+                }
+                
+                win.move( 2, y + 6 );
+                win.print( Color::magenta(), "Press 'i' to return to the debugger panes." );
+            }
+            
+            win.noutrefresh();
         }
     }
     
@@ -28,6 +28,8 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <chrono>
+#include "VBox/VM/PageStore.hpp"
 
 namespace VBox
 {
@@ -35,7 +37,7 @@ namespace VBox
     {
         public:
             
-            UI( const std::string & vmName );
+            UI( const std::string & vmName, std::shared_ptr< VM::PageStore > pages = nullptr );
             UI( const UI & o );
             UI( UI && o );
             ~UI( void );
@@ -43,6 +45,7 @@ namespace VBox
             UI & operator =( UI o );
             
             void run( void );
+            void sampling( std::chrono::microseconds floor, std::chrono::microseconds ceiling );
             
             friend void swap( UI & o1, UI & o2 );
             
@@ -0,0 +1,501 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/VM/AddressSpace.hpp"
+#include "VBox/Casts.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace VBox
+{
+    namespace VM
+    {
+        class AddressSpace::IMPL
+        {
+            public:
+                
+                class Segment
+                {
+                    public:
+                        
+                        uint64_t                _address;
+                        uint64_t                _size;
+                        uint64_t                _offset;
+                        uint64_t                _fileSize;
+                        const uint8_t         * _data;
+                        std::vector< uint64_t > _pages;
+                };
+                
+                IMPL( void );
+                IMPL( const ELF::File & elf, std::shared_ptr< PageStore > store, FileReader * reader );
+                IMPL( const IMPL & o );
+                ~IMPL( void );
+                
+                const Segment * _find( uint64_t address )                                               const;
+                void            _copy( const Segment & segment, uint64_t offset, uint64_t size, uint8_t * buf ) const;
+                void            _ingest( FileReader * reader );
+                void            _add( Segment & segment, const uint8_t * data, uint64_t size );
+                
+                ELF::File                    _elf;
+                std::shared_ptr< PageStore > _store;
+                std::vector< Segment >       _segments;
+                uint64_t                     _size;
+        };
+        
+        AddressSpace::AddressSpace( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        AddressSpace::AddressSpace( const ELF::File & elf ):
+            impl( std::make_unique< IMPL >( elf, nullptr, nullptr ) )
+        {}
+        
+        AddressSpace::AddressSpace( const ELF::File & elf, std::shared_ptr< PageStore > store ):
+            impl( std::make_unique< IMPL >( elf, store, nullptr ) )
+        {}
+        
+        AddressSpace::AddressSpace( const ELF::File & elf, std::shared_ptr< PageStore > store, FileReader & reader ):
+            impl( std::make_unique< IMPL >( elf, store, &reader ) )
+        {}
+        
+        AddressSpace::AddressSpace( const AddressSpace & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        AddressSpace::AddressSpace( AddressSpace && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        AddressSpace::~AddressSpace( void )
+        {}
+        
+        AddressSpace & AddressSpace::operator =( AddressSpace o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        uint64_t AddressSpace::size( void ) const
+        {
+            return this->impl->_size;
+        }
+        
+        uint64_t AddressSpace::end( void ) const
+        {
+            if( this->impl->_segments.size() == 0 )
+            {
+                return 0;
+            }
+            
+            return this->impl->_segments.back()._address + this->impl->_segments.back()._size;
+        }
+        
+        std::vector< std::pair< uint64_t, uint64_t > > AddressSpace::ranges( void ) const
+        {
+            std::vector< std::pair< uint64_t, uint64_t > > ranges;
+            
+            for( const auto & segment: this->impl->_segments )
+            {
+                ranges.push_back( { segment._address, segment._size } );
+            }
+            
+            return ranges;
+        }
+        
+        bool AddressSpace::contains( uint64_t address ) const
+        {
+            return this->impl->_find( address ) != nullptr;
+        }
+        
+        /*
+         * Zero-copy access, only possible when the whole range is backed by
+         * the file within a single segment.
+         */
+        const uint8_t * AddressSpace::data( uint64_t address, uint64_t size ) const
+        {
+            const IMPL::Segment * segment( this->impl->_find( address ) );
+            
+            if( segment == nullptr || segment->_data == nullptr || size > segment->_fileSize || address - segment->_address > segment->_fileSize - size )
+            {
+                return nullptr;
+            }
+            
+            return segment->_data + ( address - segment->_address );
+        }
+        
+        /*
+         * Copies up to the first unmapped address, so a read that runs into a
+         * hole returns the bytes before it. The part of a segment that is not
+         * backed by the file reads as zeros.
+         */
+        std::vector< uint8_t > AddressSpace::read( uint64_t address, uint64_t size ) const
+        {
+            std::vector< uint8_t > data;
+            
+            while( size > 0 )
+            {
+                const IMPL::Segment * segment( this->impl->_find( address ) );
+                uint64_t              offset;
+                uint64_t              n;
+                uint64_t              backed;
+                
+                if( segment == nullptr )
+                {
+                    break;
+                }
+                
+                offset = address - segment->_address;
+                n      = std::min( size, segment->_size - offset );
+                backed = ( offset < segment->_fileSize ) ? std::min( n, segment->_fileSize - offset ) : 0;
+                
+                data.resize( data.size() + n, 0 );
+                this->impl->_copy( *( segment ), offset, backed, data.data() + data.size() - n );
+                
+                address += n;
+                size    -= n;
+                
+                if( address == 0 )
+                {
+                    break;
+                }
+            }
+            
+            return data;
+        }
+        
+        /*
+         * Hashes count pages, counted from the start of the segment holding
+         * address, which must be at a page offset from it. With a page
+         * store, hashes were computed when pages were added and are looked
+         * up rather than recomputed. Safe to call from several threads.
+         */
+        void AddressSpace::hashPages( uint64_t address, size_t count, uint64_t * hashes, bool * zero ) const
+        {
+            const IMPL::Segment * segment( this->impl->_find( address ) );
+            uint64_t              first;
+            
+            if( segment == nullptr || ( address - segment->_address ) % PageStore::pageSize != 0 )
+            {
+                throw std::runtime_error( "Invalid page address" );
+            }
+            
+            first = ( address - segment->_address ) / PageStore::pageSize;
+            
+            if( count > ( segment->_size + PageStore::pageSize - 1 ) / PageStore::pageSize - first )
+            {
+                throw std::runtime_error( "Invalid page count" );
+            }
+            
+            if( segment->_data == nullptr && this->impl->_store != nullptr )
+            {
+                size_t stored( ( first < segment->_pages.size() ) ? std::min( count, numeric_cast< size_t >( segment->_pages.size() - first ) ) : 0 );
+                
+                this->impl->_store->hashes( segment->_pages.data() + first, stored, hashes );
+                
+                for( size_t i = 0; i < count; i++ )
+                {
+                    zero[ i ] = i >= stored || segment->_pages[ first + i ] == PageStore::zeroPage;
+                    
+                    if( i >= stored )
+                    {
+                        hashes[ i ] = PageStore::zeroHash();
+                    }
+                }
+                
+                return;
+            }
+            
+            for( size_t i = 0; i < count; i++ )
+            {
+                uint64_t        offset( ( first + i ) * PageStore::pageSize );
+                uint64_t        backed( ( offset < segment->_fileSize ) ? std::min< uint64_t >( PageStore::pageSize, segment->_fileSize - offset ) : 0 );
+                uint8_t         tmp[ PageStore::pageSize ];
+                const uint8_t * page( tmp );
+                
+                if( backed == PageStore::pageSize )
+                {
+                    page = segment->_data + offset;
+                }
+                else
+                {
+                    memset( tmp, 0, sizeof( tmp ) );
+                    
+                    if( backed > 0 )
+                    {
+                        memcpy( tmp, segment->_data + offset, backed );
+                    }
+                }
+                
+                zero[ i ]   = PageStore::isZero( page );
+                hashes[ i ] = ( zero[ i ] ) ? PageStore::zeroHash() : PageStore::hash( page );
+            }
+        }
+        
+        void swap( AddressSpace & o1, AddressSpace & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        AddressSpace::IMPL::IMPL( void ):
+            _size( 0 )
+        {}
+        
+        /*
+         * Segments are kept sorted by guest-physical address, so lookups are
+         * a binary search. Empty segments are ignored and overlapping ones
+         * rejected.
+         */
+        AddressSpace::IMPL::IMPL( const ELF::File & elf, std::shared_ptr< PageStore > store, FileReader * reader ):
+            _elf(   elf ),
+            _store( store ),
+            _size(  0 )
+        {
+            for( const auto & entry: elf.programHeaders() )
+            {
+                const uint8_t * data;
+                
+                if( entry.type() != 0x01 || entry.memorySize() == 0 )
+                {
+                    continue;
+                }
+                
+                data = elf.data( entry.offset(), entry.fileSize() );
+                
+                if( entry.fileSize() > entry.memorySize() || ( entry.fileSize() > 0 && data == nullptr ) || entry.paddress() + entry.memorySize() - 1 < entry.paddress() )
+                {
+                    throw std::runtime_error( "Invalid core dump - Bad PT_LOAD segment" );
+                }
+                
+                this->_segments.push_back( { entry.paddress(), entry.memorySize(), entry.offset(), entry.fileSize(), data, {} } );
+                
+                this->_size += entry.memorySize();
+            }
+            
+            std::sort
+            (
+                this->_segments.begin(),
+                this->_segments.end(),
+                []( const Segment & s1, const Segment & s2 )
+                {
+                    return s1._address < s2._address;
+                }
+            );
+            
+            for( size_t i = 1; i < this->_segments.size(); i++ )
+            {
+                if( this->_segments[ i ]._address - this->_segments[ i - 1 ]._address < this->_segments[ i - 1 ]._size )
+                {
+                    throw std::runtime_error( "Invalid core dump - Overlapping PT_LOAD segments" );
+                }
+            }
+            
+            if( this->_store != nullptr )
+            {
+                this->_ingest( reader );
+            }
+        }
+        
+        AddressSpace::IMPL::IMPL( const IMPL & o ):
+            _elf(      o._elf ),
+            _store(    o._store ),
+            _segments( o._segments ),
+            _size(     o._size )
+        {
+            for( const auto & segment: this->_segments )
+            {
+                for( uint64_t handle: segment._pages )
+                {
+                    this->_store->retain( handle );
+                }
+            }
+        }
+        
+        AddressSpace::IMPL::~IMPL( void )
+        {
+            for( const auto & segment: this->_segments )
+            {
+                for( uint64_t handle: segment._pages )
+                {
+                    this->_store->release( handle );
+                }
+            }
+        }
+        
+        const AddressSpace::IMPL::Segment * AddressSpace::IMPL::_find( uint64_t address ) const
+        {
+            auto i
+            (
+                std::upper_bound
+                (
+                    this->_segments.begin(),
+                    this->_segments.end(),
+                    address,
+                    []( uint64_t a, const Segment & s )
+                    {
+                        return a < s._address;
+                    }
+                )
+            );
+            
+            if( i == this->_segments.begin() || address - ( i - 1 )->_address >= ( i - 1 )->_size )
+            {
+                return nullptr;
+            }
+            
+            return &*( i - 1 );
+        }
+        
+        /*
+         * Copies bytes backed by the file, either from the mapping or page by
+         * page from the store.
+         */
+        void AddressSpace::IMPL::_copy( const Segment & segment, uint64_t offset, uint64_t size, uint8_t * buf ) const
+        {
+            if( segment._data != nullptr )
+            {
+                memcpy( buf, segment._data + offset, size );
+                
+                return;
+            }
+            
+            while( size > 0 )
+            {
+                uint64_t page( offset / PageStore::pageSize );
+                uint64_t start( offset % PageStore::pageSize );
+                uint64_t n( std::min( size, PageStore::pageSize - start ) );
+                
+                if( n == PageStore::pageSize )
+                {
+                    this->_store->read( segment._pages[ page ], buf );
+                }
+                else
+                {
+                    uint8_t tmp[ PageStore::pageSize ];
+                    
+                    this->_store->read( segment._pages[ page ], tmp );
+                    memcpy( buf, tmp + start, n );
+                }
+                
+                buf    += n;
+                offset += n;
+                size   -= n;
+            }
+        }
+        
+        /*
+         * Moves every file-backed page into the store, then drops the
+         * mapping. With a reader, pages are hashed while the next chunks are
+         * still being read, and the mapping is never touched past the
+         * headers. Called from the constructor, so references taken before
+         * a failure are released here rather than by the destructor.
+         */
+        void AddressSpace::IMPL::_ingest( FileReader * reader )
+        {
+            try
+            {
+                for( auto & segment: this->_segments )
+                {
+                    segment._pages.reserve( ( segment._fileSize + PageStore::pageSize - 1 ) / PageStore::pageSize );
+                }
+                
+                if( reader == nullptr )
+                {
+                    for( auto & segment: this->_segments )
+                    {
+                        this->_add( segment, segment._data, segment._fileSize );
+                    }
+                }
+                else
+                {
+                    std::vector< std::pair< uint64_t, uint64_t > > ranges;
+                    std::vector< Segment * >                       segments;
+                    
+                    for( auto & segment: this->_segments )
+                    {
+                        if( segment._fileSize > 0 )
+                        {
+                            ranges.push_back( { segment._offset, segment._fileSize } );
+                            segments.push_back( &segment );
+                        }
+                    }
+                    
+                    reader->read
+                    (
+                        ranges,
+                        [ & ]( size_t range, uint64_t, const uint8_t * data, size_t size )
+                        {
+                            this->_add( *( segments[ range ] ), data, size );
+                        }
+                    );
+                }
+                
+                for( auto & segment: this->_segments )
+                {
+                    segment._data = nullptr;
+                }
+            }
+            catch( ... )
+            {
+                for( auto & segment: this->_segments )
+                {
+                    for( uint64_t handle: segment._pages )
+                    {
+                        this->_store->release( handle );
+                    }
+                    
+                    segment._pages.clear();
+                }
+                
+                throw;
+            }
+            
+            this->_elf = ELF::File();
+        }
+        
+        /*
+         * Appends pages to a segment. Only the last call for a segment may
+         * end on a partial page, which is zero-padded.
+         */
+        void AddressSpace::IMPL::_add( Segment & segment, const uint8_t * data, uint64_t size )
+        {
+            for( uint64_t offset = 0; offset < size; offset += PageStore::pageSize )
+            {
+                if( size - offset >= PageStore::pageSize )
+                {
+                    segment._pages.push_back( this->_store->add( data + offset ) );
+                }
+                else
+                {
+                    uint8_t tmp[ PageStore::pageSize ] = {};
+                    
+                    memcpy( tmp, data + offset, size - offset );
+                    segment._pages.push_back( this->_store->add( tmp ) );
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_VM_ADDRESS_SPACE_HPP
+#define VBOX_VM_ADDRESS_SPACE_HPP
+
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "VBox/ELF/File.hpp"
+#include "VBox/FileReader.hpp"
+#include "VBox/VM/PageStore.hpp"
+
+namespace VBox
+{
+    namespace VM
+    {
+        /*
+         * Guest-physical address space of a core dump, built from all of its
+         * PT_LOAD segments. Addresses between segments (MMIO, ROM, the PCI
+         * hole below 4 GiB) are not mapped.
+         * When given a page store, segments are copied into it and the file
+         * mapping is released; data() then always returns nullptr.
+         * Given a reader for the same file as well, segments are read with
+         * it instead of being paged in through the mapping.
+         */
+        class AddressSpace
+        {
+            public:
+                
+                AddressSpace( void );
+                AddressSpace( const ELF::File & elf );
+                AddressSpace( const ELF::File & elf, std::shared_ptr< PageStore > store );
+                AddressSpace( const ELF::File & elf, std::shared_ptr< PageStore > store, FileReader & reader );
+                AddressSpace( const AddressSpace & o );
+                AddressSpace( AddressSpace && o ) noexcept;
+                ~AddressSpace( void );
+                
+                AddressSpace & operator =( AddressSpace o );
+                
+                uint64_t size( void ) const;
+                uint64_t end( void )  const;
+                
+                std::vector< std::pair< uint64_t, uint64_t > > ranges( void ) const;
+                
+                bool                   contains( uint64_t address )            const;
+                const uint8_t        * data( uint64_t address, uint64_t size ) const;
+                std::vector< uint8_t > read( uint64_t address, uint64_t size ) const;
+                
+                void hashPages( uint64_t address, size_t count, uint64_t * hashes, bool * zero ) const;
+                
+                friend void swap( AddressSpace & o1, AddressSpace & o2 );
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_VM_ADDRESS_SPACE_HPP */
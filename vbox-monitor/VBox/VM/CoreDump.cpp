@@ -23,10 +23,8 @@
  ******************************************************************************/
 
 #include "VBox/VM/CoreDump.hpp"
-#include "VBox/BinaryFileStream.hpp"
-#include "VBox/BinaryDataStream.hpp"
 #include "VBox/ELF/File.hpp"
-#include "VBox/Casts.hpp"
+#include <stdexcept>
 
 namespace VBox
 {
@@ -36,18 +34,37 @@ namespace VBox
         {
             public:
                 
-                IMPL( const std::string & path );
+                IMPL( const std::string & path, std::shared_ptr< PageStore > store );
+                IMPL( FileReader & reader, std::shared_ptr< PageStore > store );
+                IMPL( const ELF::File & elf, std::shared_ptr< PageStore > store );
                 IMPL( const IMPL & o );
                 
-                void _parse( void );
+                void _parse( const ELF::File & elf, FileReader * reader );
                 
-                std::string      _path;
-                uint64_t         _memorySize;
-                BinaryDataStream _memory;
+                std::string                        _path;
+                std::shared_ptr< PageStore >       _store;
+                AddressSpace                       _memory;
+                std::shared_ptr< const PageIndex > _index;
         };
         
         CoreDump::CoreDump( const std::string & path ):
-            impl( std::make_unique< IMPL >( path ) )
+            impl( std::make_unique< IMPL >( path, nullptr ) )
+        {}
+        
+        CoreDump::CoreDump( const std::string & path, std::shared_ptr< PageStore > store ):
+            impl( std::make_unique< IMPL >( path, store ) )
+        {}
+        
+        CoreDump::CoreDump( FileReader & reader, std::shared_ptr< PageStore > store ):
+            impl( std::make_unique< IMPL >( reader, store ) )
+        {}
+        
+        CoreDump::CoreDump( const ELF::File & elf ):
+            impl( std::make_unique< IMPL >( elf, nullptr ) )
+        {}
+        
+        CoreDump::CoreDump( const ELF::File & elf, std::shared_ptr< PageStore > store ):
+            impl( std::make_unique< IMPL >( elf, store ) )
         {}
         
         CoreDump::CoreDump( const CoreDump & o ):
@@ -75,20 +92,37 @@ namespace VBox
         
         uint64_t CoreDump::memorySize( void ) const
         {
-            return this->impl->_memorySize;
+            return this->impl->_memory.end();
+        }
+        
+        const AddressSpace & CoreDump::addressSpace( void ) const
+        {
+            return this->impl->_memory;
+        }
+        
+        std::shared_ptr< const PageIndex > CoreDump::pageIndex( void ) const
+        {
+            return this->impl->_index;
         }
         
-        std::vector< uint8_t > CoreDump::readMemory( size_t offset, size_t size )
+        std::vector< uint8_t > CoreDump::readMemory( uint64_t address, size_t size ) const
         {
-            try
+            return this->impl->_memory.read( address, size );
+        }
+        
+        /*
+         * Not thread-safe: meant to be called once, before the dump is
+         * shared with readers.
+         */
+        void CoreDump::buildPageIndex( std::shared_ptr< const PageIndex > previous, size_t threads )
+        {
+            if( previous == nullptr )
             {
-                this->impl->_memory.Seek( numeric_cast< ssize_t >( offset ), BinaryStream::SeekDirection::Begin );
-                
-                return this->impl->_memory.Read( size );
+                this->impl->_index = std::make_shared< const PageIndex >( this->impl->_memory, threads );
             }
-            catch( ... )
+            else
             {
-                return {};
+                this->impl->_index = std::make_shared< const PageIndex >( this->impl->_memory, *( previous ), threads );
             }
         }
         
@@ -99,45 +133,61 @@ namespace VBox
             swap( o1.impl, o2.impl );
         }
         
-        CoreDump::IMPL::IMPL( const std::string & path ):
-            _path( path ),
-            _memorySize( 0 )
+        CoreDump::IMPL::IMPL( const std::string & path, std::shared_ptr< PageStore > store ):
+            _path(  path ),
+            _store( store )
         {
-            this->_parse();
+            if( store == nullptr )
+            {
+                this->_parse( ELF::File( path ), nullptr );
+            }
+            else
+            {
+                FileReader reader( path );
+                
+                this->_parse( ELF::File( path ), &reader );
+            }
         }
         
-        CoreDump::IMPL::IMPL( const IMPL & o ):
-            _path(       o._path ),
-            _memorySize( o._memorySize ),
-            _memory(     o._memory )
+        CoreDump::IMPL::IMPL( FileReader & reader, std::shared_ptr< PageStore > store ):
+            _path(  reader.path() ),
+            _store( store )
         {
-            this->_parse();
+            this->_parse( ELF::File( reader.path() ), &reader );
         }
         
-        void CoreDump::IMPL::_parse( void )
+        CoreDump::IMPL::IMPL( const ELF::File & elf, std::shared_ptr< PageStore > store ):
+            _store( store )
         {
-            BinaryFileStream                       stream( this->_path );
-            ELF::File                              elf( stream );
-            std::vector< ELF::ProgramHeaderEntry > entries( elf.programHeader() );
+            this->_parse( elf, nullptr );
+        }
+        
+        CoreDump::IMPL::IMPL( const IMPL & o ):
+            _path(   o._path ),
+            _store(  o._store ),
+            _memory( o._memory ),
+            _index(  o._index )
+        {}
+        
+        /*
+         * The core is mapped rather than read, so parsing only touches the
+         * headers and guest memory is paged in on demand by readMemory().
+         * The mapping stays valid after the file is unlinked.
+         * With a page store, memory is copied into the store instead, and
+         * the mapping is released once parsing is done. Cores on disk are
+         * then read with a FileReader rather than through the mapping.
+         * Dumps received in memory have no path.
+         */
+        void CoreDump::IMPL::_parse( const ELF::File & elf, FileReader * reader )
+        {
+            AddressSpace memory( ( reader == nullptr || this->_store == nullptr ) ? AddressSpace( elf, this->_store ) : AddressSpace( elf, this->_store, *( reader ) ) );
             
-            if( entries.size() < 2 || entries[ 0 ].type() != 0x04 || entries[ 1 ].type() != 0x01 )
+            if( memory.size() == 0 )
             {
-                throw std::runtime_error( "Invalid core dump" );
+                throw std::runtime_error( "Invalid core dump - No PT_LOAD segment" );
             }
             
-            {
-                ELF::ProgramHeaderEntry mem( entries[ 1 ] );
-                
-                if( mem.offset() == 0 || mem.fileSize() == 0 || mem.fileSize() != mem.memorySize() )
-                {
-                    throw std::runtime_error( "Invalid core dump" );
-                }
-                
-                stream.Seek( numeric_cast< ssize_t >( mem.offset() ), BinaryStream::SeekDirection::Begin );
-                
-                this->_memorySize = mem.fileSize();
-                this->_memory     = BinaryDataStream( stream.Read( mem.fileSize() ) );
-            }
+            this->_memory = std::move( memory );
         }
     }
 }
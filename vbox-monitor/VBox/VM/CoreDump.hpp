@@ -28,6 +28,9 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
+#include "VBox/VM/AddressSpace.hpp"
+#include "VBox/VM/PageIndex.hpp"
 
 namespace VBox
 {
@@ -38,16 +41,24 @@ namespace VBox
             public:
                 
                 CoreDump( const std::string & path );
+                CoreDump( const std::string & path, std::shared_ptr< PageStore > store );
+                CoreDump( FileReader & reader, std::shared_ptr< PageStore > store );
+                CoreDump( const ELF::File & elf );
+                CoreDump( const ELF::File & elf, std::shared_ptr< PageStore > store );
                 CoreDump( const CoreDump & o );
                 CoreDump( CoreDump && o );
                 ~CoreDump( void );
                 
                 CoreDump & operator =( CoreDump o );
                 
-                std::string path( void )       const;
-                uint64_t    memorySize( void ) const;
+                std::string                        path( void )         const;
+                uint64_t                           memorySize( void )   const;
+                const AddressSpace               & addressSpace( void ) const;
+                std::shared_ptr< const PageIndex > pageIndex( void )    const;
                 
-                std::vector< uint8_t > readMemory( size_t offset, size_t size );
+                std::vector< uint8_t > readMemory( uint64_t address, size_t size ) const;
+                
+                void buildPageIndex( std::shared_ptr< const PageIndex > previous = nullptr, size_t threads = 0 );
                 
                 friend void swap( CoreDump & o1, CoreDump & o2 );
                 
@@ -0,0 +1,353 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/VM/DumpTarget.hpp"
+#include "VBox/MappedFile.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace VBox
+{
+    namespace VM
+    {
+        class DumpTarget::IMPL
+        {
+            public:
+                
+                static constexpr size_t chunkSize = 1024 * 1024;
+                
+                IMPL( Kind kind );
+                ~IMPL( void );
+                
+                void _createMemoryFile( void );
+                void _openPipe( void );
+                void _drain( void );
+                void _unblock( void );
+                
+                Kind                                      _kind;
+                std::string                               _path;
+                int                                       _fd;
+                int                                       _writeFd;
+                std::thread                               _thread;
+                std::shared_ptr< std::vector< uint8_t > > _buffer;
+                std::weak_ptr< MappedFile >               _mapped;
+                int                                       _error;
+        };
+        
+        bool DumpTarget::supports( Kind kind )
+        {
+            #ifdef __linux__
+            ( void )kind;
+            
+            return true;
+            #else
+            return kind == Kind::Pipe;
+            #endif
+        }
+        
+        DumpTarget::DumpTarget( void ):
+            DumpTarget( supports( Kind::MemoryFile ) ? Kind::MemoryFile : Kind::Pipe )
+        {}
+        
+        DumpTarget::DumpTarget( Kind kind ):
+            impl( std::make_unique< IMPL >( kind ) )
+        {}
+        
+        DumpTarget::~DumpTarget( void )
+        {}
+        
+        DumpTarget::Kind DumpTarget::kind( void ) const
+        {
+            return this->impl->_kind;
+        }
+        
+        std::string DumpTarget::path( void ) const
+        {
+            return this->impl->_path;
+        }
+        
+        /*
+         * Memory files are mapped as they are, so the dump is never copied.
+         * Pipes are drained into a buffer, which then backs the ELF file.
+         */
+        ELF::File DumpTarget::receive( void )
+        {
+            if( this->impl->_kind == Kind::MemoryFile )
+            {
+                std::shared_ptr< MappedFile > file( std::make_shared< MappedFile >( this->impl->_fd ) );
+                
+                this->impl->_mapped = file;
+                
+                return ELF::File( file, file->data(), file->size() );
+            }
+            
+            if( this->impl->_thread.joinable() )
+            {
+                this->impl->_unblock();
+                this->impl->_thread.join();
+            }
+            
+            if( this->impl->_error != 0 )
+            {
+                throw std::runtime_error( "Cannot read core dump from pipe: " + this->impl->_path );
+            }
+            
+            return ELF::File( this->impl->_buffer, this->impl->_buffer->data(), this->impl->_buffer->size() );
+        }
+        
+        /*
+         * Memory is only reused once nothing refers to the previous dump
+         * anymore: truncating a memory file that is still mapped would fault
+         * its readers, and the pipe buffer backs the previous ELF file. In
+         * that case, fresh storage is used instead. The path may change.
+         */
+        void DumpTarget::reset( void )
+        {
+            if( this->impl->_kind == Kind::MemoryFile )
+            {
+                if( this->impl->_mapped.expired() )
+                {
+                    if( ftruncate( this->impl->_fd, 0 ) != 0 )
+                    {
+                        throw std::runtime_error( "Cannot truncate memory file" );
+                    }
+                }
+                else
+                {
+                    close( this->impl->_fd );
+                    
+                    this->impl->_fd = -1;
+                    
+                    this->impl->_createMemoryFile();
+                }
+                
+                return;
+            }
+            
+            if( this->impl->_thread.joinable() )
+            {
+                this->impl->_unblock();
+                this->impl->_thread.join();
+            }
+            
+            if( this->impl->_buffer.use_count() == 1 )
+            {
+                this->impl->_buffer->clear();
+            }
+            else
+            {
+                this->impl->_buffer = std::make_shared< std::vector< uint8_t > >();
+            }
+            
+            this->impl->_error = 0;
+            
+            this->impl->_openPipe();
+        }
+        
+        DumpTarget::IMPL::IMPL( Kind kind ):
+            _kind(    kind ),
+            _fd(      -1 ),
+            _writeFd( -1 ),
+            _buffer(  std::make_shared< std::vector< uint8_t > >() ),
+            _error(   0 )
+        {
+            if( supports( kind ) == false )
+            {
+                throw std::runtime_error( "Unsupported dump target" );
+            }
+            
+            if( kind == Kind::MemoryFile )
+            {
+                this->_createMemoryFile();
+            }
+            else
+            {
+                std::string tmp( "/tmp/vbox-monitor-core-XXXXXX" );
+                
+                if( mkdtemp( &( tmp[ 0 ] ) ) == nullptr )
+                {
+                    throw std::runtime_error( "Cannot create temporary directory" );
+                }
+                
+                this->_path = tmp + "/core";
+                
+                if( mkfifo( this->_path.c_str(), 0600 ) != 0 )
+                {
+                    rmdir( tmp.c_str() );
+                    
+                    throw std::runtime_error( "Cannot create named pipe" );
+                }
+                
+                this->_fd = open( this->_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC );
+                
+                if( this->_fd == -1 || fcntl( this->_fd, F_SETFL, 0 ) == -1 )
+                {
+                    if( this->_fd != -1 )
+                    {
+                        close( this->_fd );
+                    }
+                    
+                    unlink( this->_path.c_str() );
+                    rmdir( tmp.c_str() );
+                    
+                    throw std::runtime_error( "Cannot open named pipe" );
+                }
+                
+                #ifdef F_SETPIPE_SZ
+                fcntl( this->_fd, F_SETPIPE_SZ, static_cast< int >( chunkSize ) );
+                #endif
+                
+                try
+                {
+                    this->_openPipe();
+                }
+                catch( ... )
+                {
+                    close( this->_fd );
+                    unlink( this->_path.c_str() );
+                    rmdir( tmp.c_str() );
+                    
+                    throw;
+                }
+            }
+        }
+        
+        DumpTarget::IMPL::~IMPL( void )
+        {
+            if( this->_thread.joinable() )
+            {
+                this->_unblock();
+                this->_thread.join();
+            }
+            
+            if( this->_fd != -1 )
+            {
+                close( this->_fd );
+            }
+            
+            if( this->_kind == Kind::Pipe )
+            {
+                unlink( this->_path.c_str() );
+                rmdir( this->_path.substr( 0, this->_path.rfind( '/' ) ).c_str() );
+            }
+        }
+        
+        void DumpTarget::IMPL::_createMemoryFile( void )
+        {
+            #ifdef __linux__
+            
+            this->_fd = memfd_create( "vbox-monitor-core", MFD_CLOEXEC );
+            
+            if( this->_fd == -1 )
+            {
+                throw std::runtime_error( "Cannot create memory file" );
+            }
+            
+            /*
+             * The core is written by the VM process, not by us, so the path
+             * must name our descriptor from another process.
+             */
+            this->_path = "/proc/" + std::to_string( getpid() ) + "/fd/" + std::to_string( this->_fd );
+            
+            #endif
+        }
+        
+        /*
+         * We hold a write end ourselves until the dump is received, so the
+         * reader only sees end-of-file once the real writer is done, whether
+         * or not it ever opened the pipe.
+         */
+        void DumpTarget::IMPL::_openPipe( void )
+        {
+            this->_writeFd = open( this->_path.c_str(), O_WRONLY | O_CLOEXEC );
+            
+            if( this->_writeFd == -1 )
+            {
+                throw std::runtime_error( "Cannot open named pipe" );
+            }
+            
+            this->_thread = std::thread( [ this ] { this->_drain(); } );
+        }
+        
+        /*
+         * Runs on the background thread and reads until every writer has
+         * closed the pipe. Only the chunk being read is initialised, so the
+         * unused capacity is never touched.
+         */
+        void DumpTarget::IMPL::_drain( void )
+        {
+            size_t size( 0 );
+            
+            while( 1 )
+            {
+                ssize_t n;
+                
+                if( this->_buffer->capacity() < size + chunkSize )
+                {
+                    this->_buffer->reserve( std::max( this->_buffer->capacity() * 2, size + chunkSize ) );
+                }
+                
+                this->_buffer->resize( size + chunkSize );
+                
+                n = read( this->_fd, this->_buffer->data() + size, chunkSize );
+                
+                if( n == -1 && errno == EINTR )
+                {
+                    continue;
+                }
+                else if( n == -1 )
+                {
+                    this->_error = errno;
+                    
+                    break;
+                }
+                else if( n == 0 )
+                {
+                    break;
+                }
+                
+                size += static_cast< size_t >( n );
+            }
+            
+            this->_buffer->resize( size );
+        }
+        
+        void DumpTarget::IMPL::_unblock( void )
+        {
+            if( this->_writeFd != -1 )
+            {
+                close( this->_writeFd );
+                
+                this->_writeFd = -1;
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_VM_DUMP_TARGET_HPP
+#define VBOX_VM_DUMP_TARGET_HPP
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include "VBox/ELF/File.hpp"
+
+namespace VBox
+{
+    namespace VM
+    {
+        /*
+         * A path another process can write a core dump to, which lands in
+         * memory instead of on the filesystem: an anonymous memory file on
+         * Linux, or a named pipe drained by a background thread elsewhere.
+         * The writer must be done before the dump is received. A target can
+         * be reset and reused for the next dump.
+         */
+        class DumpTarget
+        {
+            public:
+                
+                enum class Kind
+                {
+                    MemoryFile,
+                    Pipe
+                };
+                
+                static bool supports( Kind kind );
+                
+                DumpTarget( void );
+                DumpTarget( Kind kind );
+                ~DumpTarget( void );
+                
+                DumpTarget( const DumpTarget & o )              = delete;
+                DumpTarget( DumpTarget && o )                   = delete;
+                DumpTarget & operator =( const DumpTarget & o ) = delete;
+                DumpTarget & operator =( DumpTarget && o )      = delete;
+                
+                Kind        kind( void ) const;
+                std::string path( void ) const;
+                
+                ELF::File receive( void );
+                void      reset( void );
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_VM_DUMP_TARGET_HPP */
@@ -0,0 +1,350 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/VM/PageIndex.hpp"
+#include "VBox/Casts.hpp"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace VBox
+{
+    namespace VM
+    {
+        class PageIndex::IMPL
+        {
+            public:
+                
+                class Range
+                {
+                    public:
+                        
+                        uint64_t _address;
+                        size_t   _pages;
+                        size_t   _first;
+                };
+                
+                static constexpr uint8_t zeroFlag    = 0x01;
+                static constexpr uint8_t changedFlag = 0x02;
+                
+                IMPL( void );
+                IMPL( const AddressSpace & memory, const IMPL * previous, size_t threads );
+                IMPL( const IMPL & o );
+                
+                const Range * _find( uint64_t address, size_t & page ) const;
+                void          _index( const AddressSpace & memory, const IMPL * previous, size_t range, size_t first, size_t count, size_t & zero, size_t & changed );
+                
+                std::vector< Range >    _ranges;
+                std::vector< uint64_t > _hashes;
+                std::vector< uint8_t >  _flags;
+                size_t                  _zeroPages;
+                size_t                  _changedPages;
+        };
+        
+        PageIndex::PageIndex( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        PageIndex::PageIndex( const AddressSpace & memory, size_t threads ):
+            impl( std::make_unique< IMPL >( memory, nullptr, threads ) )
+        {}
+        
+        PageIndex::PageIndex( const AddressSpace & memory, const PageIndex & previous, size_t threads ):
+            impl( std::make_unique< IMPL >( memory, previous.impl.get(), threads ) )
+        {}
+        
+        PageIndex::PageIndex( const PageIndex & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        PageIndex::PageIndex( PageIndex && o ) noexcept:
+            impl( std::move( o.impl ) )
+        {}
+        
+        PageIndex::~PageIndex( void )
+        {}
+        
+        PageIndex & PageIndex::operator =( PageIndex o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        size_t PageIndex::pages( void ) const
+        {
+            return this->impl->_hashes.size();
+        }
+        
+        size_t PageIndex::zeroPages( void ) const
+        {
+            return this->impl->_zeroPages;
+        }
+        
+        size_t PageIndex::changedPages( void ) const
+        {
+            return this->impl->_changedPages;
+        }
+        
+        bool PageIndex::contains( uint64_t address ) const
+        {
+            size_t page;
+            
+            return this->impl->_find( address, page ) != nullptr;
+        }
+        
+        uint64_t PageIndex::hash( uint64_t address ) const
+        {
+            size_t page;
+            
+            if( this->impl->_find( address, page ) == nullptr )
+            {
+                throw std::runtime_error( "Invalid page address" );
+            }
+            
+            return this->impl->_hashes[ page ];
+        }
+        
+        bool PageIndex::isZero( uint64_t address ) const
+        {
+            size_t page;
+            
+            if( this->impl->_find( address, page ) == nullptr )
+            {
+                throw std::runtime_error( "Invalid page address" );
+            }
+            
+            return ( this->impl->_flags[ page ] & IMPL::zeroFlag ) != 0;
+        }
+        
+        bool PageIndex::isChanged( uint64_t address ) const
+        {
+            size_t page;
+            
+            if( this->impl->_find( address, page ) == nullptr )
+            {
+                throw std::runtime_error( "Invalid page address" );
+            }
+            
+            return ( this->impl->_flags[ page ] & IMPL::changedFlag ) != 0;
+        }
+        
+        /*
+         * Addresses of the changed pages, in ascending order.
+         */
+        std::vector< uint64_t > PageIndex::changes( void ) const
+        {
+            std::vector< uint64_t > changes;
+            
+            changes.reserve( this->impl->_changedPages );
+            
+            for( const auto & range: this->impl->_ranges )
+            {
+                for( size_t i = 0; i < range._pages; i++ )
+                {
+                    if( ( this->impl->_flags[ range._first + i ] & IMPL::changedFlag ) != 0 )
+                    {
+                        changes.push_back( range._address + i * PageStore::pageSize );
+                    }
+                }
+            }
+            
+            return changes;
+        }
+        
+        void swap( PageIndex & o1, PageIndex & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        PageIndex::IMPL::IMPL( void ):
+            _zeroPages(    0 ),
+            _changedPages( 0 )
+        {}
+        
+        /*
+         * Blocks are handed out to threads through an atomic counter, and
+         * each one writes to its own slice of the arrays, so the only
+         * synchronization is for counters and errors once a thread is done.
+         */
+        PageIndex::IMPL::IMPL( const AddressSpace & memory, const IMPL * previous, size_t threads ):
+            _zeroPages(    0 ),
+            _changedPages( 0 )
+        {
+            std::vector< std::pair< size_t, size_t > > blocks;
+            std::vector< std::thread >                 workers;
+            std::atomic< size_t >                      next( 0 );
+            std::mutex                                 mtx;
+            std::exception_ptr                         error;
+            
+            for( const auto & range: memory.ranges() )
+            {
+                size_t pages( numeric_cast< size_t >( ( range.second + PageStore::pageSize - 1 ) / PageStore::pageSize ) );
+                
+                for( size_t first = 0; first < pages; first += blockPages )
+                {
+                    blocks.push_back( { this->_ranges.size(), first } );
+                }
+                
+                this->_ranges.push_back( { range.first, pages, this->_hashes.size() } );
+                this->_hashes.resize( this->_hashes.size() + pages );
+            }
+            
+            this->_flags.resize( this->_hashes.size() );
+            
+            threads = ( threads == 0 ) ? std::max< size_t >( std::thread::hardware_concurrency(), 1 ) : threads;
+            threads = std::min( threads, blocks.size() );
+            
+            auto work
+            (
+                [ & ]( void )
+                {
+                    size_t zero( 0 );
+                    size_t changed( 0 );
+                    
+                    try
+                    {
+                        for( size_t i = next++; i < blocks.size(); i = next++ )
+                        {
+                            const Range & range( this->_ranges[ blocks[ i ].first ] );
+                            
+                            this->_index( memory, previous, blocks[ i ].first, blocks[ i ].second, std::min( blockPages, range._pages - blocks[ i ].second ), zero, changed );
+                        }
+                    }
+                    catch( ... )
+                    {
+                        std::lock_guard< std::mutex > l( mtx );
+                        
+                        error = ( error == nullptr ) ? std::current_exception() : error;
+                        next  = blocks.size();
+                    }
+                    
+                    {
+                        std::lock_guard< std::mutex > l( mtx );
+                        
+                        this->_zeroPages    += zero;
+                        this->_changedPages += changed;
+                    }
+                }
+            );
+            
+            for( size_t i = 1; i < threads; i++ )
+            {
+                workers.emplace_back( work );
+            }
+            
+            work();
+            
+            for( auto & worker: workers )
+            {
+                worker.join();
+            }
+            
+            if( error != nullptr )
+            {
+                std::rethrow_exception( error );
+            }
+        }
+        
+        PageIndex::IMPL::IMPL( const IMPL & o ):
+            _ranges(       o._ranges ),
+            _hashes(       o._hashes ),
+            _flags(        o._flags ),
+            _zeroPages(    o._zeroPages ),
+            _changedPages( o._changedPages )
+        {}
+        
+        const PageIndex::IMPL::Range * PageIndex::IMPL::_find( uint64_t address, size_t & page ) const
+        {
+            auto i
+            (
+                std::upper_bound
+                (
+                    this->_ranges.begin(),
+                    this->_ranges.end(),
+                    address,
+                    []( uint64_t a, const Range & r )
+                    {
+                        return a < r._address;
+                    }
+                )
+            );
+            
+            if( i == this->_ranges.begin() || ( address - ( i - 1 )->_address ) / PageStore::pageSize >= ( i - 1 )->_pages )
+            {
+                return nullptr;
+            }
+            
+            page = ( i - 1 )->_first + numeric_cast< size_t >( ( address - ( i - 1 )->_address ) / PageStore::pageSize );
+            
+            return &*( i - 1 );
+        }
+        
+        /*
+         * A page only matches the previous snapshot if the same address
+         * starts a page there too, which is the case unless segments moved.
+         */
+        void PageIndex::IMPL::_index( const AddressSpace & memory, const IMPL * previous, size_t range, size_t first, size_t count, size_t & zero, size_t & changed )
+        {
+            const Range & r( this->_ranges[ range ] );
+            uint64_t    * hashes( this->_hashes.data() + r._first + first );
+            uint8_t     * flags( this->_flags.data() + r._first + first );
+            bool          zeros[ blockPages ];
+            
+            memory.hashPages( r._address + first * PageStore::pageSize, count, hashes, zeros );
+            
+            for( size_t i = 0; i < count; i++ )
+            {
+                uint64_t      address( r._address + ( first + i ) * PageStore::pageSize );
+                const Range * old;
+                size_t        page;
+                
+                flags[ i ] = ( zeros[ i ] ) ? zeroFlag : 0;
+                zero      += ( zeros[ i ] ) ? 1 : 0;
+                
+                if( previous == nullptr )
+                {
+                    continue;
+                }
+                
+                old = previous->_find( address, page );
+                
+                if
+                (
+                       old == nullptr
+                    || ( address - old->_address ) % PageStore::pageSize != 0
+                    || previous->_hashes[ page ] != hashes[ i ]
+                )
+                {
+                    flags[ i ] |= changedFlag;
+                    changed++;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_VM_PAGE_INDEX_HPP
+#define VBOX_VM_PAGE_INDEX_HPP
+
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include "VBox/VM/AddressSpace.hpp"
+
+namespace VBox
+{
+    namespace VM
+    {
+        /*
+         * Per-page summary of an address space: content hash, whether the
+         * page is all zeros, and whether it changed since the previous
+         * snapshot. Pages the previous snapshot did not have count as
+         * changed; without a previous snapshot, no page does.
+         * Built in parallel, in blocks of pages spread over threads.
+         */
+        class PageIndex
+        {
+            public:
+                
+                static constexpr size_t blockPages = 256;
+                
+                PageIndex( void );
+                PageIndex( const AddressSpace & memory, size_t threads = 0 );
+                PageIndex( const AddressSpace & memory, const PageIndex & previous, size_t threads = 0 );
+                PageIndex( const PageIndex & o );
+                PageIndex( PageIndex && o ) noexcept;
+                ~PageIndex( void );
+                
+                PageIndex & operator =( PageIndex o );
+                
+                size_t pages( void )        const;
+                size_t zeroPages( void )    const;
+                size_t changedPages( void ) const;
+                
+                bool     contains( uint64_t address )  const;
+                uint64_t hash( uint64_t address )      const;
+                bool     isZero( uint64_t address )    const;
+                bool     isChanged( uint64_t address ) const;
+                
+                std::vector< uint64_t > changes( void ) const;
+                
+                friend void swap( PageIndex & o1, PageIndex & o2 );
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_VM_PAGE_INDEX_HPP */
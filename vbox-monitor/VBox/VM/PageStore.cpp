@@ -0,0 +1,612 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/VM/PageStore.hpp"
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#elif defined( __ARM_NEON )
+#include <arm_neon.h>
+#endif
+
+#ifdef VBOX_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+namespace VBox
+{
+    namespace VM
+    {
+        class PageStore::IMPL
+        {
+            public:
+                
+                class Page
+                {
+                    public:
+                        
+                        uint64_t               _hash;
+                        size_t                 _refs;
+                        bool                   _compressed;
+                        std::vector< uint8_t > _data;
+                };
+                
+                static constexpr size_t cacheSlots = 64;
+                
+                IMPL( Compression compression );
+                
+                static const uint64_t * _secret( void );
+                
+                void _read( uint64_t handle, uint8_t * page ) const;
+                
+                Compression                                   _compression;
+                std::vector< Page >                           _pages;
+                std::vector< uint64_t >                       _free;
+                std::unordered_multimap< uint64_t, uint64_t > _index;
+                size_t                                        _references;
+                uint64_t                                      _storedBytes;
+                mutable std::vector< uint64_t >               _cacheHandles;
+                mutable std::vector< uint8_t >                _cache;
+                mutable std::mutex                            _mtx;
+        };
+        
+        /*
+         * Most of a guest's memory is zero, so this runs on every page and
+         * bails out on the first non-zero 256-byte block.
+         */
+        bool PageStore::isZero( const uint8_t * page )
+        {
+            for( size_t i = 0; i < pageSize; i += 256 )
+            {
+                #if defined( __SSE2__ )
+                
+                __m128i acc( _mm_setzero_si128() );
+                
+                for( size_t j = 0; j < 256; j += 16 )
+                {
+                    acc = _mm_or_si128( acc, _mm_loadu_si128( reinterpret_cast< const __m128i * >( page + i + j ) ) );
+                }
+                
+                if( _mm_movemask_epi8( _mm_cmpeq_epi8( acc, _mm_setzero_si128() ) ) != 0xFFFF )
+                {
+                    return false;
+                }
+                
+                #elif defined( __ARM_NEON )
+                
+                uint8x16_t acc( vdupq_n_u8( 0 ) );
+                
+                for( size_t j = 0; j < 256; j += 16 )
+                {
+                    acc = vorrq_u8( acc, vld1q_u8( page + i + j ) );
+                }
+                
+                if( ( vgetq_lane_u64( vreinterpretq_u64_u8( acc ), 0 ) | vgetq_lane_u64( vreinterpretq_u64_u8( acc ), 1 ) ) != 0 )
+                {
+                    return false;
+                }
+                
+                #else
+                
+                uint64_t acc( 0 );
+                
+                for( size_t j = 0; j < 256; j += 8 )
+                {
+                    uint64_t w;
+                    
+                    memcpy( &w, page + i + j, sizeof( w ) );
+                    
+                    acc |= w;
+                }
+                
+                if( acc != 0 )
+                {
+                    return false;
+                }
+                
+                #endif
+            }
+            
+            return true;
+        }
+        
+        /*
+         * Same structure as XXH3's long-input loop: eight 64-bit lanes, each
+         * 64-byte stripe mixed with a sliding window of the secret by a
+         * 32x32->64-bit multiply, and the lanes scrambled after every
+         * 1 KiB block. Two lanes fit in an SSE2 or NEON register. Results
+         * do not match the reference XXH3, only the scalar version below.
+         */
+        uint64_t PageStore::hash( const uint8_t * page )
+        {
+            constexpr size_t   stripeSize      = 64;
+            constexpr size_t   stripesPerBlock = 16;
+            constexpr size_t   blockSize       = stripeSize * stripesPerBlock;
+            constexpr uint64_t prime32         = 0x9E3779B1;
+            constexpr uint64_t prime64         = 0x9E3779B185EBCA87;
+            const uint64_t   * secret( IMPL::_secret() );
+            uint64_t           acc[ 8 ] =
+            {
+                0x00000000C2B2AE3D, 0x9E3779B185EBCA87, 0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9,
+                0x85EBCA77C2B2AE63, 0x0000000085EBCA77, 0x27D4EB2F165667C5, 0x000000009E3779B1
+            };
+            
+            #if defined( __SSE2__ )
+            
+            __m128i v[ 4 ];
+            __m128i prime( _mm_set1_epi32( static_cast< int >( prime32 ) ) );
+            
+            for( size_t i = 0; i < 4; i++ )
+            {
+                v[ i ] = _mm_loadu_si128( reinterpret_cast< const __m128i * >( acc + ( i * 2 ) ) );
+            }
+            
+            for( size_t block = 0; block < pageSize; block += blockSize )
+            {
+                for( size_t stripe = 0; stripe < stripesPerBlock; stripe++ )
+                {
+                    const uint8_t * p( page + block + ( stripe * stripeSize ) );
+                    
+                    for( size_t i = 0; i < 4; i++ )
+                    {
+                        __m128i data( _mm_loadu_si128( reinterpret_cast< const __m128i * >( p + ( i * 16 ) ) ) );
+                        __m128i key( _mm_xor_si128( data, _mm_loadu_si128( reinterpret_cast< const __m128i * >( secret + stripe + ( i * 2 ) ) ) ) );
+                        __m128i product( _mm_mul_epu32( key, _mm_shuffle_epi32( key, _MM_SHUFFLE( 0, 3, 0, 1 ) ) ) );
+                        
+                        v[ i ] = _mm_add_epi64( v[ i ], _mm_add_epi64( product, _mm_shuffle_epi32( data, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ) );
+                    }
+                }
+                
+                for( size_t i = 0; i < 4; i++ )
+                {
+                    __m128i x( _mm_xor_si128( v[ i ], _mm_srli_epi64( v[ i ], 47 ) ) );
+                    
+                    x      = _mm_xor_si128( x, _mm_loadu_si128( reinterpret_cast< const __m128i * >( secret + stripesPerBlock + ( i * 2 ) ) ) );
+                    v[ i ] = _mm_add_epi64( _mm_mul_epu32( x, prime ), _mm_slli_epi64( _mm_mul_epu32( _mm_srli_epi64( x, 32 ), prime ), 32 ) );
+                }
+            }
+            
+            for( size_t i = 0; i < 4; i++ )
+            {
+                _mm_storeu_si128( reinterpret_cast< __m128i * >( acc + ( i * 2 ) ), v[ i ] );
+            }
+            
+            #elif defined( __ARM_NEON )
+            
+            uint64x2_t v[ 4 ];
+            uint32x2_t prime( vdup_n_u32( static_cast< uint32_t >( prime32 ) ) );
+            
+            for( size_t i = 0; i < 4; i++ )
+            {
+                v[ i ] = vld1q_u64( acc + ( i * 2 ) );
+            }
+            
+            for( size_t block = 0; block < pageSize; block += blockSize )
+            {
+                for( size_t stripe = 0; stripe < stripesPerBlock; stripe++ )
+                {
+                    const uint8_t * p( page + block + ( stripe * stripeSize ) );
+                    
+                    for( size_t i = 0; i < 4; i++ )
+                    {
+                        uint64x2_t data( vreinterpretq_u64_u8( vld1q_u8( p + ( i * 16 ) ) ) );
+                        uint64x2_t key( veorq_u64( data, vld1q_u64( secret + stripe + ( i * 2 ) ) ) );
+                        
+                        v[ i ] = vaddq_u64( v[ i ], vextq_u64( data, data, 1 ) );
+                        v[ i ] = vmlal_u32( v[ i ], vmovn_u64( key ), vshrn_n_u64( key, 32 ) );
+                    }
+                }
+                
+                for( size_t i = 0; i < 4; i++ )
+                {
+                    uint64x2_t x( veorq_u64( v[ i ], vshrq_n_u64( v[ i ], 47 ) ) );
+                    
+                    x      = veorq_u64( x, vld1q_u64( secret + stripesPerBlock + ( i * 2 ) ) );
+                    v[ i ] = vmlal_u32( vshlq_n_u64( vmull_u32( vshrn_n_u64( x, 32 ), prime ), 32 ), vmovn_u64( x ), prime );
+                }
+            }
+            
+            for( size_t i = 0; i < 4; i++ )
+            {
+                vst1q_u64( acc + ( i * 2 ), v[ i ] );
+            }
+            
+            #else
+            
+            for( size_t block = 0; block < pageSize; block += blockSize )
+            {
+                for( size_t stripe = 0; stripe < stripesPerBlock; stripe++ )
+                {
+                    const uint8_t * p( page + block + ( stripe * stripeSize ) );
+                    
+                    for( size_t i = 0; i < 8; i++ )
+                    {
+                        uint64_t data;
+                        uint64_t key;
+                        
+                        memcpy( &data, p + ( i * 8 ), sizeof( data ) );
+                        
+                        key           = data ^ secret[ stripe + i ];
+                        acc[ i ^ 1 ] += data;
+                        acc[ i ]     += ( key & 0xFFFFFFFF ) * ( key >> 32 );
+                    }
+                }
+                
+                for( size_t i = 0; i < 8; i++ )
+                {
+                    acc[ i ] ^= acc[ i ] >> 47;
+                    acc[ i ] ^= secret[ stripesPerBlock + i ];
+                    acc[ i ] *= prime32;
+                }
+            }
+            
+            #endif
+            
+            {
+                uint64_t h( pageSize * prime64 );
+                
+                for( size_t i = 0; i < 8; i += 2 )
+                {
+                    unsigned __int128 product( static_cast< unsigned __int128 >( acc[ i ] ^ secret[ i + 1 ] ) * ( acc[ i + 1 ] ^ secret[ i + 2 ] ) );
+                    
+                    h += static_cast< uint64_t >( product ) ^ static_cast< uint64_t >( product >> 64 );
+                }
+                
+                h ^= h >> 37;
+                h *= 0x165667919E3779F9;
+                h ^= h >> 32;
+                
+                return h;
+            }
+        }
+        
+        uint64_t PageStore::zeroHash( void )
+        {
+            static const uint64_t h
+            (
+                []( void )
+                {
+                    uint8_t page[ pageSize ] = {};
+                    
+                    return hash( page );
+                }
+                ()
+            );
+            
+            return h;
+        }
+        
+        bool PageStore::supports( Compression compression )
+        {
+            #ifdef VBOX_HAVE_LZ4
+            ( void )compression;
+            
+            return true;
+            #else
+            return compression == Compression::None;
+            #endif
+        }
+        
+        PageStore::PageStore( Compression compression ):
+            impl( std::make_unique< IMPL >( compression ) )
+        {}
+        
+        PageStore::~PageStore( void )
+        {}
+        
+        PageStore::Compression PageStore::compression( void ) const
+        {
+            return this->impl->_compression;
+        }
+        
+        size_t PageStore::pages( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_pages.size() - this->impl->_free.size();
+        }
+        
+        size_t PageStore::references( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_references;
+        }
+        
+        uint64_t PageStore::storedBytes( void ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            return this->impl->_storedBytes;
+        }
+        
+        /*
+         * Returns a handle to the page, which holds one reference. Candidates
+         * with the same hash are compared byte for byte, so a hash collision
+         * can never merge different pages.
+         */
+        uint64_t PageStore::add( const uint8_t * page )
+        {
+            uint64_t hash;
+            
+            if( isZero( page ) )
+            {
+                return zeroPage;
+            }
+            
+            hash = PageStore::hash( page );
+            
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            {
+                auto range( this->impl->_index.equal_range( hash ) );
+                
+                for( auto i = range.first; i != range.second; ++i )
+                {
+                    uint8_t buf[ pageSize ];
+                    
+                    this->impl->_read( i->second, buf );
+                    
+                    if( memcmp( buf, page, pageSize ) == 0 )
+                    {
+                        this->impl->_pages[ i->second - 1 ]._refs++;
+                        this->impl->_references++;
+                        
+                        return i->second;
+                    }
+                }
+            }
+            
+            {
+                IMPL::Page stored;
+                uint64_t   handle;
+                
+                stored._hash       = hash;
+                stored._refs       = 1;
+                stored._compressed = false;
+                
+                #ifdef VBOX_HAVE_LZ4
+                if( this->impl->_compression == Compression::LZ4 )
+                {
+                    char buf[ LZ4_COMPRESSBOUND( pageSize ) ];
+                    int  size( LZ4_compress_default( reinterpret_cast< const char * >( page ), buf, static_cast< int >( pageSize ), static_cast< int >( sizeof( buf ) ) ) );
+                    
+                    if( size > 0 && static_cast< size_t >( size ) < pageSize )
+                    {
+                        stored._compressed = true;
+                        
+                        stored._data.assign( reinterpret_cast< uint8_t * >( buf ), reinterpret_cast< uint8_t * >( buf ) + size );
+                    }
+                }
+                #endif
+                
+                if( stored._compressed == false )
+                {
+                    stored._data.assign( page, page + pageSize );
+                }
+                
+                this->impl->_storedBytes += stored._data.size();
+                this->impl->_references++;
+                
+                if( this->impl->_free.size() > 0 )
+                {
+                    handle = this->impl->_free.back();
+                    
+                    this->impl->_free.pop_back();
+                    
+                    this->impl->_pages[ handle - 1 ] = std::move( stored );
+                }
+                else
+                {
+                    this->impl->_pages.push_back( std::move( stored ) );
+                    
+                    handle = this->impl->_pages.size();
+                }
+                
+                this->impl->_index.insert( { hash, handle } );
+                
+                return handle;
+            }
+        }
+        
+        void PageStore::retain( uint64_t handle )
+        {
+            if( handle == zeroPage )
+            {
+                return;
+            }
+            
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            this->impl->_pages.at( handle - 1 )._refs++;
+            this->impl->_references++;
+        }
+        
+        void PageStore::release( uint64_t handle )
+        {
+            if( handle == zeroPage )
+            {
+                return;
+            }
+            
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            {
+                IMPL::Page & page( this->impl->_pages.at( handle - 1 ) );
+                
+                if( page._refs == 0 )
+                {
+                    throw std::runtime_error( "Invalid page release" );
+                }
+                
+                this->impl->_references--;
+                
+                if( --page._refs > 0 )
+                {
+                    return;
+                }
+                
+                {
+                    auto range( this->impl->_index.equal_range( page._hash ) );
+                    
+                    for( auto i = range.first; i != range.second; ++i )
+                    {
+                        if( i->second == handle )
+                        {
+                            this->impl->_index.erase( i );
+                            
+                            break;
+                        }
+                    }
+                }
+                
+                this->impl->_storedBytes -= page._data.size();
+                
+                std::vector< uint8_t >().swap( page._data );
+                
+                if( this->impl->_cacheHandles[ handle % IMPL::cacheSlots ] == handle )
+                {
+                    this->impl->_cacheHandles[ handle % IMPL::cacheSlots ] = zeroPage;
+                }
+                
+                this->impl->_free.push_back( handle );
+            }
+        }
+        
+        void PageStore::read( uint64_t handle, uint8_t * page ) const
+        {
+            if( handle == zeroPage )
+            {
+                memset( page, 0, pageSize );
+                
+                return;
+            }
+            
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            this->impl->_read( handle, page );
+        }
+        
+        /*
+         * Hashes of stored pages, as computed by hash() when they were
+         * added, so pages never need to be read back to be indexed.
+         */
+        void PageStore::hashes( const uint64_t * handles, size_t count, uint64_t * hashes ) const
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            for( size_t i = 0; i < count; i++ )
+            {
+                hashes[ i ] = ( handles[ i ] == zeroPage ) ? zeroHash() : this->impl->_pages.at( handles[ i ] - 1 )._hash;
+            }
+        }
+        
+        PageStore::IMPL::IMPL( Compression compression ):
+            _compression(  compression ),
+            _references(   0 ),
+            _storedBytes(  0 ),
+            _cacheHandles( cacheSlots, zeroPage ),
+            _cache(        cacheSlots * pageSize )
+        {
+            if( supports( compression ) == false )
+            {
+                throw std::runtime_error( "Unsupported page compression" );
+            }
+        }
+        
+        /*
+         * 24 words of secret, enough for the 16 stripes of a block plus the
+         * scramble and merge keys. Generated with SplitMix64 rather than
+         * spelled out.
+         */
+        const uint64_t * PageStore::IMPL::_secret( void )
+        {
+            static const std::array< uint64_t, 24 > secret
+            (
+                []( void )
+                {
+                    std::array< uint64_t, 24 > s;
+                    uint64_t                   x( 0x9E3779B97F4A7C15 );
+                    
+                    for( auto & w: s )
+                    {
+                        uint64_t z( x += 0x9E3779B97F4A7C15 );
+                        
+                        z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9;
+                        z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EB;
+                        w = z ^ ( z >> 31 );
+                    }
+                    
+                    return s;
+                }
+                ()
+            );
+            
+            return secret.data();
+        }
+        
+        /*
+         * Compressed pages are decompressed into a small direct-mapped
+         * cache, so repeated reads of the same page (the memory pane redraws
+         * the same range every frame) only pay for decompression once.
+         * Must be called with the mutex held.
+         */
+        void PageStore::IMPL::_read( uint64_t handle, uint8_t * page ) const
+        {
+            const Page & stored( this->_pages.at( handle - 1 ) );
+            
+            if( stored._compressed == false )
+            {
+                memcpy( page, stored._data.data(), pageSize );
+                
+                return;
+            }
+            
+            {
+                size_t    slot( handle % cacheSlots );
+                uint8_t * cached( this->_cache.data() + ( slot * pageSize ) );
+                
+                if( this->_cacheHandles[ slot ] != handle )
+                {
+                    #ifdef VBOX_HAVE_LZ4
+                    if( LZ4_decompress_safe( reinterpret_cast< const char * >( stored._data.data() ), reinterpret_cast< char * >( cached ), static_cast< int >( stored._data.size() ), static_cast< int >( pageSize ) ) != static_cast< int >( pageSize ) )
+                    #endif
+                    {
+                        throw std::runtime_error( "Cannot decompress page" );
+                    }
+                    
+                    this->_cacheHandles[ slot ] = handle;
+                }
+                
+                memcpy( page, cached, pageSize );
+            }
+        }
+    }
+}
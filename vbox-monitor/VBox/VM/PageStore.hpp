@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_VM_PAGE_STORE_HPP
+#define VBOX_VM_PAGE_STORE_HPP
+
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+
+namespace VBox
+{
+    namespace VM
+    {
+        /*
+         * Content-addressed storage for guest memory pages, shared between
+         * snapshots. All-zero pages are never stored, identical pages are
+         * stored once and reference-counted, and pages can optionally be
+         * kept LZ4-compressed.
+         */
+        class PageStore
+        {
+            public:
+                
+                enum class Compression
+                {
+                    None,
+                    LZ4
+                };
+                
+                static constexpr size_t   pageSize = 4096;
+                static constexpr uint64_t zeroPage = 0;
+                
+                static bool     isZero( const uint8_t * page );
+                static uint64_t hash( const uint8_t * page );
+                static uint64_t zeroHash( void );
+                static bool     supports( Compression compression );
+                
+                PageStore( Compression compression = Compression::None );
+                ~PageStore( void );
+                
+                PageStore( const PageStore & o )              = delete;
+                PageStore( PageStore && o )                   = delete;
+                PageStore & operator =( const PageStore & o ) = delete;
+                PageStore & operator =( PageStore && o )      = delete;
+                
+                Compression compression( void ) const;
+                size_t      pages( void )       const;
+                size_t      references( void )  const;
+                uint64_t    storedBytes( void ) const;
+                
+                uint64_t add( const uint8_t * page );
+                void     retain( uint64_t handle );
+                void     release( uint64_t handle );
+                void     read( uint64_t handle, uint8_t * page ) const;
+                void     hashes( const uint64_t * handles, size_t count, uint64_t * hashes ) const;
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_VM_PAGE_STORE_HPP */
@@ -0,0 +1,240 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/VM/PartialCore.hpp"
+#include "VBox/Casts.hpp"
+#include "VBox/Pool.hpp"
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace VBox
+{
+    namespace VM
+    {
+        class PartialCore::IMPL
+        {
+            public:
+                
+                struct Segment
+                {
+                    uint64_t address;
+                    uint64_t size;
+                    uint64_t offset;
+                };
+                
+                IMPL( void );
+                
+                void _own( void );
+                
+                static constexpr uint64_t headerSize = 64;
+                static constexpr uint64_t entrySize  = 56;
+                
+                Pool< std::vector< uint8_t > >            _images;
+                std::shared_ptr< std::vector< uint8_t > > _image;
+                std::vector< Segment >                    _segments;
+                uint64_t                                  _size;
+                bool                                      _published;
+        };
+        
+        PartialCore::PartialCore( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        PartialCore::~PartialCore( void )
+        {}
+        
+        std::vector< std::pair< uint64_t, uint64_t > > PartialCore::ranges( void ) const
+        {
+            std::vector< std::pair< uint64_t, uint64_t > > ranges;
+            
+            for( const auto & segment: this->impl->_segments )
+            {
+                ranges.push_back( { segment.address, segment.size } );
+            }
+            
+            return ranges;
+        }
+        
+        uint64_t PartialCore::size( void ) const
+        {
+            return this->impl->_size;
+        }
+        
+        /*
+         * New segments are zero-filled. Ranges must be added in ascending
+         * order and not overlap, as a core's segments would.
+         */
+        size_t PartialCore::add( uint64_t address, uint64_t size )
+        {
+            if( size == 0 || address + size - 1 < address )
+            {
+                throw std::runtime_error( "Invalid memory range" );
+            }
+            
+            if( this->impl->_segments.size() > 0 && address < this->impl->_segments.back().address + this->impl->_segments.back().size )
+            {
+                throw std::runtime_error( "Memory ranges must be ascending" );
+            }
+            
+            if( this->impl->_segments.size() == 0xFFFF )
+            {
+                throw std::runtime_error( "Too many memory ranges" );
+            }
+            
+            this->impl->_own();
+            
+            this->impl->_segments.push_back( { address, size, this->impl->_size } );
+            
+            this->impl->_size += size;
+            
+            this->impl->_image->resize( numeric_cast< size_t >( IMPL::headerSize + this->impl->_size ), 0 );
+            
+            return this->impl->_segments.size() - 1;
+        }
+        
+        uint8_t * PartialCore::data( size_t segment )
+        {
+            uint64_t offset( this->impl->_segments.at( segment ).offset );
+            
+            this->impl->_own();
+            
+            return this->impl->_image->data() + IMPL::headerSize + offset;
+        }
+        
+        /*
+         * Keeps the allocated storage for the next ranges, unless it was
+         * handed out by file(), in which case a free image is recycled.
+         */
+        void PartialCore::reset( void )
+        {
+            if( this->impl->_published )
+            {
+                this->impl->_image     = this->impl->_images.acquire();
+                this->impl->_published = false;
+            }
+            
+            this->impl->_segments.clear();
+            this->impl->_image->resize( IMPL::headerSize );
+            
+            this->impl->_size = 0;
+        }
+        
+        /*
+         * Segments are read right after the ELF header, and the program
+         * headers follow them, so only the headers are written here. The
+         * image itself is handed out rather than copied, and is recycled
+         * once nothing references it anymore.
+         */
+        ELF::File PartialCore::file( void ) const
+        {
+            std::shared_ptr< std::vector< uint8_t > > image( this->impl->_image );
+            uint64_t                                  offset( ( IMPL::headerSize + this->impl->_size + 7 ) & ~static_cast< uint64_t >( 7 ) );
+            std::array< uint8_t, 16 >                 ident( { 0x7F, 'E', 'L', 'F', 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0 } );
+            size_t                                    position( 0 );
+            
+            auto put = [ & ]( uint64_t value, size_t size )
+            {
+                for( size_t i = 0; i < size; i++ )
+                {
+                    ( *( image ) )[ position++ ] = static_cast< uint8_t >( value >> ( i * 8 ) );
+                }
+            };
+            
+            if( this->impl->_published )
+            {
+                return ELF::File( image, image->data(), image->size() );
+            }
+            
+            image->resize( numeric_cast< size_t >( offset + IMPL::entrySize * this->impl->_segments.size() ), 0 );
+            
+            for( uint8_t c: ident )
+            {
+                put( c, 1 );
+            }
+            
+            put( 4, 2 );                                   /* ET_CORE */
+            put( 0x3E, 2 );                                /* EM_X86_64 */
+            put( 1, 4 );
+            put( 0, 8 );
+            put( offset, 8 );                              /* Program headers */
+            put( 0, 8 );
+            put( 0, 4 );
+            put( IMPL::headerSize, 2 );
+            put( IMPL::entrySize, 2 );
+            put( this->impl->_segments.size(), 2 );
+            put( 0, 2 );
+            put( 0, 2 );
+            put( 0, 2 );
+            
+            position = numeric_cast< size_t >( offset );
+            
+            for( const auto & segment: this->impl->_segments )
+            {
+                put( 1, 4 );                               /* PT_LOAD */
+                put( 6, 4 );
+                put( IMPL::headerSize + segment.offset, 8 );
+                put( 0, 8 );
+                put( segment.address, 8 );
+                put( segment.size, 8 );
+                put( segment.size, 8 );
+                put( 1, 8 );
+            }
+            
+            this->impl->_published = true;
+            
+            return ELF::File( image, image->data(), image->size() );
+        }
+        
+        PartialCore::IMPL::IMPL( void ):
+            _image(     _images.acquire() ),
+            _size(      0 ),
+            _published( false )
+        {
+            this->_image->resize( headerSize );
+        }
+        
+        /*
+         * An image handed out by file() may still be read, so it is copied
+         * to a free one before it is changed.
+         */
+        void PartialCore::IMPL::_own( void )
+        {
+            std::shared_ptr< std::vector< uint8_t > > image;
+            
+            if( this->_published == false )
+            {
+                return;
+            }
+            
+            image = this->_images.acquire();
+            
+            image->assign( this->_image->begin(), this->_image->begin() + numeric_cast< ptrdiff_t >( headerSize + this->_size ) );
+            
+            this->_image     = image;
+            this->_published = false;
+        }
+    }
+}
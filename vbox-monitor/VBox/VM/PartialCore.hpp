@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_VM_PARTIAL_CORE_HPP
+#define VBOX_VM_PARTIAL_CORE_HPP
+
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "VBox/ELF/File.hpp"
+
+namespace VBox
+{
+    namespace VM
+    {
+        /*
+         * Ranges of guest memory read separately, rather than dumped at
+         * once, turned into an ELF core with one PT_LOAD segment per range
+         * so they load as a CoreDump like a full dump does.
+         * Segments are added first, then filled through data(), which is
+         * only valid until the next add() or file(). Images are taken from
+         * a pool, so steady-state reads do not allocate images.
+         */
+        class PartialCore
+        {
+            public:
+                
+                PartialCore( void );
+                ~PartialCore( void );
+                
+                PartialCore( const PartialCore & o )              = delete;
+                PartialCore( PartialCore && o )                   = delete;
+                PartialCore & operator =( const PartialCore & o ) = delete;
+                PartialCore & operator =( PartialCore && o )      = delete;
+                
+                std::vector< std::pair< uint64_t, uint64_t > > ranges( void ) const;
+                uint64_t                                       size( void )   const;
+                
+                size_t    add( uint64_t address, uint64_t size );
+                uint8_t * data( size_t segment );
+                void      reset( void );
+                
+                ELF::File file( void ) const;
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_VM_PARTIAL_CORE_HPP */
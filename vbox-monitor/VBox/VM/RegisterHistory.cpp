@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "VBox/VM/RegisterHistory.hpp"
+#include <array>
+#include <bitset>
+
+namespace VBox
+{
+    namespace VM
+    {
+        class RegisterHistory::IMPL
+        {
+            public:
+                
+                IMPL( void );
+                IMPL( const IMPL & o );
+                
+                IMPL & operator =( const IMPL & o ) = default;
+                
+                static_assert( capacity <= 32, "Change masks are stored as 32-bit values" );
+                
+                std::array< std::array< uint64_t, capacity >, Registers::count > _values;
+                std::array< uint32_t, Registers::count >                         _changes;
+                size_t                                                           _head;
+                uint64_t                                                         _samples;
+        };
+        
+        RegisterHistory::RegisterHistory( void ):
+            impl( std::make_unique< IMPL >() )
+        {}
+        
+        RegisterHistory::RegisterHistory( const RegisterHistory & o ):
+            impl( std::make_unique< IMPL >( *( o.impl ) ) )
+        {}
+        
+        RegisterHistory::RegisterHistory( RegisterHistory && o ):
+            impl( std::move( o.impl ) )
+        {}
+        
+        RegisterHistory::~RegisterHistory( void )
+        {}
+        
+        /*
+         * Copies into the existing storage, so a recycled history can be
+         * overwritten without allocating.
+         */
+        RegisterHistory & RegisterHistory::operator =( const RegisterHistory & o )
+        {
+            if( this->impl == nullptr )
+            {
+                this->impl = std::make_unique< IMPL >( *( o.impl ) );
+            }
+            else
+            {
+                *( this->impl ) = *( o.impl );
+            }
+            
+            return *( this );
+        }
+        
+        RegisterHistory & RegisterHistory::operator =( RegisterHistory && o )
+        {
+            swap( *( this ), o );
+            
+            return *( this );
+        }
+        
+        uint64_t RegisterHistory::samples( void ) const
+        {
+            return this->impl->_samples;
+        }
+        
+        bool RegisterHistory::settled( void ) const
+        {
+            for( uint32_t mask: this->impl->_changes )
+            {
+                if( mask != 0 )
+                {
+                    return false;
+                }
+            }
+            
+            return true;
+        }
+        
+        bool RegisterHistory::changed( Registers::ID id ) const
+        {
+            return ( this->impl->_changes[ static_cast< size_t >( id ) ] & 1 ) != 0;
+        }
+        
+        size_t RegisterHistory::changes( Registers::ID id ) const
+        {
+            return std::bitset< 32 >( this->impl->_changes[ static_cast< size_t >( id ) ] ).count();
+        }
+        
+        uint64_t RegisterHistory::value( Registers::ID id, size_t age ) const
+        {
+            if( age >= std::min< uint64_t >( this->impl->_samples, capacity ) )
+            {
+                return 0;
+            }
+            
+            return this->impl->_values[ static_cast< size_t >( id ) ][ ( this->impl->_head + capacity - age ) % capacity ];
+        }
+        
+        std::string RegisterHistory::sparkline( Registers::ID id, size_t width ) const
+        {
+            static const std::string levels( " .:-=+*#" );
+            
+            std::string s;
+            uint32_t    mask( this->impl->_changes[ static_cast< size_t >( id ) ] );
+            size_t      step;
+            
+            width = std::min( std::max< size_t >( width, 1 ), capacity );
+            step  = capacity / width;
+            
+            for( size_t i = width; i > 0; i-- )
+            {
+                uint32_t bits( ( mask >> ( ( i - 1 ) * step ) ) & ( ( 1ULL << step ) - 1 ) );
+                size_t   n( std::bitset< 32 >( bits ).count() );
+                
+                s += levels[ ( ( n * ( levels.size() - 1 ) ) + step - 1 ) / step ];
+            }
+            
+            return s;
+        }
+        
+        void RegisterHistory::add( const Registers & registers )
+        {
+            size_t next( ( this->impl->_head + 1 ) % capacity );
+            
+            for( size_t i = 0; i < Registers::count; i++ )
+            {
+                uint64_t value( registers.value( static_cast< Registers::ID >( i ) ) );
+                bool     changed( this->impl->_samples > 0 && value != this->impl->_values[ i ][ this->impl->_head ] );
+                
+                this->impl->_changes[ i ]        = ( this->impl->_changes[ i ] << 1 ) | ( changed ? 1 : 0 );
+                this->impl->_values[ i ][ next ] = value;
+            }
+            
+            this->impl->_head = next;
+            
+            this->impl->_samples++;
+        }
+        
+        void swap( RegisterHistory & o1, RegisterHistory & o2 )
+        {
+            using std::swap;
+            
+            swap( o1.impl, o2.impl );
+        }
+        
+        RegisterHistory::IMPL::IMPL( void ):
+            _values{},
+            _changes{},
+            _head( 0 ),
+            _samples( 0 )
+        {}
+        
+        RegisterHistory::IMPL::IMPL( const IMPL & o ):
+            _values(  o._values ),
+            _changes( o._changes ),
+            _head(    o._head ),
+            _samples( o._samples )
+        {}
+    }
+}
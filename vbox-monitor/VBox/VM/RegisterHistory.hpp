@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2019 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#ifndef VBOX_VM_REGISTER_HISTORY_HPP
+#define VBOX_VM_REGISTER_HISTORY_HPP
+
+#include "VBox/VM/Registers.hpp"
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <string>
+
+namespace VBox
+{
+    namespace VM
+    {
+        class RegisterHistory
+        {
+            public:
+                
+                static constexpr size_t capacity = 32;
+                
+                RegisterHistory( void );
+                RegisterHistory( const RegisterHistory & o );
+                RegisterHistory( RegisterHistory && o );
+                ~RegisterHistory( void );
+                
+                RegisterHistory & operator =( const RegisterHistory & o );
+                RegisterHistory & operator =( RegisterHistory && o );
+                
+                uint64_t    samples( void )                             const;
+                bool        settled( void )                             const;
+                bool        changed( Registers::ID id )                 const;
+                size_t      changes( Registers::ID id )                 const;
+                uint64_t    value( Registers::ID id, size_t age )       const;
+                std::string sparkline( Registers::ID id, size_t width ) const;
+                
+                void add( const Registers & registers );
+                
+                friend void swap( RegisterHistory & o1, RegisterHistory & o2 );
+                
+            private:
+                
+                class IMPL;
+                std::unique_ptr< IMPL > impl;
+        };
+    }
+}
+
+#endif /* VBOX_VM_REGISTER_HISTORY_HPP */
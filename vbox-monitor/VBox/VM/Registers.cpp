@@ -29,265 +29,321 @@ namespace VBox
 {
     namespace VM
     {
-        class Registers::IMPL
-        {
-            public:
-                
-                IMPL( void );
-                IMPL( const IMPL & o );
-                
-                uint64_t _rax;
-                uint64_t _rbx;
-                uint64_t _rcx;
-                uint64_t _rdx;
-                uint64_t _rdi;
-                uint64_t _rsi;
-                uint64_t _r8;
-                uint64_t _r9;
-                uint64_t _r10;
-                uint64_t _r11;
-                uint64_t _r12;
-                uint64_t _r13;
-                uint64_t _r14;
-                uint64_t _r15;
-                uint64_t _rbp;
-                uint64_t _rsp;
-                uint64_t _rip;
-                uint64_t _eflags;
-        };
-        
-        Registers::Registers( void ):
-            impl( std::make_unique< IMPL >() )
-        {}
-        
-        Registers::Registers( const Registers & o ):
-            impl( std::make_unique< IMPL >( *( o.impl ) ) )
-        {}
-        
-        Registers::Registers( Registers && o ):
-            impl( std::move( o.impl ) )
-        {}
-        
-        Registers::~Registers( void )
-        {}
-        
-        Registers & Registers::operator =( Registers o )
+        std::string Registers::name( ID id )
         {
-            swap( *( this ), o );
+            static const char * names[ count ] =
+            {
+                "rax", "rbx", "rcx", "rdx", "rdi", "rsi",
+                "r8",  "r9",  "r10", "r11", "r12", "r13",
+                "r14", "r15", "rbp", "rsp", "rip", "eflags"
+            };
             
-            return *( this );
+            return names[ static_cast< size_t >( id ) ];
         }
         
+        Registers::Registers( void ):
+            _rax(    0 ),
+            _rbx(    0 ),
+            _rcx(    0 ),
+            _rdx(    0 ),
+            _rdi(    0 ),
+            _rsi(    0 ),
+            _r8(     0 ),
+            _r9(     0 ),
+            _r10(    0 ),
+            _r11(    0 ),
+            _r12(    0 ),
+            _r13(    0 ),
+            _r14(    0 ),
+            _r15(    0 ),
+            _rbp(    0 ),
+            _rsp(    0 ),
+            _rip(    0 ),
+            _eflags( 0 )
+        {}
+        
         uint64_t Registers::rax( void ) const
         {
-            return this->impl->_rax;
+            return this->_rax;
         }
         
         uint64_t Registers::rbx( void ) const
         {
-            return this->impl->_rbx;
+            return this->_rbx;
         }
         
         uint64_t Registers::rcx( void ) const
         {
-            return this->impl->_rcx;
+            return this->_rcx;
         }
         
         uint64_t Registers::rdx( void ) const
         {
-            return this->impl->_rdx;
+            return this->_rdx;
         }
         
         uint64_t Registers::rdi( void ) const
         {
-            return this->impl->_rdi;
+            return this->_rdi;
         }
         
         uint64_t Registers::rsi( void ) const
         {
-            return this->impl->_rsi;
+            return this->_rsi;
         }
         
         uint64_t Registers::r8( void ) const
         {
-            return this->impl->_r8;
+            return this->_r8;
         }
         
         uint64_t Registers::r9( void ) const
         {
-            return this->impl->_r9;
+            return this->_r9;
         }
         
         uint64_t Registers::r10( void ) const
         {
-            return this->impl->_r10;
+            return this->_r10;
         }
         
         uint64_t Registers::r11( void ) const
         {
-            return this->impl->_r11;
+            return this->_r11;
         }
         
         uint64_t Registers::r12( void ) const
         {
-            return this->impl->_r12;
+            return this->_r12;
         }
         
         uint64_t Registers::r13( void ) const
         {
-            return this->impl->_r13;
+            return this->_r13;
         }
         
         uint64_t Registers::r14( void ) const
         {
-            return this->impl->_r14;
+            return this->_r14;
         }
         
         uint64_t Registers::r15( void ) const
         {
-            return this->impl->_r15;
+            return this->_r15;
         }
         
         uint64_t Registers::rbp( void ) const
         {
-            return this->impl->_rbp;
+            return this->_rbp;
         }
         
         uint64_t Registers::rsp( void ) const
         {
-            return this->impl->_rsp;
+            return this->_rsp;
         }
         
         uint64_t Registers::rip( void ) const
         {
-            return this->impl->_rip;
+            return this->_rip;
         }
         
         uint64_t Registers::eflags( void ) const
         {
-            return this->impl->_eflags;
+            return this->_eflags;
         }
         
         void Registers::rax( uint64_t value )
         {
-            this->impl->_rax = value;
+            this->_rax = value;
         }
         
         void Registers::rbx( uint64_t value )
         {
-            this->impl->_rbx = value;
+            this->_rbx = value;
         }
         
         void Registers::rcx( uint64_t value )
         {
-            this->impl->_rcx = value;
+            this->_rcx = value;
         }
         
         void Registers::rdx( uint64_t value )
         {
-            this->impl->_rdx = value;
+            this->_rdx = value;
         }
         
         void Registers::rdi( uint64_t value )
         {
-            this->impl->_rdi = value;
+            this->_rdi = value;
         }
         
         void Registers::rsi( uint64_t value )
         {
-            this->impl->_rsi = value;
+            this->_rsi = value;
         }
         
         void Registers::r8(  uint64_t value )
         {
-            this->impl->_r8 = value;
+            this->_r8 = value;
         }
         
         void Registers::r9(  uint64_t value )
         {
-            this->impl->_r9 = value;
+            this->_r9 = value;
         }
         
         void Registers::r10( uint64_t value )
         {
-            this->impl->_r10 = value;
+            this->_r10 = value;
         }
         
         void Registers::r11( uint64_t value )
         {
-            this->impl->_r11 = value;
+            this->_r11 = value;
         }
         
         void Registers::r12( uint64_t value )
         {
-            this->impl->_r12 = value;
+            this->_r12 = value;
         }
         
         void Registers::r13( uint64_t value )
         {
-            this->impl->_r13 = value;
+            this->_r13 = value;
         }
         
         void Registers::r14( uint64_t value )
         {
-            this->impl->_r14 = value;
+            this->_r14 = value;
         }
         
         void Registers::r15( uint64_t value )
         {
-            this->impl->_r15 = value;
+            this->_r15 = value;
         }
         
         void Registers::rbp( uint64_t value )
         {
-            this->impl->_rbp = value;
+            this->_rbp = value;
         }
         
         void Registers::rsp( uint64_t value )
         {
-            this->impl->_rsp = value;
+            this->_rsp = value;
         }
         
         void Registers::rip( uint64_t value )
         {
-            this->impl->_rip = value;
+            this->_rip = value;
         }
         
         void Registers::eflags( uint64_t value )
         {
-            this->impl->_eflags = value;
+            this->_eflags = value;
+        }
+        
+        uint64_t Registers::value( ID id ) const
+        {
+            switch( id )
+            {
+                case ID::RAX:    return this->_rax;
+                case ID::RBX:    return this->_rbx;
+                case ID::RCX:    return this->_rcx;
+                case ID::RDX:    return this->_rdx;
+                case ID::RDI:    return this->_rdi;
+                case ID::RSI:    return this->_rsi;
+                case ID::R8:     return this->_r8;
+                case ID::R9:     return this->_r9;
+                case ID::R10:    return this->_r10;
+                case ID::R11:    return this->_r11;
+                case ID::R12:    return this->_r12;
+                case ID::R13:    return this->_r13;
+                case ID::R14:    return this->_r14;
+                case ID::R15:    return this->_r15;
+                case ID::RBP:    return this->_rbp;
+                case ID::RSP:    return this->_rsp;
+                case ID::RIP:    return this->_rip;
+                case ID::EFLAGS: return this->_eflags;
+            }
+            
+            return 0;
+        }
+        
+        void Registers::value( ID id, uint64_t value )
+        {
+            switch( id )
+            {
+                case ID::RAX:    this->_rax    = value; break;
+                case ID::RBX:    this->_rbx    = value; break;
+                case ID::RCX:    this->_rcx    = value; break;
+                case ID::RDX:    this->_rdx    = value; break;
+                case ID::RDI:    this->_rdi    = value; break;
+                case ID::RSI:    this->_rsi    = value; break;
+                case ID::R8:     this->_r8     = value; break;
+                case ID::R9:     this->_r9     = value; break;
+                case ID::R10:    this->_r10    = value; break;
+                case ID::R11:    this->_r11    = value; break;
+                case ID::R12:    this->_r12    = value; break;
+                case ID::R13:    this->_r13    = value; break;
+                case ID::R14:    this->_r14    = value; break;
+                case ID::R15:    this->_r15    = value; break;
+                case ID::RBP:    this->_rbp    = value; break;
+                case ID::RSP:    this->_rsp    = value; break;
+                case ID::RIP:    this->_rip    = value; break;
+                case ID::EFLAGS: this->_eflags = value; break;
+            }
         }
         
         std::vector< std::pair< std::string, uint64_t > > Registers::all( void ) const
         {
             return
             {
-                { "rax",    this->impl->_rax },
-                { "rbx",    this->impl->_rbx },
-                { "rcx",    this->impl->_rcx },
-                { "rdx",    this->impl->_rdx },
-                { "rdi",    this->impl->_rdi },
-                { "rsi",    this->impl->_rsi },
-                { "r8",     this->impl->_r8 },
-                { "r9",     this->impl->_r9 },
-                { "r10",    this->impl->_r10 },
-                { "r11",    this->impl->_r11 },
-                { "r12",    this->impl->_r12 },
-                { "r13",    this->impl->_r13 },
-                { "r14",    this->impl->_r14 },
-                { "r15",    this->impl->_r15 },
-                { "rbp",    this->impl->_rbp },
-                { "rsp",    this->impl->_rsp },
-                { "rip",    this->impl->_rip },
-                { "eflags", this->impl->_eflags }
+                { "rax",    this->_rax },
+                { "rbx",    this->_rbx },
+                { "rcx",    this->_rcx },
+                { "rdx",    this->_rdx },
+                { "rdi",    this->_rdi },
+                { "rsi",    this->_rsi },
+                { "r8",     this->_r8 },
+                { "r9",     this->_r9 },
+                { "r10",    this->_r10 },
+                { "r11",    this->_r11 },
+                { "r12",    this->_r12 },
+                { "r13",    this->_r13 },
+                { "r14",    this->_r14 },
+                { "r15",    this->_r15 },
+                { "rbp",    this->_rbp },
+                { "rsp",    this->_rsp },
+                { "rip",    this->_rip },
+                { "eflags", this->_eflags }
             };
         }
         
-        void swap( Registers & o1, Registers & o2 )
+        bool Registers::operator ==( const Registers & o ) const
         {
-            using std::swap;
-            
-            swap( o1.impl, o2.impl );
+            return this->_rax    == o._rax
+                && this->_rbx    == o._rbx
+                && this->_rcx    == o._rcx
+                && this->_rdx    == o._rdx
+                && this->_rdi    == o._rdi
+                && this->_rsi    == o._rsi
+                && this->_r8     == o._r8
+                && this->_r9     == o._r9
+                && this->_r10    == o._r10
+                && this->_r11    == o._r11
+                && this->_r12    == o._r12
+                && this->_r13    == o._r13
+                && this->_r14    == o._r14
+                && this->_r15    == o._r15
+                && this->_rbp    == o._rbp
+                && this->_rsp    == o._rsp
+                && this->_rip    == o._rip
+                && this->_eflags == o._eflags;
+        }
+        
+        bool Registers::operator !=( const Registers & o ) const
+        {
+            return !( *( this ) == o );
         }
         
         std::ostream & operator <<( std::ostream & os, const Registers & o )
@@ -299,47 +355,5 @@ namespace VBox
             
             return os;
         }
-        
-        Registers::IMPL::IMPL( void ):
-            _rax(    0 ),
-            _rbx(    0 ),
-            _rcx(    0 ),
-            _rdx(    0 ),
-            _rdi(    0 ),
-            _rsi(    0 ),
-            _r8(     0 ),
-            _r9(     0 ),
-            _r10(    0 ),
-            _r11(    0 ),
-            _r12(    0 ),
-            _r13(    0 ),
-            _r14(    0 ),
-            _r15(    0 ),
-            _rbp(    0 ),
-            _rsp(    0 ),
-            _rip(    0 ),
-            _eflags( 0 )
-        {}
-        
-        Registers::IMPL::IMPL( const IMPL & o ):
-            _rax(    o._rax ),
-            _rbx(    o._rbx ),
-            _rcx(    o._rcx ),
-            _rdx(    o._rdx ),
-            _rdi(    o._rdi ),
-            _rsi(    o._rsi ),
-            _r8(     o._r8 ),
-            _r9(     o._r9 ),
-            _r10(    o._r10 ),
-            _r11(    o._r11 ),
-            _r12(    o._r12 ),
-            _r13(    o._r13 ),
-            _r14(    o._r14 ),
-            _r15(    o._r15 ),
-            _rbp(    o._rbp ),
-            _rsp(    o._rsp ),
-            _rip(    o._rip ),
-            _eflags( o._eflags )
-        {}
     }
 }
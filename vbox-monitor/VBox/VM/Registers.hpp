@@ -26,25 +26,51 @@
 #define VBOX_VM_REGISTERS_HPP
 
 #include <cstdint>
-#include <memory>
-#include <algorithm>
+#include <type_traits>
 #include <ostream>
 #include <vector>
+#include <string>
 
 namespace VBox
 {
     namespace VM
     {
+        /*
+         * Plain value type: registers are stored in ID order with no
+         * padding, so snapshots can be copied with memcpy and serialized
+         * as-is.
+         */
         class Registers
         {
             public:
                 
-                Registers( void );
-                Registers( const Registers & o );
-                Registers( Registers && o );
-                ~Registers( void );
+                enum class ID: size_t
+                {
+                    RAX,
+                    RBX,
+                    RCX,
+                    RDX,
+                    RDI,
+                    RSI,
+                    R8,
+                    R9,
+                    R10,
+                    R11,
+                    R12,
+                    R13,
+                    R14,
+                    R15,
+                    RBP,
+                    RSP,
+                    RIP,
+                    EFLAGS
+                };
+                
+                static constexpr size_t count = 18;
                 
-                Registers & operator =( Registers o );
+                static std::string name( ID id );
+                
+                Registers( void );
                 
                 uint64_t rax( void )    const;
                 uint64_t rbx( void )    const;
@@ -84,17 +110,41 @@ namespace VBox
                 void rip( uint64_t value );
                 void eflags( uint64_t value );
                 
+                uint64_t value( ID id ) const;
+                void     value( ID id, uint64_t value );
+                
                 std::vector< std::pair< std::string, uint64_t > > all( void ) const;
                 
-                friend void swap( Registers & o1, Registers & o2 );
+                bool operator ==( const Registers & o ) const;
+                bool operator !=( const Registers & o ) const;
                 
                 friend std::ostream & operator <<( std::ostream & os, const Registers & o );
                 
             private:
                 
-                class IMPL;
-                std::unique_ptr< IMPL > impl;
+                uint64_t _rax;
+                uint64_t _rbx;
+                uint64_t _rcx;
+                uint64_t _rdx;
+                uint64_t _rdi;
+                uint64_t _rsi;
+                uint64_t _r8;
+                uint64_t _r9;
+                uint64_t _r10;
+                uint64_t _r11;
+                uint64_t _r12;
+                uint64_t _r13;
+                uint64_t _r14;
+                uint64_t _r15;
+                uint64_t _rbp;
+                uint64_t _rsp;
+                uint64_t _rip;
+                uint64_t _eflags;
         };
+        
+        static_assert( std::is_trivially_copyable< Registers >::value,               "Registers must be trivially copyable" );
+        static_assert( std::is_standard_layout< Registers >::value,                  "Registers must have a standard layout" );
+        static_assert( sizeof( Registers ) == Registers::count * sizeof( uint64_t ), "Registers must not be padded" );
     }
 }
 
@@ -23,84 +23,49 @@
  ******************************************************************************/
 
 #include "VBox/VM/SegmentAddress.hpp"
-#include "VBox/String.hpp"
 
 namespace VBox
 {
     namespace VM
     {
-        class SegmentAddress::IMPL
-        {
-            public:
-                
-                IMPL( uint32_t segment, uint32_t address );
-                IMPL( const IMPL & o );
-                
-                uint32_t _segment;
-                uint32_t _address;
-        };
-        
         SegmentAddress::SegmentAddress( void ):
             SegmentAddress( 0, 0 )
         {}
         
         SegmentAddress::SegmentAddress( uint32_t segment, uint32_t address ):
-            impl( std::make_unique< IMPL >( segment, address ) )
-        {}
-        
-        SegmentAddress::SegmentAddress( const SegmentAddress & o ):
-            impl( std::make_unique< IMPL >( *( o.impl ) ) )
-        {}
-        
-        SegmentAddress::SegmentAddress( SegmentAddress && o ):
-            impl( std::move( o.impl ) )
-        {}
-        
-        SegmentAddress::~SegmentAddress( void )
+            _segment( segment ),
+            _address( address )
         {}
         
-        SegmentAddress & SegmentAddress::operator =( SegmentAddress o )
-        {
-            swap( *( this ), o );
-            
-            return *( this );
-        }
-        
         uint32_t SegmentAddress::segment( void ) const
         {
-            return this->impl->_segment;
+            return this->_segment;
         }
         
         uint32_t SegmentAddress::address( void ) const
         {
-            return this->impl->_address;
+            return this->_address;
         }
         
         void SegmentAddress::segment( uint32_t value )
         {
-            this->impl->_segment = value;
+            this->_segment = value;
         }
         
         void SegmentAddress::address( uint32_t value )
         {
-            this->impl->_address = value;
+            this->_address = value;
         }
         
-        void swap( SegmentAddress & o1, SegmentAddress & o2 )
+        bool SegmentAddress::operator ==( const SegmentAddress & o ) const
         {
-            using std::swap;
-            
-            swap( o1.impl, o2.impl );
+            return this->_segment == o._segment
+                && this->_address == o._address;
         }
         
-        SegmentAddress::IMPL::IMPL( uint32_t segment, uint32_t address ):
-            _segment( segment ),
-            _address( address )
-        {}
-        
-        SegmentAddress::IMPL::IMPL( const IMPL & o ):
-            _segment( o._segment ),
-            _address( o._address )
-        {}
+        bool SegmentAddress::operator !=( const SegmentAddress & o ) const
+        {
+            return !( *( this ) == o );
+        }
     }
 }
@@ -26,24 +26,22 @@
 #define VBOX_VM_SEGMENT_ADDRESS_HPP
 
 #include <cstdint>
-#include <algorithm>
-#include <memory>
+#include <type_traits>
 
 namespace VBox
 {
     namespace VM
     {
+        /*
+         * Plain value type, so entries can be copied with memcpy, stored in
+         * contiguous arrays and serialized as-is.
+         */
         class SegmentAddress
         {
             public:
                 
                 SegmentAddress( void );
                 SegmentAddress( uint32_t segment, uint32_t address );
-                SegmentAddress( const SegmentAddress & o );
-                SegmentAddress( SegmentAddress && o );
-                ~SegmentAddress( void );
-                
-                SegmentAddress & operator =( SegmentAddress o );
                 
                 uint32_t segment( void ) const;
                 uint32_t address( void ) const;
@@ -51,13 +49,18 @@ namespace VBox
                 void segment( uint32_t value );
                 void address( uint32_t value );
                 
-                friend void swap( SegmentAddress & o1, SegmentAddress & o2 );
+                bool operator ==( const SegmentAddress & o ) const;
+                bool operator !=( const SegmentAddress & o ) const;
                 
             private:
                 
-                class IMPL;
-                std::unique_ptr< IMPL > impl;
+                uint32_t _segment;
+                uint32_t _address;
         };
+        
+        static_assert( std::is_trivially_copyable< SegmentAddress >::value, "SegmentAddress must be trivially copyable" );
+        static_assert( std::is_standard_layout< SegmentAddress >::value,    "SegmentAddress must have a standard layout" );
+        static_assert( sizeof( SegmentAddress ) == 8,                       "SegmentAddress must not be padded" );
     }
 }
 
@@ -23,154 +23,113 @@
  ******************************************************************************/
 
 #include "VBox/VM/StackEntry.hpp"
-#include "VBox/String.hpp"
 
 namespace VBox
 {
     namespace VM
     {
-        class StackEntry::IMPL
-        {
-            public:
-                
-                IMPL( void );
-                IMPL( const IMPL & o );
-                
-                SegmentAddress _bp;
-                SegmentAddress _retBP;
-                SegmentAddress _retIP;
-                uint32_t       _arg0;
-                uint32_t       _arg1;
-                uint32_t       _arg2;
-                uint32_t       _arg3;
-                SegmentAddress _ip;
-        };
-        
         StackEntry::StackEntry( void ):
-            impl( std::make_unique< IMPL >() )
-        {}
-        
-        StackEntry::StackEntry( const StackEntry & o ):
-            impl( std::make_unique< IMPL >( *( o.impl ) ) )
-        {}
-        
-        StackEntry::StackEntry( StackEntry && o ):
-            impl( std::move( o.impl ) )
-        {}
-        
-        StackEntry::~StackEntry( void )
+            _arg0( 0 ),
+            _arg1( 0 ),
+            _arg2( 0 ),
+            _arg3( 0 )
         {}
         
-        StackEntry & StackEntry::operator =( StackEntry o )
-        {
-            swap( *( this ), o );
-            
-            return *( this );
-        }
-        
         SegmentAddress StackEntry::bp( void ) const
         {
-            return this->impl->_bp;
+            return this->_bp;
         }
         
         SegmentAddress StackEntry::retBP( void ) const
         {
-            return this->impl->_retBP;
+            return this->_retBP;
         }
         
         SegmentAddress StackEntry::retIP( void ) const
         {
-            return this->impl->_retIP;
+            return this->_retIP;
         }
         
         uint32_t StackEntry::arg0( void ) const
         {
-            return this->impl->_arg0;
+            return this->_arg0;
         }
         
         uint32_t StackEntry::arg1( void ) const
         {
-            return this->impl->_arg1;
+            return this->_arg1;
         }
         
         uint32_t StackEntry::arg2( void ) const
         {
-            return this->impl->_arg2;
+            return this->_arg2;
         }
         
         uint32_t StackEntry::arg3( void ) const
         {
-            return this->impl->_arg3;
+            return this->_arg3;
         }
         
         SegmentAddress StackEntry::ip( void ) const
         {
-            return this->impl->_ip;
+            return this->_ip;
         }
         
         void StackEntry::bp( const SegmentAddress & value )
         {
-            this->impl->_bp = value;
+            this->_bp = value;
         }
         
         void StackEntry::retBP( const SegmentAddress & value )
         {
-            this->impl->_retBP = value;
+            this->_retBP = value;
         }
         
         void StackEntry::retIP( const SegmentAddress & value )
         {
-            this->impl->_retIP = value;
+            this->_retIP = value;
         }
         
         void StackEntry::arg0( uint32_t value )
         {
-            this->impl->_arg0 = value;
+            this->_arg0 = value;
         }
         
         void StackEntry::arg1( uint32_t value )
         {
-            this->impl->_arg1 = value;
+            this->_arg1 = value;
         }
         
         void StackEntry::arg2( uint32_t value )
         {
-            this->impl->_arg2 = value;
+            this->_arg2 = value;
         }
         
         void StackEntry::arg3( uint32_t value )
         {
-            this->impl->_arg3 = value;
+            this->_arg3 = value;
         }
         
         void StackEntry::ip( const SegmentAddress & value )
         {
-            this->impl->_ip = value;
+            this->_ip = value;
         }
         
-        void swap( StackEntry & o1, StackEntry & o2 )
+        bool StackEntry::operator ==( const StackEntry & o ) const
         {
-            using std::swap;
-            
-            swap( o1.impl, o2.impl );
+            return this->_bp    == o._bp
+                && this->_retBP == o._retBP
+                && this->_retIP == o._retIP
+                && this->_arg0  == o._arg0
+                && this->_arg1  == o._arg1
+                && this->_arg2  == o._arg2
+                && this->_arg3  == o._arg3
+                && this->_ip    == o._ip;
         }
         
-        StackEntry::IMPL::IMPL( void ):
-            _arg0( 0 ),
-            _arg1( 0 ),
-            _arg2( 0 ),
-            _arg3( 0 )
-        {}
-        
-        StackEntry::IMPL::IMPL( const IMPL & o ):
-            _bp(    o._bp ),
-            _retBP( o._retBP ),
-            _retIP( o._retIP ),
-            _arg0(  o._arg0 ),
-            _arg1(  o._arg1 ),
-            _arg2(  o._arg2 ),
-            _arg3(  o._arg3 ),
-            _ip(    o._ip )
-        {}
+        bool StackEntry::operator !=( const StackEntry & o ) const
+        {
+            return !( *( this ) == o );
+        }
     }
 }
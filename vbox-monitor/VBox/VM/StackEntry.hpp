@@ -27,25 +27,21 @@
 
 #include "VBox/VM/SegmentAddress.hpp"
 #include <cstdint>
-#include <memory>
-#include <algorithm>
-#include <ostream>
-#include <vector>
+#include <type_traits>
 
 namespace VBox
 {
     namespace VM
     {
+        /*
+         * Plain value type, so stacks are contiguous arrays of entries that
+         * can be copied with memcpy and serialized as-is.
+         */
         class StackEntry
         {
             public:
                 
                 StackEntry( void );
-                StackEntry( const StackEntry & o );
-                StackEntry( StackEntry && o );
-                ~StackEntry( void );
-                
-                StackEntry & operator =( StackEntry o );
                 
                 SegmentAddress bp( void )    const;
                 SegmentAddress retBP( void ) const;
@@ -65,13 +61,24 @@ namespace VBox
                 void arg3(  uint32_t value );
                 void ip(    const SegmentAddress & value );
                 
-                friend void swap( StackEntry & o1, StackEntry & o2 );
+                bool operator ==( const StackEntry & o ) const;
+                bool operator !=( const StackEntry & o ) const;
                 
             private:
                 
-                class IMPL;
-                std::unique_ptr< IMPL > impl;
+                SegmentAddress _bp;
+                SegmentAddress _retBP;
+                SegmentAddress _retIP;
+                uint32_t       _arg0;
+                uint32_t       _arg1;
+                uint32_t       _arg2;
+                uint32_t       _arg3;
+                SegmentAddress _ip;
         };
+        
+        static_assert( std::is_trivially_copyable< StackEntry >::value, "StackEntry must be trivially copyable" );
+        static_assert( std::is_standard_layout< StackEntry >::value,    "StackEntry must have a standard layout" );
+        static_assert( sizeof( StackEntry ) == 48,                      "StackEntry must not be padded" );
     }
 }
 
@@ -66,11 +66,41 @@ namespace VBox
         return *( this );
     }
     
+    size_t Window::x( void ) const
+    {
+        return this->impl->_x;
+    }
+    
+    size_t Window::y( void ) const
+    {
+        return this->impl->_y;
+    }
+    
+    size_t Window::width( void ) const
+    {
+        return this->impl->_width;
+    }
+    
+    size_t Window::height( void ) const
+    {
+        return this->impl->_height;
+    }
+    
     void Window::refresh( void )
     {
         ::wrefresh( this->impl->_win );
     }
     
+    void Window::noutrefresh( void )
+    {
+        ::wnoutrefresh( this->impl->_win );
+    }
+    
+    void Window::clear( void )
+    {
+        ::werase( this->impl->_win );
+    }
+    
     void Window::move( size_t x, size_t y )
     {
         ::wmove( this->impl->_win, numeric_cast< int >( y ), numeric_cast< int >( x ) );
@@ -44,7 +44,14 @@ namespace VBox
             
             Window & operator =( Window o );
             
+            size_t x( void )      const;
+            size_t y( void )      const;
+            size_t width( void )  const;
+            size_t height( void ) const;
+            
             void refresh( void );
+            void noutrefresh( void );
+            void clear( void );
             void move( size_t x, size_t y );
             void print( const std::string & s );
             void print( const char * format, ... );
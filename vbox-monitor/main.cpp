@@ -24,76 +24,251 @@
 
 #include "VBox/Arguments.hpp"
 #include "VBox/UI.hpp"
+#include "VBox/Screen.hpp"
 #include "VBox/Manage.hpp"
+#include "VBox/CLIBackend.hpp"
+#include "VBox/SyntheticBackend.hpp"
+#include "VBox/Stats.hpp"
+#include "VBox/Capstone.hpp"
+#include "VBox/VM/PageStore.hpp"
 #include <iostream>
+#include <fstream>
 #include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <future>
 
-void ShowHelp( void );
+void                                   ShowHelp( void );
+bool                                   IsRunning( const std::string & vmName );
+bool                                   WaitUntilRunning( const std::string & vmName );
+std::shared_ptr< VBox::VM::PageStore > CreatePageStore( const VBox::Arguments & args );
 
 int main( int argc, const char * argv[] )
 {
     VBox::Arguments args( argc, argv );
     
-    if( args.showHelp() || args.vmName().length() == 0 || args.vmPath().length() == 0 )
+    /* Startup milestones are timed from here */
+    VBox::Stats::shared();
+    
+    if( args.showHelp() || args.vmName().length() == 0 || ( args.vmPath().length() == 0 && args.synthetic() == 0 && args.attach() == false ) )
     {
         ShowHelp();
         
         return EXIT_SUCCESS;
     }
     
-    VBox::Manage::unregisterVM( args.vmName() );
-    
-    if( VBox::Manage::registerVM( args.vmPath() ) == false )
+    if( args.compress() && VBox::VM::PageStore::supports( VBox::VM::PageStore::Compression::LZ4 ) == false )
     {
-        std::cerr << "Cannot register virtual machine: " << args.vmPath() << std::endl;
+        std::cerr << "Page compression is not available in this build" << std::endl;
         
         return EXIT_FAILURE;
     }
     
-    if( VBox::Manage::startVM( args.vmName() ) == false )
+    if( args.vboxManage().length() > 0 )
     {
-        std::cerr << "Cannot start virtual machine: " << args.vmPath() << std::endl;
-        
-        return EXIT_FAILURE;
+        VBox::Manage::executable( args.vboxManage() );
     }
     
-    std::cout << "Wating for virtual machine to start..." << std::endl;
+    if( args.synthetic() > 0 )
+    {
+        VBox::Manage::backend( std::make_shared< VBox::SyntheticBackend >( args.synthetic() * 1024 * 1024 ) );
+    }
+    else if( args.console() > 0 )
+    {
+        VBox::Manage::backend( std::make_shared< VBox::CLIBackend >( args.console() ) );
+    }
     
     {
-        bool running( false );
+        bool                                   attached( args.attach() && IsRunning( args.vmName() ) );
+        std::shared_ptr< VBox::VM::PageStore > pages;
+        
+        if( attached == false && args.vmPath().length() == 0 && args.synthetic() == 0 )
+        {
+            std::cerr << "Virtual machine is not running: " << args.vmName() << std::endl;
+            
+            return EXIT_FAILURE;
+        }
         
-        while( running == false )
+        if( attached == false )
         {
-            for( const auto & vm: VBox::Manage::runningVMs() )
+            /*
+             * Registering and starting the VM takes seconds, so it runs in
+             * the background while the rest of the startup is done.
+             */
+            std::future< std::string > boot
+            (
+                std::async
+                (
+                    std::launch::async,
+                    [ & ]( void ) -> std::string
+                    {
+                        VBox::Manage::unregisterVM( args.vmName() );
+                        
+                        if( VBox::Manage::registerVM( args.vmPath() ) == false )
+                        {
+                            return "Cannot register virtual machine: " + args.vmPath();
+                        }
+                        
+                        if( VBox::Manage::startVM( args.vmName() ) == false )
+                        {
+                            return "Cannot start virtual machine: " + args.vmPath();
+                        }
+                        
+                        return "";
+                    }
+                )
+            );
+            
+            std::cout << "Wating for virtual machine to start..." << std::endl;
+            
+            pages = CreatePageStore( args );
+            
+            VBox::Capstone::disassemble( { 0x90 }, 0 );
+            
             {
-                if( vm.name() == args.vmName() )
+                std::string error( boot.get() );
+                
+                if( error.length() > 0 )
                 {
-                    running = true;
+                    std::cerr << error << std::endl;
                     
-                    break;
+                    return EXIT_FAILURE;
                 }
             }
+            
+            if( WaitUntilRunning( args.vmName() ) == false )
+            {
+                std::cerr << "Virtual machine did not start: " << args.vmName() << std::endl;
+                
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            pages = CreatePageStore( args );
+        }
+        
+        VBox::Stats::shared().reach( VBox::Stats::Milestone::Running );
+        
+        {
+            VBox::UI ui( args.vmName(), pages );
+            
+            VBox::Screen::shared().maximumFPS( args.maximumFPS() );
+            ui.sampling( args.samplingFloor(), args.samplingCeiling() );
+            ui.run();
+        }
+        
+        if( attached )
+        {
+            std::cout << "Detached from virtual machine." << std::endl;
+        }
+        else
+        {
+            VBox::Manage::powerOffVM( args.vmName() );
+            VBox::Manage::unregisterVM( args.vmName() );
+            
+            std::cout << "Virtual machine has powered-off." << std::endl;
         }
     }
     
-    VBox::UI( args.vmName() ).run();
-    VBox::Manage::powerOffVM( args.vmName() );
-    VBox::Manage::unregisterVM( args.vmName() );
-    
-    std::cout << "Virtual machine has powered-off." << std::endl;
+    if( args.statsPath().length() > 0 )
+    {
+        std::ofstream stream( args.statsPath() );
+        
+        if( stream.good() == false )
+        {
+            std::cerr << "Cannot write statistics: " << args.statsPath() << std::endl;
+            
+            return EXIT_FAILURE;
+        }
+        
+        stream << VBox::Stats::shared().json();
+    }
     
     return EXIT_SUCCESS;
 }
 
+bool IsRunning( const std::string & vmName )
+{
+    for( const auto & vm: VBox::Manage::runningVMs() )
+    {
+        if( vm.name() == vmName )
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/*
+ * startvm only returns once the VM has started, so it is normally listed
+ * right away. The list is polled again, less and less often, in case
+ * VirtualBox is slower to report it.
+ */
+bool WaitUntilRunning( const std::string & vmName )
+{
+    std::chrono::milliseconds delay( 10 );
+    
+    for( int i = 0; i < 20; i++ )
+    {
+        if( IsRunning( vmName ) )
+        {
+            return true;
+        }
+        
+        std::this_thread::sleep_for( delay );
+        
+        delay = std::min( delay * 2, std::chrono::milliseconds( 1000 ) );
+    }
+    
+    return false;
+}
+
+std::shared_ptr< VBox::VM::PageStore > CreatePageStore( const VBox::Arguments & args )
+{
+    if( args.dedup() == false )
+    {
+        return nullptr;
+    }
+    
+    return std::make_shared< VBox::VM::PageStore >( ( args.compress() ) ? VBox::VM::PageStore::Compression::LZ4 : VBox::VM::PageStore::Compression::None );
+}
+
 void ShowHelp( void )
 {
-    std::cout << "Usage: vbox-monitor VM_NAME VM_PATH"
+    std::cout << "Usage: vbox-monitor [OPTIONS] VM_NAME VM_PATH"
+              << std::endl
+              << std::endl
+              << "Options:"
+              << std::endl
+              << "    --fps N: Maximum number of screen updates per second (default: 30)"
+              << std::endl
+              << "    --stats FILE: Write per-channel latency statistics (JSON, nanoseconds) to FILE on exit"
+              << std::endl
+              << "    --vboxmanage PATH: Path to the VBoxManage executable (default: /usr/local/bin/VBoxManage)"
+              << std::endl
+              << "    --synthetic MiB: Monitor an in-process synthetic guest with MiB of memory instead of VirtualBox (VM_PATH is not needed)"
+              << std::endl
+              << "    --attach: Monitor the virtual machine if it is already running, without restarting it or powering it off on exit (VM_PATH is not needed then)"
+              << std::endl
+              << "    --console PORT: Enable the VirtualBox debugger console on PORT, and read guest memory through it instead of dumping it all"
+              << std::endl
+              << "    --sampling-floor MS: Shortest interval between samples of registers, stack and memory (default: 0)"
+              << std::endl
+              << "    --sampling-ceiling MS: Longest interval between samples while they do not change (default: 1000)"
+              << std::endl
+              << "    --dedup: Keep guest memory in a page store, without zero pages and duplicates"
+              << std::endl
+              << "    --compress: Same as --dedup, with LZ4-compressed pages (requires LZ4 support)"
               << std::endl
               << std::endl
               << "Shortcuts:"
               << std::endl
               << "    - p: Pause/Resume"
               << std::endl
+              << "    - i: Show/Hide latency statistics"
+              << std::endl
               << "    - m: Enter a memory address"
               << std::endl
               << "    - a: Scroll memory up (one line)"